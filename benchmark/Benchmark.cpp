@@ -0,0 +1,268 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <iomanip>
+#include "BenchmarkRunner.h"
+#include "../preprocessing/Preprocessor.h"
+#include "../preprocessing/ParallelPreprocessor.h"
+#include "../computation/CalculationScheduler.h"
+#include "../computation/ParallelCalculationScheduler.h"
+#include "../computation/gpu/OpenCLComponent.h"
+#include "../tests/TestData.h"
+
+#define DEFAULT_BENCH_ENTRIES 1000000
+#define DEFAULT_BENCH_WARMUP 1
+#define DEFAULT_BENCH_REPETITIONS 5
+#define DEFAULT_BENCH_OUTPUT "bench.json"
+#define BENCH_SAMPLING_RATE 32
+#define BENCH_DATE_COUNT 100000
+
+/// Preprocessor with the post processing exposed for the measurement
+template<class Base>
+class BenchPreprocessor : public Base {
+public:
+    using Base::Base;
+    using Base::post_process;
+};
+
+/// Scheduler with the initialization and parent selection exposed for the measurement
+template<class Base>
+class BenchScheduler : public Base {
+public:
+    using Base::Base;
+    using Base::init_calculation;
+    using Base::get_parent;
+};
+
+/// Configuration of the benchmark passed from the command line
+struct bench_config{
+    size_t entries = DEFAULT_BENCH_ENTRIES;
+    size_t population_size = DEFAULT_POPULATION_SIZE;
+    size_t warmup = DEFAULT_BENCH_WARMUP;
+    size_t repetitions = DEFAULT_BENCH_REPETITIONS;
+    std::string output = DEFAULT_BENCH_OUTPUT;
+    bool opencl = true;
+};
+
+/// Creates input data with random values, hr sums are calculated as during preprocessing
+std::shared_ptr<input_data> create_random_input(size_t entries_count, uint32_t seed){
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<> distribution(0.0, 1.0);
+    return create_test_input(entries_count, [&](test_column, size_t){ return distribution(generator); });
+}
+
+/// Copies the data vectors of the input so that the copy can be modified
+void copy_input(const std::shared_ptr<input_data>& source, const std::shared_ptr<input_data>& target){
+    auto copy_vector = [](const std::unique_ptr<input_vector>& vector){
+        auto copy = std::make_unique<input_vector>();
+        copy->values = vector->values;
+        return copy;
+    };
+    target->acc_x = copy_vector(source->acc_x);
+    target->acc_y = copy_vector(source->acc_y);
+    target->acc_z = copy_vector(source->acc_z);
+    target->hr = copy_vector(source->hr);
+    target->acc_entries_count = source->acc_entries_count;
+    target->hr_entries_count = source->hr_entries_count;
+}
+
+/// Formats date time the same way as the input files
+std::string format_date(time_t time){
+    std::stringstream date;
+    date << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
+    return date.str();
+}
+
+/// Writes one subject folder with HR and ACC files having one hr entry per second
+/// \return dates of the hr entries
+std::vector<std::string> write_csv_folder(const std::filesystem::path& folder, size_t seconds, uint32_t seed){
+    std::filesystem::create_directories(folder);
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<> hr_distribution(50.0, 180.0);
+    std::uniform_real_distribution<> acc_distribution(-2.0, 2.0);
+
+    std::tm start_tm {};
+    start_tm.tm_year = 123;
+    start_tm.tm_mon = 9;
+    start_tm.tm_mday = 1;
+    start_tm.tm_hour = 8;
+    start_tm.tm_isdst = -1;
+    const time_t start_time = std::mktime(&start_tm);
+
+    std::vector<std::string> dates(seconds);
+    std::ofstream hr_file(folder / "HR_bench.csv");
+    std::ofstream acc_file(folder / "ACC_bench.csv");
+    hr_file << "datetime, hr\n" << std::fixed << std::setprecision(2);
+    acc_file << "datetime, acc_x, acc_y, acc_z\n" << std::fixed << std::setprecision(3);
+    for(size_t second = 0; second < seconds; ++second){
+        dates[second] = format_date(start_time + static_cast<time_t>(second));
+        hr_file << dates[second] << "," << hr_distribution(generator) << "\n";
+        for(size_t sample = 0; sample < BENCH_SAMPLING_RATE; ++sample){
+            acc_file << dates[second] << "," << acc_distribution(generator) << "," << acc_distribution(generator)
+                     << "," << acc_distribution(generator) << "\n";
+        }
+    }
+    return dates;
+}
+
+input_parameters create_parameters(const bench_config& config){
+    input_parameters params;
+    params.max_step_count = 1;
+    params.population_size = config.population_size;
+    params.seed = 42;
+    params.parallel = config.opencl;
+    params.metrics_output = DISABLED_METRICS_OUTPUT;
+    return params;
+}
+
+bench_config parse_bench_arguments(int argc, char* argv[]){
+    bench_config config;
+    for(int i = 1; i < argc; ++i){
+        const std::string argument = argv[i];
+        const bool has_value = i + 1 < argc;
+        if(argument == "-entries" && has_value){
+            config.entries = std::stoull(argv[++i]);
+        }else if(argument == "-population_size" && has_value){
+            config.population_size = std::max<size_t>(VECTOR_SIZE, std::stoull(argv[++i]));
+        }else if(argument == "-warmup" && has_value){
+            config.warmup = std::stoull(argv[++i]);
+        }else if(argument == "-repetitions" && has_value){
+            config.repetitions = std::stoull(argv[++i]);
+        }else if(argument == "-output" && has_value){
+            config.output = argv[++i];
+        }else if(argument == "-no_opencl"){
+            config.opencl = false;
+        }else{
+            std::cerr << "Usage: ppr_bench [-entries <count>] [-population_size <count>] [-warmup <count>] "
+                         "[-repetitions <count>] [-output <file>] [-no_opencl]" << std::endl;
+            exit(-1);
+        }
+    }
+    return config;
+}
+
+void run_preprocessing_stages(BenchmarkRunner& runner, const bench_config& config){
+    //csv files hold one hr entry per second, so the parsing is measured on smaller data than the computation
+    const size_t seconds = std::max<size_t>(VECTOR_SIZE * 4, config.entries / 10);
+    //every run gets its own folder, so concurrent benchmarks never share or delete each other's data
+    std::filesystem::path data_folder;
+    std::random_device random_device;
+    do{
+        std::stringstream folder_name;
+        folder_name << "ppr_bench_data_" << std::hex << random_device();
+        data_folder = std::filesystem::temp_directory_path() / folder_name.str();
+    }while(!std::filesystem::create_directory(data_folder));
+    const auto dates = write_csv_folder(data_folder / "subject", seconds, 7);
+
+    const size_t date_count = std::min<size_t>(BENCH_DATE_COUNT, dates.size());
+    runner.run("parse_date", "serial", date_count, [&](){
+        time_t checksum = 0;
+        for(size_t i = 0; i < date_count; ++i){
+            checksum += parse_date(dates[i]);
+        }
+        std::cout << checksum;
+    });
+
+    runner.run("load_folder", "join", seconds, [&](){
+        Preprocessor preprocessor {data_folder.string()};
+        auto input = std::make_shared<input_data>();
+        preprocessor.load_and_preprocess_folder(input);
+    });
+    runner.run("load_folder", "serial", seconds, [&](){
+        Preprocessor preprocessor {data_folder.string(), false, true};
+        auto input = std::make_shared<input_data>();
+        preprocessor.load_and_preprocess_folder(input);
+    });
+    runner.run("load_folder", "parallel", seconds, [&](){
+        ParallelPreprocessor preprocessor {data_folder.string(), false, true};
+        auto input = std::make_shared<input_data>();
+        preprocessor.load_and_preprocess_folder(input);
+    });
+
+    const auto raw_input = create_random_input(config.entries, 11);
+    auto processed_input = std::make_shared<input_data>();
+    BenchPreprocessor<Preprocessor> serial_preprocessor {data_folder.string()};
+    runner.run("post_process", "serial", config.entries, [&](){
+        serial_preprocessor.post_process(processed_input);
+    }, [&](){
+        copy_input(raw_input, processed_input);
+    });
+    BenchPreprocessor<ParallelPreprocessor> parallel_preprocessor {data_folder.string()};
+    runner.run("post_process", "parallel", config.entries, [&](){
+        parallel_preprocessor.post_process(processed_input);
+    }, [&](){
+        copy_input(raw_input, processed_input);
+    });
+
+    std::error_code fs_error;
+    std::filesystem::remove_all(data_folder, fs_error);
+}
+
+void run_computation_stages(BenchmarkRunner& runner, const bench_config& config, const input_parameters& params){
+    const auto input = create_random_input(config.entries, 13);
+    BenchScheduler<CalculationScheduler> scheduler(input, params);
+    scheduler.init_calculation();
+
+    std::vector<genome> population(params.population_size);
+    std::vector<genome> new_population(params.population_size);
+    scheduler.init_population(population);
+    size_t best_index = 0;
+
+    runner.run("transform", "serial", config.entries, [&](){
+        scheduler.transform(population[0]);
+    });
+    runner.run("correlation", "serial", config.entries * params.population_size, [&](){
+        scheduler.transform_and_correlation(population, best_index);
+    });
+    runner.run("repopulate", "serial", params.population_size, [&](){
+        scheduler.repopulate(population, new_population, population[best_index]);
+    });
+    runner.run("get_parent", "serial", params.population_size, [&](){
+        size_t last_index = 0;
+        for(size_t i = 0; i < params.population_size; ++i){
+            scheduler.get_parent(population, last_index);
+        }
+    });
+
+    if(!config.opencl){
+        return;
+    }
+    std::vector<std::unique_ptr<OpenCLComponent>> cl_devices;
+    OpenCLComponent::init_opencl_devices(cl_devices, params);
+    if(cl_devices.empty()){
+        std::cout << "No OpenCL device available, skipping OpenCL stages" << std::endl;
+        return;
+    }
+    //every device slice has to be divisible by the work group size
+    const size_t granularity = OpenCLComponent::get_common_work_group_size(cl_devices) * cl_devices.size();
+    const size_t device_entries = config.entries - config.entries % granularity;
+    if(device_entries == 0){
+        std::cout << "Not enough entries for OpenCL stages" << std::endl;
+        return;
+    }
+    const auto device_input = create_random_input(device_entries, 13);
+    BenchScheduler<ParallelCalculationScheduler> device_scheduler(cl_devices, device_input, params);
+    device_scheduler.init_calculation();
+    CalculationScheduler& evaluated_scheduler = device_scheduler;
+    runner.run("correlation", "opencl", device_entries * params.population_size, [&](){
+        evaluated_scheduler.transform_and_correlation(population, best_index);
+    });
+}
+
+int main(int argc, char* argv[]) {
+    const bench_config config = parse_bench_arguments(argc, argv);
+    const input_parameters params = create_parameters(config);
+    BenchmarkRunner runner(config.warmup, config.repetitions);
+
+    run_preprocessing_stages(runner, config);
+    run_computation_stages(runner, config, params);
+
+    runner.print_summary();
+    std::stringstream configuration;
+    configuration << "\"entries\": " << config.entries << ", \"population_size\": " << config.population_size
+                  << ", \"warmup\": " << config.warmup << ", \"repetitions\": " << config.repetitions;
+    runner.write_json(config.output, configuration.str());
+    return EXIT_SUCCESS;
+}
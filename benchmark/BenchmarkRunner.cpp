@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include "BenchmarkRunner.h"
+#include "../utils.h"
+
+/// Stream buffer dropping everything written into it
+class null_buffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+};
+
+/// Redirects the standard output into null buffer for the lifetime of the object
+class output_silencer{
+public:
+    output_silencer(): original(std::cout.rdbuf(&silent)){
+    }
+    ~output_silencer(){
+        std::cout.rdbuf(original);
+    }
+private:
+    null_buffer silent;
+    std::streambuf* original;
+};
+
+BenchmarkRunner::BenchmarkRunner(size_t warmup_count, size_t repetitions): warmup_count(warmup_count),
+                                                                           repetitions(std::max<size_t>(1, repetitions)){
+}
+
+void BenchmarkRunner::run(const std::string &name, const std::string &variant, size_t items,
+                          const std::function<void()> &stage, const std::function<void()> &setup) {
+    std::cout << "Running " << name << " (" << variant << ")" << std::endl;
+    stage_result result {name, variant, items, {}};
+    {
+        output_silencer silencer;
+        for(size_t i = 0; i < this->warmup_count + this->repetitions; ++i){
+            if(setup){
+                setup();
+            }
+            auto start_time = std::chrono::steady_clock::now();
+            stage();
+            auto end_time = std::chrono::steady_clock::now();
+            if(i >= this->warmup_count){
+                result.durations_ns.push_back(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count()));
+            }
+        }
+    }
+    std::sort(result.durations_ns.begin(), result.durations_ns.end());
+    this->results.push_back(std::move(result));
+}
+
+uint64_t BenchmarkRunner::get_percentile(const std::vector<uint64_t> &durations, double percentile) {
+    if(durations.empty()){
+        return 0;
+    }
+    const auto rank = static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(durations.size())));
+    return durations[std::clamp<size_t>(rank, 1, durations.size()) - 1];
+}
+
+double BenchmarkRunner::get_mean(const std::vector<uint64_t> &durations) {
+    if(durations.empty()){
+        return 0;
+    }
+    return std::accumulate(durations.begin(), durations.end(), 0.0) / static_cast<double>(durations.size());
+}
+
+void BenchmarkRunner::print_summary() const {
+    std::cout << TEXT_SEPARATOR << std::endl;
+    std::cout << std::left << std::setw(24) << "stage" << std::setw(10) << "variant"
+              << std::right << std::setw(14) << "p50 [ms]" << std::setw(14) << "p90 [ms]"
+              << std::setw(14) << "p99 [ms]" << std::setw(16) << "items/s" << std::endl;
+    for(const auto& result: this->results){
+        const double p50 = static_cast<double>(get_percentile(result.durations_ns, 50));
+        std::cout << std::left << std::setw(24) << result.name << std::setw(10) << result.variant << std::right
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(14) << p50 / 1e6
+                  << std::setw(14) << static_cast<double>(get_percentile(result.durations_ns, 90)) / 1e6
+                  << std::setw(14) << static_cast<double>(get_percentile(result.durations_ns, 99)) / 1e6
+                  << std::setprecision(0)
+                  << std::setw(16) << (p50 > 0 ? static_cast<double>(result.items) / p50 * 1e9 : 0)
+                  << std::defaultfloat << std::endl;
+    }
+    std::cout << TEXT_SEPARATOR << std::endl;
+}
+
+bool BenchmarkRunner::write_json(const std::string &file_name, const std::string &configuration) const {
+    std::ofstream json_file(file_name);
+    if(!json_file.is_open()){
+        std::cerr << "Benchmark results could not be written to " << file_name << std::endl;
+        return false;
+    }
+    json_file << "{\n  \"benchmark\": \"ppr_bench\",\n  \"configuration\": {" << configuration << "},\n"
+              << "  \"stages\": [\n";
+    for(size_t i = 0; i < this->results.size(); ++i){
+        const auto& result = this->results[i];
+        const auto& durations = result.durations_ns;
+        json_file << "    {\"name\": \"" << result.name << "\", \"variant\": \"" << result.variant
+                  << "\", \"items\": " << result.items
+                  << ", \"repetitions\": " << durations.size()
+                  << ", \"min_ns\": " << (durations.empty() ? 0 : durations.front())
+                  << ", \"mean_ns\": " << static_cast<uint64_t>(get_mean(durations))
+                  << ", \"p50_ns\": " << get_percentile(durations, 50)
+                  << ", \"p90_ns\": " << get_percentile(durations, 90)
+                  << ", \"p99_ns\": " << get_percentile(durations, 99)
+                  << ", \"max_ns\": " << (durations.empty() ? 0 : durations.back())
+                  << "}" << (i + 1 < this->results.size() ? "," : "") << "\n";
+    }
+    json_file << "  ]\n}\n";
+    std::cout << "Benchmark results written to " << file_name << std::endl;
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef OCL_TEST_BENCHMARKRUNNER_H
+#define OCL_TEST_BENCHMARKRUNNER_H
+
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/// Measured durations of one benchmarked stage
+struct stage_result{
+    std::string name;
+    /// implementation that was measured (serial, parallel, opencl)
+    std::string variant;
+    /// count of processed items (entries, genomes, lines) in one repetition
+    size_t items = 0;
+    /// durations of all measured repetitions in nanoseconds, sorted
+    std::vector<uint64_t> durations_ns;
+};
+
+/// Runs benchmark stages with warmup and repetitions and reports their duration percentiles
+class BenchmarkRunner {
+
+public:
+    /// \param warmup_count count of unmeasured runs before the measurement
+    /// \param repetitions count of measured runs
+    BenchmarkRunner(size_t warmup_count, size_t repetitions);
+
+    /// Runs and measures the stage. Standard output of the stage is suppressed
+    /// \param name name of the stage
+    /// \param variant implementation that is measured
+    /// \param items count of processed items in one run
+    /// \param stage measured function
+    /// \param setup function preparing the data before every run, not measured
+    void run(const std::string& name, const std::string& variant, size_t items,
+             const std::function<void()>& stage, const std::function<void()>& setup = nullptr);
+
+    /// Prints table with results of all stages
+    void print_summary() const;
+
+    /// Writes results of all stages as JSON
+    /// \param file_name output file
+    /// \param configuration JSON object members describing the benchmark configuration
+    /// \return true if the file was written
+    bool write_json(const std::string& file_name, const std::string& configuration) const;
+
+private:
+    const size_t warmup_count;
+    const size_t repetitions;
+
+    std::vector<stage_result> results;
+
+private:
+    /// \param durations sorted durations
+    /// \param percentile wanted percentile 0-100
+    /// \return duration of the percentile using nearest rank
+    static uint64_t get_percentile(const std::vector<uint64_t>& durations, double percentile);
+
+    /// \return mean of the durations in nanoseconds
+    static double get_mean(const std::vector<uint64_t>& durations);
+};
+
+
+#endif //OCL_TEST_BENCHMARKRUNNER_H
@@ -0,0 +1,206 @@
+#include <fstream>
+#include <limits>
+#include <thread>
+#include "AutoTuner.h"
+#include "ParallelCalculationScheduler.h"
+#include "HybridCalculationScheduler.h"
+#include "../preprocessing/ParallelPreprocessor.h"
+#include "../preprocessing/Preprocessor.h"
+
+
+AutoTuner::AutoTuner(const input_parameters &params): params(params) {
+}
+
+input_parameters AutoTuner::get_tuned_parameters() {
+    std::cout << TEXT_SEPARATOR << std::endl;
+    const std::string key = get_cache_key(OpenCLComponent::get_selected_device_names(this->params));
+
+    execution_config config;
+    if(load_cached_config(key, config)){
+        std::cout << "Loaded tuned configuration from " << TUNE_CACHE_FILE_NAME << std::endl;
+    }else{
+        std::cout << "No tuned configuration found for this machine, measuring the candidates" << std::endl;
+        config = measure_best_config();
+        save_config(key, config);
+    }
+
+    std::cout << "Selected configuration: ";
+    print_measurement(config, 0);
+    std::cout << TEXT_SEPARATOR << std::endl;
+    return this->params.with_execution_config(config);
+}
+
+std::string AutoTuner::get_cache_key(const std::vector<std::string> &device_names) const {
+    std::vector<std::string> key_parts = device_names;
+    key_parts.push_back(std::to_string(std::thread::hardware_concurrency()));
+    key_parts.push_back(std::to_string(this->params.population_size));
+    key_parts.push_back(std::to_string(this->params.specialized_kernels));
+    key_parts.push_back(std::to_string(this->params.pow_scope));
+    //input sizes within a factor of two share the configuration
+    size_t size_class = 0;
+    for(size_t entries = Preprocessor::predict_entries_count(this->params.input_folder); entries > 1; entries >>= 1){
+        ++size_class;
+    }
+    key_parts.push_back(std::to_string(size_class));
+
+    std::stringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0') << hash_key_parts(key_parts);
+    return key.str();
+}
+
+bool AutoTuner::load_cached_config(const std::string &key, execution_config &config) {
+    std::ifstream cache_file(TUNE_CACHE_FILE_NAME);
+    if(!cache_file.is_open()){
+        return false;
+    }
+    //every line holds: key parallel hybrid work_group_size hybrid_batch_size cpu_threads
+    std::string line;
+    bool found = false;
+    while(std::getline(cache_file, line)){
+        std::stringstream line_stream(line);
+        std::string line_key;
+        execution_config line_config;
+        if(line_stream >> line_key >> line_config.parallel >> line_config.hybrid >> line_config.work_group_size
+                       >> line_config.hybrid_batch_size >> line_config.cpu_threads && line_key == key){
+            //later entries override the older ones
+            config = line_config;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void AutoTuner::save_config(const std::string &key, const execution_config &config) {
+    std::ofstream cache_file(TUNE_CACHE_FILE_NAME, std::ios::app);
+    if(!cache_file.is_open()){
+        std::cerr << "Tuned configuration could not be saved to " << TUNE_CACHE_FILE_NAME << std::endl;
+        return;
+    }
+    cache_file << key << " " << config.parallel << " " << config.hybrid << " " << config.work_group_size << " "
+               << config.hybrid_batch_size << " " << config.cpu_threads << "\n";
+}
+
+std::shared_ptr<input_data> AutoTuner::create_data_sample(const std::shared_ptr<input_data> &input,
+                                                          size_t entries_count) {
+    auto sample = std::make_shared<input_data>();
+    auto copy_vector = [entries_count](const std::unique_ptr<input_vector>& source){
+        auto copy = std::make_unique<input_vector>();
+        copy->values.assign(source->values.begin(), source->values.begin() + static_cast<long>(entries_count));
+        copy->min = source->min;
+        copy->max = source->max;
+        return copy;
+    };
+    sample->acc_x = copy_vector(input->acc_x);
+    sample->acc_y = copy_vector(input->acc_y);
+    sample->acc_z = copy_vector(input->acc_z);
+    sample->hr = copy_vector(input->hr);
+    sample->acc_entries_count = entries_count;
+    sample->hr_entries_count = entries_count;
+    sample->hr_sum = input->hr_sum;
+    sample->squared_hr_corr_sum = input->squared_hr_corr_sum;
+    return sample;
+}
+
+std::vector<std::unique_ptr<OpenCLComponent>> AutoTuner::clone_devices(
+        const std::vector<std::unique_ptr<OpenCLComponent>> &cl_devices, size_t work_group_size,
+        const input_parameters &config_params) {
+    std::vector<std::unique_ptr<OpenCLComponent>> clones;
+    for(const auto& cl_device: cl_devices){
+        clones.push_back(cl_device->clone_with_work_group_size(work_group_size, config_params));
+    }
+    return clones;
+}
+
+void AutoTuner::print_measurement(const execution_config &config, double duration) {
+    if(config.hybrid){
+        std::cout << "hybrid, work group size " << config.work_group_size << ", batch size "
+                  << config.hybrid_batch_size << ", CPU threads " << config.cpu_threads;
+    }else if(config.parallel){
+        std::cout << "parallel, work group size " << config.work_group_size;
+    }else{
+        std::cout << "serial";
+    }
+    if(duration > 0){
+        std::cout << ": " << duration * 1000 << " ms per population";
+    }
+    std::cout << std::endl;
+}
+
+execution_config AutoTuner::measure_best_config() {
+    //devices are initialized with their maximal work group size, smaller sizes are measured on their copies
+    std::vector<std::unique_ptr<OpenCLComponent>> cl_devices;
+    OpenCLComponent::init_opencl_devices(cl_devices, this->params.with_execution_config({true}));
+    size_t max_work_group_size = std::numeric_limits<size_t>::max();
+    for(const auto& cl_device: cl_devices){
+        max_work_group_size = std::min(max_work_group_size, cl_device->work_group_size);
+    }
+
+    ParallelPreprocessor preprocessor {this->params.input_folder};
+    auto input = std::make_shared<input_data>();
+    preprocessor.load_and_preprocess_folder(input);
+
+    //sample has to be divisible by the work group sizes of all devices
+    size_t sample_entries = std::min(TUNE_SAMPLE_ENTRIES, std::min(input->hr_entries_count, input->acc_entries_count));
+    if(!cl_devices.empty()){
+        sample_entries -= sample_entries % (OpenCLComponent::get_common_work_group_size(cl_devices)
+                                                * cl_devices.size());
+    }
+    if(sample_entries == 0){
+        std::cout << "Not enough data for tuning, using serial run" << std::endl;
+        return {};
+    }
+    const auto sample = create_data_sample(input, sample_entries);
+
+    execution_config best_config;
+    std::vector<genome> population(this->params.population_size);
+    double best_duration;
+    {
+        CalculationScheduler scheduler(sample, this->params.with_execution_config(best_config));
+        scheduler.init_population(population);
+        best_duration = scheduler.benchmark_evaluation(population, TUNE_REPETITIONS);
+        print_measurement(best_config, best_duration);
+    }
+    if(cl_devices.empty()){
+        return best_config;
+    }
+
+    //whole population launched at once with different work group sizes
+    size_t best_work_group_size = max_work_group_size;
+    double best_parallel_duration = std::numeric_limits<double>::max();
+    for(size_t work_group_size = std::min(TUNE_MIN_WORK_GROUP_SIZE, max_work_group_size);
+            work_group_size <= max_work_group_size; work_group_size *= 2){
+        execution_config config {true, false, work_group_size};
+        const auto config_params = this->params.with_execution_config(config);
+        const auto clones = clone_devices(cl_devices, work_group_size, config_params);
+        ParallelCalculationScheduler scheduler(clones, sample, config_params);
+        const double duration = scheduler.benchmark_evaluation(population, TUNE_REPETITIONS);
+        print_measurement(config, duration);
+        if(duration < best_parallel_duration){
+            best_parallel_duration = duration;
+            best_work_group_size = work_group_size;
+        }
+        if(duration < best_duration){
+            best_duration = duration;
+            best_config = config;
+        }
+    }
+
+    //genomes per launch and CPU thread counts of the hybrid evaluation with the best work group size
+    const size_t hardware_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t free_threads = hardware_threads > cl_devices.size() ? hardware_threads - cl_devices.size() : 1;
+    for(const size_t batch_size: {1, 4, 16}){
+        for(const size_t cpu_threads: {free_threads, std::max<size_t>(1, free_threads / 2)}){
+            execution_config config {true, true, best_work_group_size, batch_size, cpu_threads};
+            const auto config_params = this->params.with_execution_config(config);
+            const auto clones = clone_devices(cl_devices, best_work_group_size, config_params);
+            HybridCalculationScheduler scheduler(clones, sample, config_params);
+            const double duration = scheduler.benchmark_evaluation(population, TUNE_REPETITIONS);
+            print_measurement(config, duration);
+            if(duration < best_duration){
+                best_duration = duration;
+                best_config = config;
+            }
+        }
+    }
+    return best_config;
+}
@@ -0,0 +1,74 @@
+#ifndef OCL_TEST_AUTOTUNER_H
+#define OCL_TEST_AUTOTUNER_H
+
+
+#include "CalculationScheduler.h"
+#include "gpu/OpenCLComponent.h"
+
+/// count of data entries the candidate configurations are measured on
+const size_t TUNE_SAMPLE_ENTRIES = 1 << 18;
+/// count of measured evaluations of every candidate configuration
+const size_t TUNE_REPETITIONS = 3;
+/// smallest work group size that is measured, bigger candidates are its powers of two multiples
+const size_t TUNE_MIN_WORK_GROUP_SIZE = 32;
+
+/// Chooses the fastest execution configuration (serial, parallel or hybrid backend, work group size,
+/// genomes per launch and CPU thread count) by measuring the candidates on a sample of the input data.
+/// The chosen configuration is stored in a cache file, so the measurement runs only once per machine.
+class AutoTuner {
+
+public:
+    explicit AutoTuner(const input_parameters& params);
+
+    /// Loads the configuration from the cache file or measures it if this machine wasn't tuned yet
+    /// \return copy of the input parameters with the fastest execution configuration
+    input_parameters get_tuned_parameters();
+
+private:
+    const input_parameters params;
+
+private:
+    /// \param device_names names of the devices selected for this run
+    /// \return key identifying the machine, its devices, population size, pow scope and input size class in the
+    /// cache file
+    [[nodiscard]] std::string get_cache_key(const std::vector<std::string>& device_names) const;
+
+    /// Looks for the configuration stored under the key in the cache file
+    /// \param key key of this machine
+    /// \param config output configuration
+    /// \return true if the configuration was found
+    static bool load_cached_config(const std::string& key, execution_config& config);
+
+    /// Appends the configuration to the cache file
+    /// \param key key of this machine
+    /// \param config configuration that should be stored
+    static void save_config(const std::string& key, const execution_config& config);
+
+    /// Loads the input data and measures all candidate configurations on its sample
+    /// \return the fastest configuration
+    execution_config measure_best_config();
+
+    /// Copies the beginning of the input data, hr sums are kept since only the duration matters
+    /// \param input loaded input data
+    /// \param entries_count count of copied entries
+    /// \return data sample
+    static std::shared_ptr<input_data> create_data_sample(const std::shared_ptr<input_data>& input,
+                                                          size_t entries_count);
+
+    /// Creates copies of the devices using the passed work group size
+    /// \param cl_devices initialized devices
+    /// \param work_group_size work group size of the copies
+    /// \param config_params parameters of the measured configuration
+    /// \return device copies
+    static std::vector<std::unique_ptr<OpenCLComponent>> clone_devices(
+            const std::vector<std::unique_ptr<OpenCLComponent>>& cl_devices, size_t work_group_size,
+            const input_parameters& config_params);
+
+    /// Prints the measured configuration
+    /// \param config measured configuration
+    /// \param duration measured duration of one evaluation in seconds
+    static void print_measurement(const execution_config& config, double duration);
+};
+
+
+#endif //OCL_TEST_AUTOTUNER_H
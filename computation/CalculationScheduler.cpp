@@ -4,18 +4,36 @@
 
 #include <random>
 #include <iostream>
+#include <limits>
+#include <cstring>
 #include "CalculationScheduler.h"
+#include "GenomeFile.h"
+#include "../metrics/MetricsRegistry.h"
+#include "../metrics/PerfCounters.h"
+#include "../simd/SimdDispatch.h"
+
+/// part of the initial population seeded by the warm start genomes and their perturbations
+const double WARM_START_FRACTION = 0.5;
+/// scope of the perturbation of the seeded constants relative to the const scope
+const double WARM_START_PERTURBATION = 0.05;
+/// every n-th perturbation also changes one power of the seed
+const size_t WARM_START_POWER_CHANGE_INTERVAL = 4;
 
 
 CalculationScheduler::CalculationScheduler(const std::shared_ptr<input_data>& input,
                                            const input_parameters& input_params):
         input(input), input_params(input_params),
         mt19937_generator(input_params.seed),
-        transformation_result(input->acc_entries_count),
         corr_result(input_params.population_size),
         hr_sum(input->hr_sum),
         squared_hr_corr_sum(input->squared_hr_corr_sum){
-
+    if(!input_params.warm_start.empty()){
+        //the file is read once, the population may be initialized more times
+        this->warm_start_genomes = GenomeFile::read(input_params.warm_start, input_params.pow_scope);
+        if(this->warm_start_genomes.empty()){
+            std::cerr << "No genomes loaded for the warm start, the population stays random" << std::endl;
+        }
+    }
 }
 
 CalculationScheduler::~CalculationScheduler() = default;
@@ -27,10 +45,10 @@ double CalculationScheduler::find_transformation_function(genome& best_genome) {
     std::vector<genome> curr_population (this->input_params.population_size);
     std::vector<genome> old_population (this->input_params.population_size);
 
-    __int64 elapsed = time_call([&] {
+    {
+        ScopedTimer init_timer(PHASE_INITIALIZE);
         init_population(curr_population);
-    });
-    std::cout << "Initialization of first population took " << elapsed << " ms" << std::endl;
+    }
 
     uint32_t step_done_count = 0;
     double best_corr = 0;
@@ -40,10 +58,14 @@ double CalculationScheduler::find_transformation_function(genome& best_genome) {
     std::cout << "Starting the main cycle." << std::endl;
     while(step_done_count < this->input_params.max_step_count){
 
-        elapsed = time_call([&] {
+        {
+            ScopedTimer evaluate_timer(PHASE_EVALUATE);
+            ScopedPerfSample evaluate_sample(PERF_EVALUATE, this->input->hr_entries_count * curr_population.size());
             best_corr = transform_and_correlation(curr_population, best_index);
-        });
-        std::cout << "Transform and correlation calculation took " << elapsed << " ms" << std::endl;
+        }
+        MetricsRegistry::increment(COUNTER_GENERATIONS);
+        MetricsRegistry::increment(COUNTER_EVALUATED_GENOMES, curr_population.size());
+        MetricsRegistry::increment(COUNTER_SAMPLE_VISITS, get_sample_visits(curr_population.size()));
 
         if(best_corr > desired_corr){
             std::cout << "Maximal (desired) correlation threshold reached (" << best_corr << ">" << desired_corr
@@ -51,7 +73,8 @@ double CalculationScheduler::find_transformation_function(genome& best_genome) {
             break;
         }
         if(step_done_count % this->input_params.step_info_interval == 0){
-            std::cout << step_done_count + 1 << "th step was done. Current best correlation: " << best_corr << std::endl;
+            //the output is flushed only at the end of the run, so the printing doesn't stall the cycle
+            std::cout << step_done_count + 1 << "th step was done. Current best correlation: " << best_corr << '\n';
             print_genome(curr_population[best_index]);
         }
 
@@ -59,10 +82,11 @@ double CalculationScheduler::find_transformation_function(genome& best_genome) {
         curr_population = old_population; //swap pointers so we don't have to allocate another vector
         old_population = swap;
 
-        elapsed = time_call([&] {
+        {
+            ScopedTimer repopulate_timer(PHASE_REPOPULATE);
+            ScopedPerfSample repopulate_sample(PERF_REPOPULATE, curr_population.size());
             repopulate(old_population, curr_population, old_population[best_index]);
-        });
-        std::cout << "Generation of new population took " << elapsed << " ms" << std::endl;
+        }
 
         //after new repopulation the best genome is at the first position again
         best_index = 0;
@@ -72,6 +96,21 @@ double CalculationScheduler::find_transformation_function(genome& best_genome) {
     return best_corr;
 }
 
+double CalculationScheduler::benchmark_evaluation(const std::vector<genome> &population, size_t repetitions) {
+    init_calculation();
+    size_t best_index = 0;
+    transform_and_correlation(population, best_index);
+
+    double best_duration = std::numeric_limits<double>::max();
+    for(size_t i = 0; i < repetitions; ++i){
+        auto start_time = std::chrono::high_resolution_clock::now();
+        transform_and_correlation(population, best_index);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        best_duration = std::min(best_duration, std::chrono::duration<double>(end_time - start_time).count());
+    }
+    return best_duration;
+}
+
 void CalculationScheduler::init_population(std::vector<genome>& init_population) const {
     srand(this->input_params.seed);
 //    std::random_device rd; // obtain a random number from hardware
@@ -94,6 +133,39 @@ void CalculationScheduler::init_population(std::vector<genome>& init_population)
         }
         init_population[i] = genome;
     }
+    if(!this->warm_start_genomes.empty()){
+        seed_population(init_population, generator);
+    }
+}
+
+void CalculationScheduler::seed_population(std::vector<genome> &init_population, std::mt19937 &generator) const {
+    const auto& seeds = this->warm_start_genomes;
+    const size_t population_size = init_population.size();
+    const size_t copies_count = std::min(seeds.size(), population_size);
+    const auto seeded_count = std::min(population_size, std::max(copies_count,
+                                       static_cast<size_t>(population_size * WARM_START_FRACTION)));
+
+    const double perturbation_scope = this->input_params.const_scope * WARM_START_PERTURBATION;
+    std::uniform_real_distribution<> constant_distribution(-perturbation_scope, perturbation_scope);
+    std::uniform_int_distribution<> power_distribution(1, this->input_params.pow_scope);
+    //the last power is not used
+    std::uniform_int_distribution<size_t> power_index_distribution(0, GENOME_POW_SIZE - 2);
+
+    //seeds are copied unchanged first, then their perturbations are dealt round robin
+    for(size_t i = 0; i < seeded_count; ++i){
+        auto seeded = seeds[i % seeds.size()];
+        if(i >= copies_count){
+            for(auto& constant: seeded.constants){
+                constant += constant_distribution(generator);
+            }
+            if(i % WARM_START_POWER_CHANGE_INTERVAL == 0){
+                seeded.powers[power_index_distribution(generator)] = power_distribution(generator);
+            }
+        }
+        init_population[i] = seeded;
+    }
+    std::cout << "Warm start seeded " << copies_count << " genomes and " << seeded_count - copies_count
+              << " perturbations of them from " << this->input_params.warm_start << std::endl;
 }
 
 double CalculationScheduler::transform_and_correlation(const std::vector<genome>& population, size_t &best_index) {
@@ -101,24 +173,13 @@ double CalculationScheduler::transform_and_correlation(const std::vector<genome>
     double best_corr = 0;
     size_t gen_index = 0;
     const auto entries_count = (double)this->input->hr_entries_count;
-    const auto& hr = this->input->hr->values;
     for (const genome gen: population) {
-        //first transform the acc data according to genome function
-        transform(gen);
-
-        double acc_sum = 0;
-        double acc_sum_pow_2 = 0;
-        double hr_acc_sum = 0;
-        //get all needed sum to calculate correlation
-        for (int i = 0; i < entries_count; ++i) {
-            auto trs_acc_unit = this->transformation_result[i];
-            acc_sum += trs_acc_unit;
-            acc_sum_pow_2 += (trs_acc_unit * trs_acc_unit);
-            hr_acc_sum += (trs_acc_unit * hr[i]);
-        }
+        //transform the acc data according to genome function and get all needed sum to calculate correlation
+        const auto sums = calculate_correlation_sums(gen, 0, this->input->hr_entries_count);
 
         //correlation in abs so that we have easier fitness function validation
-        double corr_abs = get_abs_correlation_coefficient(entries_count, acc_sum, acc_sum_pow_2, hr_acc_sum);
+        double corr_abs = get_abs_correlation_coefficient(entries_count, sums.acc_sum, sums.acc_sum_pow_2,
+                                                          sums.hr_acc_sum);
 
         if(best_index != gen_index && corr_abs > best_corr){
             best_corr = corr_abs;
@@ -153,9 +214,15 @@ void CalculationScheduler::repopulate(const std::vector<genome>& old_population,
 
     //copy the best genome to the next gen
     std::memcpy(&new_population[0], &best_genome, sizeof(genome));
-    size_t current_index = 1;
     size_t last_parent_index = 0;
-    while(current_index < population_size){
+    repopulate_range(old_population, new_population, 1, population_size, last_parent_index);
+    mutate(new_population);
+}
+
+void CalculationScheduler::repopulate_range(const std::vector<genome> &old_population,
+                                            std::vector<genome> &new_population, size_t begin, size_t end,
+                                            size_t &last_parent_index) {
+    for(size_t current_index = begin; current_index < end; ++current_index){
         auto parent1 = get_parent(old_population, last_parent_index);
         auto parent2 = get_parent(old_population, last_parent_index);
 
@@ -163,30 +230,41 @@ void CalculationScheduler::repopulate(const std::vector<genome>& old_population,
                     &parent1->powers, GENOME_CONSTANTS_SIZE);
         std::memcpy(&new_population[current_index].constants,
                     &parent2->constants, GENOME_POW_SIZE * sizeof(double));
-        ++current_index;
     }
-    mutate(new_population);
 }
 
 void CalculationScheduler::transform(const genome& current_genome) {
-    const auto& acc_x = input->acc_z;
-    const auto& acc_y = input->acc_z;
-    const auto& acc_z = input->acc_z;
-
-    const auto& c = current_genome.constants;
-    const auto& p = current_genome.powers;
-
-    const auto vector_size = input->acc_entries_count;
-    for(size_t i = 0; i < vector_size; ++i){
-        double x = acc_x->values[i];
-        double y = acc_y->values[i];
-        double z = acc_z->values[i];
-
-        this->transformation_result[i] = c[0] * pow(x, p[0]) + c[1] * pow(y, p[1])
-                + c[2] * pow(z, p[2]) + c[3];
+    //allocated only when needed, the evaluation itself doesn't store the transformed values
+    this->transformation_result.resize(input->acc_entries_count);
+    if(input->compressed != nullptr){
+        SimdDispatch::get_kernels().compressed_transform(input->compressed->get_simd_columns(0),
+                                                         current_genome.constants.data(),
+                                                         current_genome.powers.data(),
+                                                         this->transformation_result.data(),
+                                                         input->acc_entries_count);
+        return;
     }
+    SimdDispatch::get_kernels().transform(input->acc_x->values.data(), input->acc_y->values.data(),
+                                          input->acc_z->values.data(), current_genome.constants.data(),
+                                          current_genome.powers.data(), this->transformation_result.data(),
+                                          input->acc_entries_count);
 }
 
+correlation_sums CalculationScheduler::calculate_correlation_sums(const genome &current_genome,
+                                                                  size_t begin, size_t end) const {
+    if(input->compressed != nullptr){
+        const auto sums = SimdDispatch::get_kernels().compressed_correlation_sums(
+                input->compressed->get_simd_columns(begin), current_genome.constants.data(),
+                current_genome.powers.data(), end - begin);
+        return {sums.acc_sum, sums.acc_sum_pow_2, sums.hr_acc_sum};
+    }
+    //the transformed values are not stored, only their sums are needed
+    const auto sums = SimdDispatch::get_kernels().correlation_sums(
+            input->acc_x->values.data() + begin, input->acc_y->values.data() + begin,
+            input->acc_z->values.data() + begin, input->hr->values.data() + begin,
+            current_genome.constants.data(), current_genome.powers.data(), end - begin);
+    return {sums.acc_sum, sums.acc_sum_pow_2, sums.hr_acc_sum};
+}
 
 const genome* CalculationScheduler::get_parent(const std::vector<genome> &vector, size_t &last_index) {
 
@@ -208,7 +286,16 @@ void CalculationScheduler::init_calculation() {
 
 }
 
+uint64_t CalculationScheduler::get_sample_visits(size_t population_size) const {
+    return static_cast<uint64_t>(this->input->hr_entries_count) * population_size;
+}
+
 void CalculationScheduler::mutate(std::vector<genome> &new_population) {
+    ScopedTimer mutate_timer(PHASE_MUTATE);
+    mutate_range(new_population, 1, this->input_params.population_size);
+}
+
+void CalculationScheduler::mutate_range(std::vector<genome> &new_population, size_t begin, size_t end) {
 
     const double mutate_scope = this->input_params.const_scope * 0.01; //we want only 1% of the original
 
@@ -218,10 +305,9 @@ void CalculationScheduler::mutate(std::vector<genome> &new_population) {
                                                            this->input_params.pow_scope); // define the range
 
     std::uniform_int_distribution<> mutateIndexUniformIntDistribution(1,7);
+    MetricsRegistry::increment(COUNTER_MUTATED_GENOMES, end - begin);
 
-    const auto count = this->input_params.population_size;
-
-    for (int i = 1; i < count; ++i) {
+    for (size_t i = begin; i < end; ++i) {
         auto index = mutateIndexUniformIntDistribution(this->mt19937_generator);
         auto& gen = new_population[i];
         if(index > 4){
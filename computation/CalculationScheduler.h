@@ -21,26 +21,39 @@ struct genome{
     std::array<unsigned char, GENOME_POW_SIZE> powers {};
 };
 
+/// Sums over the transformed data needed to calculate the correlation of one genome
+struct correlation_sums{
+    double acc_sum = 0;
+    double acc_sum_pow_2 = 0;
+    double hr_acc_sum = 0;
+};
+
 inline void print_genome(const genome &best_genome) {
     auto& c = best_genome.constants;
     auto& p = best_genome.powers;
     std::cout << "Best polynomial: "    << c[0] << "x^" << (int)p[0] << " + "
               << c[1] << "y^" << (int)p[1] << " + "
               << c[2] << "z^" << (int)p[2] << " + "
-              << c[3] << std::endl;
+              << c[3] << '\n';
 }
 
 class CalculationScheduler {
 
 public:
-    std::vector<double> transformation_result;
+    data_vector transformation_result;
 
 public:
 
     CalculationScheduler(const std::shared_ptr<input_data>& input, const input_parameters& input_params);
-    ~CalculationScheduler();
+    virtual ~CalculationScheduler();
+
+    virtual double find_transformation_function(genome& best_genome);
 
-    double find_transformation_function(genome& best_genome);
+    /// Measures evaluation of the population, the first evaluation only warms up the scheduler
+    /// \param population evaluated population
+    /// \param repetitions count of measured evaluations
+    /// \return shortest measured evaluation time in seconds
+    double benchmark_evaluation(const std::vector<genome>& population, size_t repetitions);
 
     void init_population(std::vector<genome>& init_population) const;
 
@@ -51,7 +64,22 @@ public:
 
     void mutate(std::vector<genome>& new_population);
 
-    void transform(const genome& genome1);
+    /// Fills the range of the new population with offspring of parents selected from the old population
+    /// \param old_population evaluated population the parents are selected from
+    /// \param new_population population that receives the offspring
+    /// \param begin index of the first offspring
+    /// \param end index after the last offspring
+    /// \param last_parent_index index of the last selected parent, kept between calls
+    void repopulate_range(const std::vector<genome>& old_population, std::vector<genome>& new_population,
+                          size_t begin, size_t end, size_t& last_parent_index);
+
+    /// Mutates single gene of every genome in the range
+    /// \param new_population population to be mutated
+    /// \param begin index of the first mutated genome
+    /// \param end index after the last mutated genome
+    void mutate_range(std::vector<genome>& new_population, size_t begin, size_t end);
+
+    virtual void transform(const genome& genome1);
 
 protected:
 
@@ -66,17 +94,35 @@ protected:
 
     const input_parameters input_params;
 
+    /// genomes of the warm start file, empty if the population starts random
+    std::vector<genome> warm_start_genomes;
+
 protected:
 
     /// function used to setup the whole calculation at the start of it
     virtual void init_calculation();
 
+    /// Replaces the beginning of the random population with the genomes of the warm start file and their
+    /// perturbations, the rest stays random
+    /// \param init_population random initial population
+    /// \param generator generator used for the initial population
+    void seed_population(std::vector<genome>& init_population, std::mt19937& generator) const;
+
     /// Function selects parent from the population vector
     /// \param vector population vector
     /// \param last_index last index of parent that was selected
     /// \return selected parent
     const genome* get_parent(const std::vector<genome> &vector, size_t &last_index);
 
+    /// Function transforms the data range according to genome without storing the result and sums
+    /// everything needed for correlation. Can be called from multiple threads at once
+    /// \param current_genome genome used for transformation
+    /// \param begin index of the first entry
+    /// \param end index after the last entry
+    /// \return sums of the range
+    [[nodiscard]] correlation_sums calculate_correlation_sums(const genome& current_genome,
+                                                              size_t begin, size_t end) const;
+
     /// Function calculates the correlation according to formula
     /// \param entries_count count of all data entries
     /// \param acc_sum sum of all transformed acc entries
@@ -85,6 +131,10 @@ protected:
     /// \return correlation value 0-1
     [[nodiscard]] double get_abs_correlation_coefficient(double entries_count, double acc_sum,
                                                          double acc_sum_pow_2, double hr_acc_sum) const;
+
+    /// \param population_size size of the evaluated population
+    /// \return count of data entries visited by the last evaluation of the population
+    [[nodiscard]] virtual uint64_t get_sample_visits(size_t population_size) const;
 };
 
 
@@ -0,0 +1,85 @@
+#include "DeviceCalculationScheduler.h"
+#include "../metrics/MetricsRegistry.h"
+
+
+DeviceCalculationScheduler::DeviceCalculationScheduler(OpenCLComponent& cl, const std::shared_ptr<input_data>& input,
+                                                       const input_parameters& input_params)
+                                                       : CalculationScheduler(input, input_params), cl_device(cl){
+
+}
+
+double DeviceCalculationScheduler::find_transformation_function(genome &best_genome) {
+    init_calculation();
+
+    std::vector<genome> init_genomes (this->input_params.population_size);
+    {
+        ScopedTimer init_timer(PHASE_INITIALIZE);
+        init_population(init_genomes);
+    }
+
+    uint32_t step_done_count = 0;
+    double best_corr = 0;
+    const auto desired_corr = this->input_params.desired_correlation;
+    const auto max_step_count = this->input_params.max_step_count;
+
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    try{
+#endif
+        OpenCLGeneticComponent genetic_component(this->cl_device, this->input, this->input_params);
+        genetic_component.upload_population(init_genomes);
+
+        std::cout << "Starting the main cycle on the device." << std::endl;
+        auto interval_start = std::chrono::high_resolution_clock::now();
+        OpenCLProfiler* profiler = this->cl_device.get_profiler();
+        while(step_done_count < max_step_count){
+            if(profiler != nullptr){
+                profiler->begin_generation();
+            }
+            //kernels are only enqueued here, their durations are measured by the OpenCL profiler
+            genetic_component.evaluate_population();
+            MetricsRegistry::increment(COUNTER_GENERATIONS);
+            MetricsRegistry::increment(COUNTER_EVALUATED_GENOMES, this->input_params.population_size);
+
+            //the host synchronizes with the device only when the best genome is read back
+            const bool is_last_step = step_done_count + 1 == max_step_count;
+            if(step_done_count % this->input_params.step_info_interval == 0 || is_last_step){
+                best_corr = genetic_component.read_best_genome(best_genome);
+                if(profiler != nullptr){
+                    profiler->collect();
+                    profiler->print_due_summaries();
+                }
+                auto interval_end = std::chrono::high_resolution_clock::now();
+                std::cout << "Device generations up to " << step_done_count + 1 << "th step took "
+                          << std::chrono::duration_cast<std::chrono::milliseconds>(interval_end - interval_start).count()
+                          << " ms" << '\n';
+                interval_start = interval_end;
+
+                if(best_corr > desired_corr){
+                    std::cout << "Maximal (desired) correlation threshold reached (" << best_corr << ">"
+                              << desired_corr << ")! Stopping at " << step_done_count << "th step!" << std::endl;
+                    break;
+                }
+                std::cout << step_done_count + 1 << "th step was done. Current best correlation: "
+                          << best_corr << '\n';
+                print_genome(best_genome);
+            }
+
+            genetic_component.breed_population();
+            ++step_done_count;
+        }
+        //the best genome of the last evaluated population survives in the current one
+        best_corr = genetic_component.read_best_genome(best_genome);
+        if(profiler != nullptr){
+            profiler->collect();
+        }
+
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    } catch (cl::Error err) {
+        std::cerr << "Error occurred during gpu computation: " << err.what() << "(" << err.err() << " - "
+                  << OpenCLComponent::Get_OpenCL_Error_Desc(err.err()) << ")" << std::endl;
+        exit(1);
+    }
+#endif
+
+    return best_corr;
+}
@@ -0,0 +1,23 @@
+#ifndef OCL_TEST_DEVICECALCULATIONSCHEDULER_H
+#define OCL_TEST_DEVICECALCULATIONSCHEDULER_H
+
+
+#include "CalculationScheduler.h"
+#include "gpu/OpenCLGeneticComponent.h"
+
+/// Scheduler keeping the whole genetic algorithm on the openCL device. The host only reads back
+/// the best genome every step info interval.
+class DeviceCalculationScheduler : public CalculationScheduler {
+
+public:
+    DeviceCalculationScheduler(OpenCLComponent& cl, const std::shared_ptr<input_data>& input,
+                               const input_parameters& input_params);
+
+    double find_transformation_function(genome& best_genome) override;
+
+private:
+    OpenCLComponent& cl_device;
+};
+
+
+#endif //OCL_TEST_DEVICECALCULATIONSCHEDULER_H
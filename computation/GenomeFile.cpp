@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include "GenomeFile.h"
+
+
+bool GenomeFile::write(const std::string &file_name, const genome &best_genome, double correlation) {
+    std::ofstream file(file_name);
+    if(!file.is_open()){
+        return false;
+    }
+    const auto& c = best_genome.constants;
+    const auto& p = best_genome.powers;
+    //constants are written with full precision so the warm start continues from the same genome
+    file << "# best genome with correlation " << correlation
+         << ": constants c0 c1 c2 c3 and powers p0 p1 p2 p3\n";
+    file << std::setprecision(std::numeric_limits<double>::max_digits10)
+         << c[0] << " " << c[1] << " " << c[2] << " " << c[3] << " "
+         << (int)p[0] << " " << (int)p[1] << " " << (int)p[2] << " " << (int)p[3] << "\n";
+    return file.good();
+}
+
+std::vector<genome> GenomeFile::read(const std::string &file_name, int pow_scope) {
+    std::vector<genome> genomes;
+    std::ifstream file(file_name);
+    if(!file.is_open()){
+        std::cerr << "Genome file cannot be opened " << file_name << std::endl;
+        return genomes;
+    }
+    std::string line;
+    size_t line_number = 0;
+    while(std::getline(file, line)){
+        ++line_number;
+        const auto first = line.find_first_not_of(" \t\r");
+        if(first == std::string::npos || line[first] == '#'){
+            continue;
+        }
+        std::stringstream stream(line);
+        genome parsed {};
+        int powers[GENOME_POW_SIZE] {};
+        for(auto& constant: parsed.constants){
+            stream >> constant;
+        }
+        for(auto& power: powers){
+            stream >> power;
+        }
+        if(stream.fail()){
+            std::cerr << "Skipping malformed genome on line " << line_number << " of " << file_name << std::endl;
+            continue;
+        }
+        for(size_t i = 0; i < GENOME_POW_SIZE; ++i){
+            parsed.powers[i] = static_cast<unsigned char>(std::clamp(powers[i], 1, pow_scope));
+        }
+        genomes.push_back(parsed);
+    }
+    return genomes;
+}
@@ -0,0 +1,29 @@
+#ifndef OCL_TEST_GENOMEFILE_H
+#define OCL_TEST_GENOMEFILE_H
+
+
+#include <string>
+#include <vector>
+#include "CalculationScheduler.h"
+
+/// Reads and writes genomes as text lines "c0 c1 c2 c3 p0 p1 p2 p3", the same format as the ground truth
+/// of the generated datasets. Empty lines and lines starting with # are skipped.
+class GenomeFile {
+
+public:
+    /// Writes the genome into the file, the correlation is written into the comment
+    /// \param file_name path to the output file
+    /// \param best_genome genome that should be written
+    /// \param correlation correlation of the genome
+    /// \return true if the file was written
+    static bool write(const std::string& file_name, const genome& best_genome, double correlation);
+
+    /// Reads all genomes of the file, malformed lines are reported and skipped
+    /// \param file_name path to the input file
+    /// \param pow_scope powers are clamped into the range from 1 to this value, the range of the genetic algorithm
+    /// \return read genomes, empty if the file can't be opened
+    static std::vector<genome> read(const std::string& file_name, int pow_scope);
+};
+
+
+#endif //OCL_TEST_GENOMEFILE_H
@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <numeric>
+#include "HybridCalculationScheduler.h"
+#include "../metrics/MetricsRegistry.h"
+
+
+HybridCalculationScheduler::HybridCalculationScheduler(const std::vector<std::unique_ptr<OpenCLComponent>>& cl_devices,
+                                                       const std::shared_ptr<input_data>& input,
+                                                       const input_parameters& input_params)
+                                                       : ParallelCalculationScheduler(cl_devices, input, input_params){
+    //every device is driven by its own host thread, the rest of the cores is used for CPU evaluation
+    const size_t hardware_threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    this->cpu_threads_count = input_params.cpu_threads;
+    if(this->cpu_threads_count == 0){
+        this->cpu_threads_count = hardware_threads > this->device_slices.size()
+                                    ? hardware_threads - this->device_slices.size() : 1;
+    }
+}
+
+HybridCalculationScheduler::~HybridCalculationScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(this->workers_mutex);
+        this->stopping = true;
+    }
+    this->start_condition.notify_all();
+    for(auto& worker: this->workers){
+        worker.join();
+    }
+}
+
+void HybridCalculationScheduler::init_calculation() {
+    CalculationScheduler::init_calculation();
+
+    //every device evaluates whole genomes so it holds all the data
+    for(auto& slice: this->device_slices){
+        slice.offset = 0;
+        slice.entries_count = this->input->hr_entries_count;
+        slice.work_groups_count = slice.entries_count / slice.device.work_group_size;
+        slice.sum_reduce_result = {this->input_params.population_size,
+                                   {data_vector(slice.work_groups_count),
+                                    data_vector(slice.work_groups_count),
+                                    data_vector(slice.work_groups_count)
+                                   }};
+    }
+    std::cout << "Hybrid evaluation with " << this->cpu_threads_count << " CPU threads and "
+              << this->device_slices.size() << " devices" << std::endl;
+
+    if(!this->workers.empty()){
+        return;
+    }
+    for(auto& slice: this->device_slices){
+        this->workers.emplace_back(&HybridCalculationScheduler::worker_loop, this, &slice);
+    }
+    for(size_t i = 0; i < this->cpu_threads_count; ++i){
+        this->workers.emplace_back(&HybridCalculationScheduler::worker_loop, this, nullptr);
+    }
+}
+
+void HybridCalculationScheduler::worker_loop(device_slice *slice) {
+    uint64_t seen_generation = 0;
+    while(true){
+        const std::vector<genome>* population;
+        {
+            std::unique_lock<std::mutex> lock(this->workers_mutex);
+            this->start_condition.wait(lock, [&](){
+                return this->stopping || this->generation != seen_generation;
+            });
+            if(this->stopping){
+                return;
+            }
+            seen_generation = this->generation;
+            population = this->current_population;
+        }
+
+        std::exception_ptr error = nullptr;
+        try{
+            if(slice != nullptr){
+                device_worker(*slice, *population, this->dispatch_order);
+            }else{
+                cpu_worker(*population, this->dispatch_order);
+            }
+        }catch(...){
+            error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(this->workers_mutex);
+        if(error != nullptr && this->worker_error == nullptr){
+            this->worker_error = error;
+        }
+        if(--this->remaining_workers == 0){
+            this->done_condition.notify_one();
+        }
+    }
+}
+
+bool HybridCalculationScheduler::take_batch(const std::vector<size_t> &dispatch_order, std::vector<size_t> &batch) {
+    const size_t batch_size = this->input_params.hybrid_batch_size;
+    const size_t first = this->next_genome.fetch_add(batch_size);
+    batch.clear();
+    for(size_t i = first; i < first + batch_size && i < dispatch_order.size(); ++i){
+        batch.push_back(dispatch_order[i]);
+    }
+    return !batch.empty();
+}
+
+void HybridCalculationScheduler::cpu_worker(const std::vector<genome> &population,
+                                            const std::vector<size_t> &dispatch_order) {
+    const size_t entries_count = this->input->hr_entries_count;
+    std::vector<size_t> batch;
+    while(take_batch(dispatch_order, batch)){
+        for(const auto index: batch){
+            const auto sums = calculate_correlation_sums(population[index], 0, entries_count);
+            this->corr_result[index] = get_abs_correlation_coefficient(static_cast<double>(entries_count),
+                                                                       sums.acc_sum, sums.acc_sum_pow_2,
+                                                                       sums.hr_acc_sum);
+        }
+        this->cpu_evaluated_count += batch.size();
+    }
+}
+
+void HybridCalculationScheduler::device_worker(device_slice &slice, const std::vector<genome> &population,
+                                               const std::vector<size_t> &dispatch_order) {
+    const size_t entries_count = this->input->hr_entries_count;
+    std::vector<size_t> batch;
+    std::vector<cl::Event> synch_events(this->input_params.hybrid_batch_size);
+    while(take_batch(dispatch_order, batch)){
+        for(size_t i = 0; i < batch.size(); ++i){
+            const auto index = batch[i];
+            slice.device.calculate_correlation(population[index], slice.sum_reduce_result[index],
+                                               slice.entries_count, slice.work_groups_count, synch_events[i]);
+        }
+        slice.device.finish();
+
+        for(const auto index: batch){
+            const auto& [out_acc, out_acc2, out_acc_hr] = slice.sum_reduce_result[index];
+            double acc_sum = 0, acc_sum_pow_2 = 0, hr_acc_sum = 0;
+            for(size_t i = 0; i < slice.work_groups_count; ++i){
+                acc_sum += out_acc[i];
+                acc_sum_pow_2 += out_acc2[i];
+                hr_acc_sum += out_acc_hr[i];
+            }
+            this->corr_result[index] = get_abs_correlation_coefficient(static_cast<double>(entries_count),
+                                                                       acc_sum, acc_sum_pow_2, hr_acc_sum);
+        }
+        this->device_evaluated_count += batch.size();
+    }
+}
+
+double HybridCalculationScheduler::transform_and_correlation(const std::vector<genome> &population,
+                                                             size_t &best_index) {
+    this->dispatch_order.resize(population.size());
+    std::iota(this->dispatch_order.begin(), this->dispatch_order.end(), 0);
+    if(!this->device_slices.empty() && this->device_slices[0].device.specialized_kernels){
+        std::stable_sort(this->dispatch_order.begin(), this->dispatch_order.end(), [&](size_t a, size_t b){
+            return OpenCLComponent::get_power_key(population[a]) < OpenCLComponent::get_power_key(population[b]);
+        });
+    }
+
+    OpenCLProfiler* profiler = this->device_slices[0].device.get_profiler();
+    if(profiler != nullptr){
+        profiler->begin_generation();
+    }
+
+    this->next_genome = 0;
+    this->cpu_evaluated_count = 0;
+    this->device_evaluated_count = 0;
+
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    try{
+#endif
+        for(auto& slice: this->device_slices){
+            slice.device.init_static_buffers(input, slice.offset, sizeof(double) * slice.entries_count,
+                                             slice.work_groups_count);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this->workers_mutex);
+            this->current_population = &population;
+            this->remaining_workers = this->workers.size();
+            this->worker_error = nullptr;
+            ++this->generation;
+        }
+        this->start_condition.notify_all();
+        {
+            std::unique_lock<std::mutex> lock(this->workers_mutex);
+            this->done_condition.wait(lock, [this](){ return this->remaining_workers == 0; });
+        }
+        if(this->worker_error != nullptr){
+            std::rethrow_exception(this->worker_error);
+        }
+
+        if(profiler != nullptr){
+            profiler->collect();
+            profiler->print_due_summaries();
+        }
+
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    } catch (cl::Error err) {
+        std::cerr << "Error occurred during gpu computation: " << err.what() << "(" << err.err() << " - "
+                  << OpenCLComponent::Get_OpenCL_Error_Desc(err.err()) << ")" << std::endl;
+        exit(1);
+    }
+#endif
+
+    MetricsRegistry::increment(COUNTER_HYBRID_CPU_GENOMES, this->cpu_evaluated_count);
+    MetricsRegistry::increment(COUNTER_HYBRID_DEVICE_GENOMES, this->device_evaluated_count);
+
+    double best_corr = 0;
+    for(size_t gen_index = 0; gen_index < population.size(); ++gen_index){
+        if(this->corr_result[gen_index] > best_corr){
+            best_corr = this->corr_result[gen_index];
+            best_index = gen_index;
+        }
+    }
+    return best_corr;
+}
@@ -0,0 +1,78 @@
+#ifndef OCL_TEST_HYBRIDCALCULATIONSCHEDULER_H
+#define OCL_TEST_HYBRIDCALCULATIONSCHEDULER_H
+
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include "ParallelCalculationScheduler.h"
+
+/// Scheduler evaluating the population on CPU threads and openCL devices at once. All workers pull
+/// batches of genomes from one shared queue, so faster workers automatically evaluate more genomes.
+/// The workers are started once and wait for every new population.
+class HybridCalculationScheduler : public ParallelCalculationScheduler {
+
+public:
+    HybridCalculationScheduler(const std::vector<std::unique_ptr<OpenCLComponent>>& cl_devices,
+                               const std::shared_ptr<input_data>& input, const input_parameters& input_params);
+
+    ~HybridCalculationScheduler() override;
+
+protected:
+
+    void init_calculation() override;
+
+    double transform_and_correlation(const std::vector<genome>& population, size_t &best_index) override;
+
+private:
+    /// count of CPU worker threads
+    size_t cpu_threads_count = 1;
+
+    /// index into the dispatch order of the next genome that was not taken by any worker yet
+    std::atomic<size_t> next_genome {0};
+
+    /// counts of genomes evaluated by the CPU threads and the devices in the last population
+    std::atomic<size_t> cpu_evaluated_count {0};
+    std::atomic<size_t> device_evaluated_count {0};
+
+    /// device workers first, one for every slice, then the CPU workers
+    std::vector<std::thread> workers;
+
+    std::mutex workers_mutex;
+    std::condition_variable start_condition;
+    std::condition_variable done_condition;
+    /// incremented with every evaluated population, the workers wait for a new value
+    uint64_t generation = 0;
+    /// count of workers that didn't finish the current population yet
+    size_t remaining_workers = 0;
+    bool stopping = false;
+    const std::vector<genome>* current_population = nullptr;
+    /// order in which the genomes of the current population are taken
+    std::vector<size_t> dispatch_order;
+    /// first exception thrown by a worker during the current population
+    std::exception_ptr worker_error = nullptr;
+
+private:
+
+    /// Takes next batch of genomes from the shared queue
+    /// \param dispatch_order order in which the genomes are taken
+    /// \param batch output vector with indices of the genomes in the batch
+    /// \return false if there are no more genomes left
+    bool take_batch(const std::vector<size_t>& dispatch_order, std::vector<size_t>& batch);
+
+    /// Worker evaluating genome batches on CPU until the queue is empty
+    void cpu_worker(const std::vector<genome>& population, const std::vector<size_t>& dispatch_order);
+
+    /// Worker evaluating genome batches on the slice device until the queue is empty
+    void device_worker(device_slice& slice, const std::vector<genome>& population,
+                       const std::vector<size_t>& dispatch_order);
+
+    /// Evaluates batches of every population until the scheduler stops
+    /// \param slice device slice of the worker, nullptr for the CPU workers
+    void worker_loop(device_slice* slice);
+};
+
+
+#endif //OCL_TEST_HYBRIDCALCULATIONSCHEDULER_H
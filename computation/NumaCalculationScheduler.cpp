@@ -0,0 +1,253 @@
+#include <algorithm>
+#include "NumaCalculationScheduler.h"
+#include "../simd/SimdDispatch.h"
+
+
+NumaCalculationScheduler::NumaCalculationScheduler(const std::shared_ptr<input_data> &input,
+                                                   const input_parameters &input_params)
+                                                   : CalculationScheduler(input, input_params){
+    this->nodes = NumaTopology::detect_nodes();
+}
+
+NumaCalculationScheduler::~NumaCalculationScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(this->workers_mutex);
+        this->stopping = true;
+    }
+    this->start_condition.notify_all();
+    for(auto& worker: this->workers){
+        worker->thread.join();
+    }
+}
+
+void NumaCalculationScheduler::init_calculation() {
+    CalculationScheduler::init_calculation();
+    if(!this->workers.empty()){
+        return;
+    }
+    create_workers();
+
+    //wait until every worker has its data copied, the first population would otherwise measure the copy
+    {
+        std::unique_lock<std::mutex> lock(this->workers_mutex);
+        this->done_condition.wait(lock, [this](){ return this->remaining_workers == 0; });
+    }
+    release_input_columns();
+}
+
+void NumaCalculationScheduler::release_input_columns() {
+    const size_t entries_count = this->input->hr_entries_count;
+    if(this->input->compressed != nullptr){
+        auto& compressed = *this->input->compressed;
+        if(compressed.acc_x.codes.size() != entries_count || compressed.hr.codes.size() != entries_count){
+            return;
+        }
+        for(auto* codes: {&compressed.acc_x.codes, &compressed.acc_y.codes, &compressed.acc_z.codes}){
+            decltype(compressed.acc_x.codes)().swap(*codes);
+        }
+        decltype(compressed.hr.codes)().swap(compressed.hr.codes);
+    }else{
+        for(const auto* column: {&this->input->acc_x, &this->input->acc_y, &this->input->acc_z, &this->input->hr}){
+            if((*column)->values.size() != entries_count){
+                return;
+            }
+        }
+        for(auto* column: {&this->input->acc_x, &this->input->acc_y, &this->input->acc_z, &this->input->hr}){
+            data_vector().swap((*column)->values);
+        }
+    }
+    this->input_released = true;
+}
+
+template<class Column, class GetPart>
+void NumaCalculationScheduler::gather_column(Column &column, const GetPart &get_part) {
+    size_t entries_count = 0;
+    for(const auto& worker: this->workers){
+        entries_count += get_part(*worker).size();
+    }
+    column.resize(entries_count);
+    size_t offset = 0;
+    for(const auto& worker: this->workers){
+        auto& part = get_part(*worker);
+        std::copy(part.begin(), part.end(), column.begin() + static_cast<std::ptrdiff_t>(offset));
+        offset += part.size();
+        Column().swap(part);
+    }
+}
+
+void NumaCalculationScheduler::restore_input_columns() {
+    if(!this->input_released){
+        return;
+    }
+    //columns are gathered one by one, so only one column is held twice at once
+    if(this->input->compressed != nullptr){
+        auto& compressed = *this->input->compressed;
+        gather_column(compressed.acc_x.codes, [](numa_worker& worker) -> auto& { return worker.compressed.acc_x.codes; });
+        gather_column(compressed.acc_y.codes, [](numa_worker& worker) -> auto& { return worker.compressed.acc_y.codes; });
+        gather_column(compressed.acc_z.codes, [](numa_worker& worker) -> auto& { return worker.compressed.acc_z.codes; });
+        gather_column(compressed.hr.codes, [](numa_worker& worker) -> auto& { return worker.compressed.hr.codes; });
+    }else{
+        gather_column(this->input->acc_x->values, [](numa_worker& worker) -> auto& { return worker.acc_x; });
+        gather_column(this->input->acc_y->values, [](numa_worker& worker) -> auto& { return worker.acc_y; });
+        gather_column(this->input->acc_z->values, [](numa_worker& worker) -> auto& { return worker.acc_z; });
+        gather_column(this->input->hr->values, [](numa_worker& worker) -> auto& { return worker.hr; });
+    }
+    this->input_released = false;
+}
+
+void NumaCalculationScheduler::transform(const genome &genome1) {
+    restore_input_columns();
+    CalculationScheduler::transform(genome1);
+}
+
+void NumaCalculationScheduler::create_workers() {
+    size_t cpus_count = 0;
+    for(const auto& node: this->nodes){
+        cpus_count += node.cpus.size();
+    }
+    const size_t threads_count = this->input_params.cpu_threads > 0
+                                    ? std::min(this->input_params.cpu_threads, cpus_count) : cpus_count;
+
+    //threads are split between the nodes according to their CPU counts, every used node gets at least one
+    std::vector<size_t> node_threads(this->nodes.size(), 0);
+    size_t assigned_threads = 0;
+    for(size_t n = 0; n < this->nodes.size() && assigned_threads < threads_count; ++n){
+        const size_t threads = std::max<size_t>(1, threads_count * this->nodes[n].cpus.size() / cpus_count);
+        node_threads[n] = std::min(threads, threads_count - assigned_threads);
+        assigned_threads += node_threads[n];
+    }
+    for(size_t n = 0; assigned_threads < threads_count; n = (n + 1) % this->nodes.size()){
+        if(node_threads[n] < this->nodes[n].cpus.size()){
+            ++node_threads[n];
+            ++assigned_threads;
+        }
+    }
+
+    //every node gets the partition of the samples proportional to its threads
+    const size_t entries_count = this->input->hr_entries_count;
+    size_t worker_index = 0;
+    for(size_t n = 0; n < this->nodes.size(); ++n){
+        if(node_threads[n] == 0){
+            continue;
+        }
+        std::cout << "NUMA node " << this->nodes[n].id << " evaluates entries "
+                  << entries_count * worker_index / threads_count << " - "
+                  << entries_count * (worker_index + node_threads[n]) / threads_count
+                  << " with " << node_threads[n] << " threads" << std::endl;
+        for(size_t t = 0; t < node_threads[n]; ++t, ++worker_index){
+            auto worker = std::make_unique<numa_worker>();
+            worker->node_index = n;
+            worker->cpus = this->nodes[n].cpus;
+            worker->begin = entries_count * worker_index / threads_count;
+            worker->end = entries_count * (worker_index + 1) / threads_count;
+            this->workers.push_back(std::move(worker));
+        }
+    }
+    this->node_sums.resize(this->nodes.size());
+
+    this->remaining_workers = this->workers.size();
+    for(auto& worker: this->workers){
+        worker->thread = std::thread(&NumaCalculationScheduler::worker_loop, this, std::ref(*worker));
+    }
+}
+
+void NumaCalculationScheduler::worker_loop(numa_worker &worker) {
+    //the pages are placed on the node of the thread that writes them first, so the worker has to be pinned
+    //before its data are allocated
+    NumaTopology::pin_current_thread(worker.cpus);
+    const bool compressed = input->compressed != nullptr;
+    if(compressed){
+        worker.compressed = input->compressed->slice(worker.begin, worker.end);
+    }else{
+        worker.acc_x.assign(input->acc_x->values.begin() + worker.begin, input->acc_x->values.begin() + worker.end);
+        worker.acc_y.assign(input->acc_y->values.begin() + worker.begin, input->acc_y->values.begin() + worker.end);
+        worker.acc_z.assign(input->acc_z->values.begin() + worker.begin, input->acc_z->values.begin() + worker.end);
+        worker.hr.assign(input->hr->values.begin() + worker.begin, input->hr->values.begin() + worker.end);
+    }
+    finish_work();
+
+    uint64_t seen_generation = 0;
+    const auto& kernels = SimdDispatch::get_kernels();
+    const size_t count = worker.end - worker.begin;
+    while(true){
+        const std::vector<genome>* population;
+        {
+            std::unique_lock<std::mutex> lock(this->workers_mutex);
+            this->start_condition.wait(lock, [&](){
+                return this->stopping || this->generation != seen_generation;
+            });
+            if(this->stopping){
+                return;
+            }
+            seen_generation = this->generation;
+            population = this->current_population;
+        }
+
+        worker.sums.resize(population->size());
+        for(size_t gen_index = 0; gen_index < population->size(); ++gen_index){
+            const auto& current_genome = (*population)[gen_index];
+            const auto sums = compressed
+                    ? kernels.compressed_correlation_sums(worker.compressed.get_simd_columns(0),
+                                                          current_genome.constants.data(),
+                                                          current_genome.powers.data(), count)
+                    : kernels.correlation_sums(worker.acc_x.data(), worker.acc_y.data(), worker.acc_z.data(),
+                                               worker.hr.data(), current_genome.constants.data(),
+                                               current_genome.powers.data(), count);
+            worker.sums[gen_index] = {sums.acc_sum, sums.acc_sum_pow_2, sums.hr_acc_sum};
+        }
+        finish_work();
+    }
+}
+
+void NumaCalculationScheduler::finish_work() {
+    std::lock_guard<std::mutex> lock(this->workers_mutex);
+    if(--this->remaining_workers == 0){
+        this->done_condition.notify_one();
+    }
+}
+
+double NumaCalculationScheduler::transform_and_correlation(const std::vector<genome> &population,
+                                                           size_t &best_index) {
+    {
+        std::lock_guard<std::mutex> lock(this->workers_mutex);
+        this->current_population = &population;
+        this->remaining_workers = this->workers.size();
+        ++this->generation;
+    }
+    this->start_condition.notify_all();
+    {
+        std::unique_lock<std::mutex> lock(this->workers_mutex);
+        this->done_condition.wait(lock, [this](){ return this->remaining_workers == 0; });
+    }
+
+    //the workers of one node are combined first, only the node results cross the interconnect
+    for(auto& sums: this->node_sums){
+        sums.assign(population.size(), correlation_sums{});
+    }
+    for(const auto& worker: this->workers){
+        auto& sums = this->node_sums[worker->node_index];
+        for(size_t gen_index = 0; gen_index < population.size(); ++gen_index){
+            sums[gen_index].acc_sum += worker->sums[gen_index].acc_sum;
+            sums[gen_index].acc_sum_pow_2 += worker->sums[gen_index].acc_sum_pow_2;
+            sums[gen_index].hr_acc_sum += worker->sums[gen_index].hr_acc_sum;
+        }
+    }
+
+    const auto entries_count = static_cast<double>(this->input->hr_entries_count);
+    double best_corr = 0;
+    for(size_t gen_index = 0; gen_index < population.size(); ++gen_index){
+        correlation_sums total;
+        for(const auto& sums: this->node_sums){
+            total.acc_sum += sums[gen_index].acc_sum;
+            total.acc_sum_pow_2 += sums[gen_index].acc_sum_pow_2;
+            total.hr_acc_sum += sums[gen_index].hr_acc_sum;
+        }
+        this->corr_result[gen_index] = get_abs_correlation_coefficient(entries_count, total.acc_sum,
+                                                                       total.acc_sum_pow_2, total.hr_acc_sum);
+        if(this->corr_result[gen_index] > best_corr){
+            best_corr = this->corr_result[gen_index];
+            best_index = gen_index;
+        }
+    }
+    return best_corr;
+}
@@ -0,0 +1,103 @@
+#ifndef OCL_TEST_NUMACALCULATIONSCHEDULER_H
+#define OCL_TEST_NUMACALCULATIONSCHEDULER_H
+
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "CalculationScheduler.h"
+#include "../parallel/NumaTopology.h"
+
+/// Scheduler evaluating the population on CPU workers pinned to the NUMA nodes. The sample range is split
+/// into one partition per node and every partition between the workers of its node. The workers copy their
+/// part of the data after they are pinned, so the memory is allocated on their own node by the first touch,
+/// and evaluate all genomes over it. The loaded columns are released after the copies and gathered back
+/// only for the final transformation. Partial sums are combined per node first and then over the nodes.
+class NumaCalculationScheduler : public CalculationScheduler {
+
+public:
+    NumaCalculationScheduler(const std::shared_ptr<input_data>& input, const input_parameters& input_params);
+    ~NumaCalculationScheduler() override;
+
+protected:
+
+    void init_calculation() override;
+
+    double transform_and_correlation(const std::vector<genome>& population, size_t &best_index) override;
+
+public:
+    /// Gathers the node local copies back into the input columns and transforms them, the workers can't
+    /// evaluate any population afterwards
+    void transform(const genome& genome1) override;
+
+private:
+    /// Worker thread with its node local copy of the data range
+    struct numa_worker{
+        size_t node_index = 0;
+        /// CPUs of the node the worker is pinned to
+        std::vector<unsigned> cpus;
+
+        /// index of the first data entry of the range
+        size_t begin = 0;
+        /// index after the last data entry of the range
+        size_t end = 0;
+
+        /// columns of the range, allocated and filled by the worker itself
+        data_vector acc_x;
+        data_vector acc_y;
+        data_vector acc_z;
+        data_vector hr;
+        /// compressed columns of the range used instead of the ones above if the input is compressed
+        compressed_input compressed;
+
+        /// sums of the range for every genome of the population
+        std::vector<correlation_sums> sums;
+
+        std::thread thread;
+    };
+
+    std::vector<numa_node> nodes;
+    std::vector<std::unique_ptr<numa_worker>> workers;
+
+    /// partial sums of every node for every genome
+    std::vector<std::vector<correlation_sums>> node_sums;
+
+    std::mutex workers_mutex;
+    std::condition_variable start_condition;
+    std::condition_variable done_condition;
+    /// incremented with every evaluated population, the workers wait for a new value
+    uint64_t generation = 0;
+    /// count of workers that didn't finish the current population (or their data copy) yet
+    size_t remaining_workers = 0;
+    bool stopping = false;
+    const std::vector<genome>* current_population = nullptr;
+    /// flag indicating that the input columns were released after the workers copied them
+    bool input_released = false;
+
+private:
+
+    /// Creates workers of all nodes and assigns them their data ranges
+    void create_workers();
+
+    /// Pins the worker, copies its data range and evaluates the populations until the scheduler stops
+    /// \param worker worker executed by the calling thread
+    void worker_loop(numa_worker& worker);
+
+    /// Marks the work of one worker as done and wakes the scheduler if it was the last one
+    void finish_work();
+
+    /// Releases the loaded columns that were copied by the workers
+    void release_input_columns();
+
+    /// Moves the parts of the workers back into the input columns one column at a time
+    void restore_input_columns();
+
+    /// Concatenates the parts of all workers into the column and releases the parts
+    /// \param column column of all entries
+    /// \param get_part function returning the part of the column held by the worker
+    template<class Column, class GetPart>
+    void gather_column(Column& column, const GetPart& get_part);
+};
+
+
+#endif //OCL_TEST_NUMACALCULATIONSCHEDULER_H
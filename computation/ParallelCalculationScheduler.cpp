@@ -2,85 +2,213 @@
 // Created by pulta on 27.11.2023.
 //
 
-#include <execution>
+#include <numeric>
+#include <future>
 #include "ParallelCalculationScheduler.h"
+#include "../parallel/TaskPool.h"
+#include "../preprocessing/PageAllocator.h"
 
+/// evaluation whose durations are used to balance the slices, the first one is slowed down by the kernel builds
+const size_t BALANCE_MEASURED_GENERATION = 2;
 
-ParallelCalculationScheduler::ParallelCalculationScheduler(OpenCLComponent& cl,
+
+ParallelCalculationScheduler::ParallelCalculationScheduler(const std::vector<std::unique_ptr<OpenCLComponent>>& cl_devices,
                                                            const std::shared_ptr<input_data>& input,
                                                            const input_parameters& input_params)
-                                                           : CalculationScheduler(input, input_params), cl_device(cl){
-
+                                                           : CalculationScheduler(input, input_params){
+    for(const auto& cl_device: cl_devices){
+        this->device_slices.emplace_back(*cl_device);
+    }
+    this->slice_granularity = OpenCLComponent::get_common_work_group_size(cl_devices);
+    if(input_params.zero_copy){
+        //the page aligned input vectors can be used by the devices only from page boundaries
+        this->slice_alignment = PAGE_SIZE_BYTES / sizeof(double);
+    }
 }
 
 void ParallelCalculationScheduler::init_calculation() {
     CalculationScheduler::init_calculation();
 
-    const size_t entries_count = this->input->hr_entries_count;
-    const size_t work_groups_count = ceil((double)entries_count
-                                          / (double)this->cl_device.work_group_size);
-
-    this->sum_reduce_result = {this->input_params.population_size,
-                              {std::vector<double>(work_groups_count),
-                               std::vector<double>(work_groups_count),
-                               std::vector<double>(work_groups_count)
-                              }};
+    //without any measurement the data are split evenly
+    assign_slices(get_even_slice_sizes());
+}
+
+size_t ParallelCalculationScheduler::get_slice_step() const {
+    return std::lcm(this->slice_granularity, this->slice_alignment);
+}
+
+size_t ParallelCalculationScheduler::get_last_slice_size(size_t assigned) const {
+    return (this->input->hr_entries_count - assigned) / this->slice_granularity * this->slice_granularity;
+}
+
+std::vector<size_t> ParallelCalculationScheduler::get_even_slice_sizes() const {
+    const size_t slice_count = this->device_slices.size();
+    const size_t step = get_slice_step();
+    const size_t steps_count = this->input->hr_entries_count / step;
+    std::vector<size_t> slice_sizes(slice_count);
+    size_t assigned = 0;
+    for(size_t i = 0; i + 1 < slice_count; ++i){
+        slice_sizes[i] = steps_count * (i + 1) / slice_count * step - assigned;
+        assigned += slice_sizes[i];
+    }
+    slice_sizes[slice_count - 1] = get_last_slice_size(assigned);
+    return slice_sizes;
+}
+
+void ParallelCalculationScheduler::assign_slices(const std::vector<size_t> &slice_sizes) {
+    size_t offset = 0;
+    for(size_t i = 0; i < this->device_slices.size(); ++i){
+        auto& slice = this->device_slices[i];
+        slice.offset = offset;
+        slice.entries_count = slice_sizes[i];
+        slice.work_groups_count = slice.entries_count / slice.device.work_group_size;
+        slice.sum_reduce_result = {this->input_params.population_size,
+                                   {data_vector(slice.work_groups_count),
+                                    data_vector(slice.work_groups_count),
+                                    data_vector(slice.work_groups_count)
+                                   }};
+        slice.device.release_static_buffers();
+        offset += slice.entries_count;
+
+        if(this->device_slices.size() > 1){
+            std::cout << "Device " << slice.device.get_device_name() << " evaluates entries " << slice.offset
+                      << " - " << slice.offset + slice.entries_count << std::endl;
+        }
+    }
+}
+
+void ParallelCalculationScheduler::evaluate_slice(device_slice &slice, const std::vector<genome> &population,
+                                                  const std::vector<size_t> &dispatch_order) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    std::vector<cl::Event> synch_events(population.size());
+
+    for(const auto index: dispatch_order) {
+        //every genome has its on result buffers for sum reduce
+        auto& result = slice.sum_reduce_result[index];
+        slice.device.calculate_correlation(population[index], result,
+                                           slice.entries_count, slice.work_groups_count, synch_events[index]);
+    }
+    slice.device.finish();
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    slice.last_duration = std::chrono::duration<double>(end_time - start_time).count();
+}
+
+void ParallelCalculationScheduler::balance_slices() {
+    this->slices_balanced = true;
+    double total_throughput = 0;
+    for(const auto& slice: this->device_slices){
+        if(slice.last_duration <= 0){
+            return;
+        }
+        total_throughput += static_cast<double>(slice.entries_count) / slice.last_duration;
+    }
+
+    const size_t step = get_slice_step();
+    const size_t steps_count = this->input->hr_entries_count / step;
+    const size_t slice_count = this->device_slices.size();
+    std::vector<size_t> slice_sizes(slice_count);
+    size_t assigned_steps = 0;
+    for(size_t i = 0; i + 1 < slice_count; ++i){
+        const auto& slice = this->device_slices[i];
+        const double share = static_cast<double>(slice.entries_count) / slice.last_duration / total_throughput;
+        //every device keeps at least one step and leaves at least one for every following device
+        size_t steps = std::max<size_t>(1, static_cast<size_t>(share * static_cast<double>(steps_count)));
+        steps = std::min(steps, steps_count - assigned_steps - (slice_count - i - 1));
+        slice_sizes[i] = steps * step;
+        assigned_steps += steps;
+    }
+    slice_sizes[slice_count - 1] = get_last_slice_size(assigned_steps * step);
+
+    std::cout << "Rebalancing data slices according to measured device throughput" << std::endl;
+    assign_slices(slice_sizes);
 }
 
 
 double ParallelCalculationScheduler::transform_and_correlation(const std::vector<genome>& population, size_t &best_index) {
 
-    const cl::size_type numbers_bytes_size = sizeof(double) * input->hr_entries_count;
     const size_t entries_count = this->input->hr_entries_count;
-    const size_t work_groups_count = ceil((double)entries_count
-                                                    / (double)this->cl_device.work_group_size);
     double best_corr = 0;
-    size_t gen_index = 0;
 
-    std::vector<cl::Event> synch_events(this->input_params.population_size);
+    OpenCLProfiler* profiler = this->device_slices[0].device.get_profiler();
+    if(profiler != nullptr){
+        profiler->begin_generation();
+    }
+
 #if defined(CL_HPP_ENABLE_EXCEPTIONS)
     try{
 #endif
+        //genomes sharing the power triple are dispatched together so the same kernel variant is reused
+        std::vector<size_t> dispatch_order(population.size());
+        std::iota(dispatch_order.begin(), dispatch_order.end(), 0);
+        if(!this->device_slices.empty() && this->device_slices[0].device.specialized_kernels){
+            std::stable_sort(dispatch_order.begin(), dispatch_order.end(), [&](size_t a, size_t b){
+                return OpenCLComponent::get_power_key(population[a]) < OpenCLComponent::get_power_key(population[b]);
+            });
+        }
+
         //check if buffers are already initialized
-        cl_device.init_static_buffers(input, numbers_bytes_size, work_groups_count);
-        //first assign the jobs to gpu queue
-        for(const auto& curr_gen: population) {
-            //every genome has its on result buffers for sum reduce
-            auto& result = this->sum_reduce_result[gen_index];
-            cl_device.calculate_correlation(curr_gen, result,
-                                            entries_count, work_groups_count, synch_events[gen_index]);
-            ++gen_index;
+        for(auto& slice: this->device_slices){
+            slice.device.init_static_buffers(input, slice.offset, sizeof(double) * slice.entries_count,
+                                             slice.work_groups_count);
         }
 
-        synch_events[gen_index - 1].wait();
-        gen_index = 0;
+        if(this->device_slices.size() == 1){
+            evaluate_slice(this->device_slices[0], population, dispatch_order);
+        }else{
+            //every device is driven by its own host thread so that their durations can be measured
+            std::vector<std::future<void>> device_jobs;
+            for(auto& slice: this->device_slices){
+                device_jobs.push_back(std::async(std::launch::async, [&](){
+                    evaluate_slice(slice, population, dispatch_order);
+                }));
+            }
+            for(auto& device_job: device_jobs){
+                device_job.get();
+            }
+        }
 
-        //now for every sum reduce calculate correlation
-        for(auto& [out_acc, out_acc2, out_acc_hr]: this->sum_reduce_result){
+        if(profiler != nullptr){
+            profiler->collect();
+            profiler->print_due_summaries();
+        }
+
+        //now for every genome combine the partial sums of all slices and calculate correlation,
+        //genomes are independent so they are combined in parallel
+        parallel_for(0, population.size(), [&](size_t gen_index){
             double acc_sum = 0, acc_sum_pow_2 = 0, hr_acc_sum = 0;
 
-            // sum the partial sums
-            #pragma loop(hint_parallel(VECTOR_SIZE_MACRO))
-            for(size_t i = 0; i < work_groups_count; ++i){
-                acc_sum += out_acc[i];
-                acc_sum_pow_2 += out_acc2[i];
-                hr_acc_sum += out_acc_hr[i];
+            for(const auto& slice: this->device_slices){
+                const auto& [out_acc, out_acc2, out_acc_hr] = slice.sum_reduce_result[gen_index];
+                // sum the partial sums
+                for(size_t i = 0; i < slice.work_groups_count; ++i){
+                    acc_sum += out_acc[i];
+                    acc_sum_pow_2 += out_acc2[i];
+                    hr_acc_sum += out_acc_hr[i];
+                }
             }
 
-            double corr_abs = this->get_abs_correlation_coefficient(static_cast<double>(entries_count),
-                                                                    acc_sum, acc_sum_pow_2, hr_acc_sum);
-            if(corr_abs > best_corr){
-                best_corr = corr_abs;
+            this->corr_result[gen_index] = this->get_abs_correlation_coefficient(
+                    static_cast<double>(entries_count), acc_sum, acc_sum_pow_2, hr_acc_sum);
+        }, 1);
+        for(size_t gen_index = 0; gen_index < population.size(); ++gen_index){
+            if(this->corr_result[gen_index] > best_corr){
+                best_corr = this->corr_result[gen_index];
                 best_index = gen_index;
             }
-            this->corr_result[gen_index] = corr_abs;
-            ++gen_index;
+        }
+
+        //first evaluation includes the program builds, so the following one serves as the throughput measurement
+        ++this->evaluated_generations;
+        if(this->device_slices.size() > 1 && !this->slices_balanced
+                && this->evaluated_generations >= BALANCE_MEASURED_GENERATION){
+            balance_slices();
         }
 
 #if defined(CL_HPP_ENABLE_EXCEPTIONS)
     } catch (cl::Error err) {
         std::cerr << "Error occurred during gpu computation: " << err.what() << "(" << err.err() << " - "
-                  << cl_device.Get_OpenCL_Error_Desc(err.err()) << ")" << std::endl;
+                  << OpenCLComponent::Get_OpenCL_Error_Desc(err.err()) << ")" << std::endl;
          exit(1);
     }
 #endif
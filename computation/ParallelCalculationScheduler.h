@@ -9,11 +9,31 @@
 #include "CalculationScheduler.h"
 #include "gpu/OpenCLComponent.h"
 
+/// Part of the input data that is evaluated by one openCL device
+struct device_slice{
+    OpenCLComponent& device;
+
+    /// index of the first data entry of this slice
+    size_t offset = 0;
+    /// count of data entries of this slice
+    size_t entries_count = 0;
+    size_t work_groups_count = 0;
+
+    /// output vector of the reduce function from the device
+    std::vector<partial_sums> sum_reduce_result;
+
+    /// time in seconds the device needed for evaluation of the last population
+    double last_duration = 0;
+
+    explicit device_slice(OpenCLComponent& device) : device(device){
+    }
+};
+
 class ParallelCalculationScheduler : public CalculationScheduler {
 
 public:
-    ParallelCalculationScheduler(OpenCLComponent& cl, const std::shared_ptr<input_data>& input,
-                                 const input_parameters& input_params);
+    ParallelCalculationScheduler(const std::vector<std::unique_ptr<OpenCLComponent>>& cl_devices,
+                                 const std::shared_ptr<input_data>& input, const input_parameters& input_params);
 
 protected:
 
@@ -21,12 +41,48 @@ protected:
 
     double transform_and_correlation(const std::vector<genome>& population, size_t &best_index) override;
 
-private:
-    OpenCLComponent& cl_device;
+protected:
+    /// data slices of all used devices
+    std::vector<device_slice> device_slices;
+
+    /// count of entries every slice size has to be divisible by
+    size_t slice_granularity = 1;
+
+    /// count of entries every slice offset has to be divisible by, zero copy buffers have to start on a page
+    size_t slice_alignment = 1;
+
+    /// flag indicating that the slices were already resized according to measured device throughput
+    bool slices_balanced = false;
+
+    /// count of populations evaluated by the devices so far
+    size_t evaluated_generations = 0;
+
+protected:
+
+    /// Splits the input entries into slices of the passed sizes and prepares the result buffers for them
+    /// \param slice_sizes entries count for every device slice
+    void assign_slices(const std::vector<size_t>& slice_sizes);
+
+    /// \return count of entries every slice but the last one has to be divisible by, so the next offset is aligned
+    [[nodiscard]] size_t get_slice_step() const;
+
+    /// \param assigned count of entries assigned to the previous slices
+    /// \return size of the last slice holding all remaining entries the devices can evaluate
+    [[nodiscard]] size_t get_last_slice_size(size_t assigned) const;
+
+    /// \return slice sizes splitting the input entries evenly between the devices
+    [[nodiscard]] std::vector<size_t> get_even_slice_sizes() const;
 
-    /// output vector of the reduce function from gpu device
-    std::vector<std::array<std::vector<double>, 3>> sum_reduce_result;
+    /// Enqueues whole population to the slice device and waits for the results
+    /// \param slice device slice that should be evaluated
+    /// \param population genomes that should be evaluated
+    /// \param dispatch_order order in which the genomes are enqueued
+    static void evaluate_slice(device_slice& slice, const std::vector<genome>& population,
+                               const std::vector<size_t>& dispatch_order);
 
+    /// Resizes the device slices according to throughput measured in the last evaluation, which must not include
+    /// the program builds
+    void balance_slices();
 };
 
 
@@ -0,0 +1,168 @@
+#include <cstring>
+#include "PipelinedCalculationScheduler.h"
+#include "../metrics/MetricsRegistry.h"
+#include "../metrics/PerfCounters.h"
+
+
+PipelinedCalculationScheduler::PipelinedCalculationScheduler(const std::vector<std::unique_ptr<OpenCLComponent>>& cl_devices,
+                                                             const std::shared_ptr<input_data>& input,
+                                                             const input_parameters& input_params)
+                                                             : ParallelCalculationScheduler(cl_devices, input, input_params),
+                                                             chunks_count(std::min(input_params.pipeline_chunks,
+                                                                                   input_params.population_size)){
+    this->chunk_markers = {this->chunks_count, std::vector<cl::Event>(this->device_slices.size())};
+    this->genome_events = {this->device_slices.size(), std::vector<cl::Event>(input_params.population_size)};
+}
+
+size_t PipelinedCalculationScheduler::chunk_begin(size_t chunk) const {
+    return chunk * this->input_params.population_size / this->chunks_count;
+}
+
+void PipelinedCalculationScheduler::submit_chunk(const std::vector<genome> &population, size_t chunk) {
+    const size_t begin = chunk_begin(chunk);
+    const size_t end = chunk_begin(chunk + 1);
+    for(size_t slice_index = 0; slice_index < this->device_slices.size(); ++slice_index){
+        auto& slice = this->device_slices[slice_index];
+        for(size_t i = begin; i < end; ++i){
+            slice.device.calculate_correlation(population[i], slice.sum_reduce_result[i], slice.entries_count,
+                                               slice.work_groups_count, this->genome_events[slice_index][i]);
+        }
+        slice.device.enqueue_marker(this->chunk_markers[chunk][slice_index]);
+    }
+}
+
+double PipelinedCalculationScheduler::score_population(size_t &best_index) {
+    const size_t entries_count = this->input->hr_entries_count;
+    double best_corr = 0;
+    for(size_t chunk = 0; chunk < this->chunks_count; ++chunk){
+        cl::Event::waitForEvents(this->chunk_markers[chunk]);
+
+        //the device continues with the following chunks meanwhile
+        for(size_t gen_index = chunk_begin(chunk); gen_index < chunk_begin(chunk + 1); ++gen_index){
+            double acc_sum = 0, acc_sum_pow_2 = 0, hr_acc_sum = 0;
+            for(const auto& slice: this->device_slices){
+                const auto& [out_acc, out_acc2, out_acc_hr] = slice.sum_reduce_result[gen_index];
+                for(size_t i = 0; i < slice.work_groups_count; ++i){
+                    acc_sum += out_acc[i];
+                    acc_sum_pow_2 += out_acc2[i];
+                    hr_acc_sum += out_acc_hr[i];
+                }
+            }
+            double corr_abs = this->get_abs_correlation_coefficient(static_cast<double>(entries_count),
+                                                                    acc_sum, acc_sum_pow_2, hr_acc_sum);
+            if(corr_abs > best_corr){
+                best_corr = corr_abs;
+                best_index = gen_index;
+            }
+            this->corr_result[gen_index] = corr_abs;
+        }
+    }
+    return best_corr;
+}
+
+void PipelinedCalculationScheduler::breed_and_submit(const std::vector<genome> &old_population,
+                                                     std::vector<genome> &new_population, size_t best_index) {
+    //copy the best genome to the next gen
+    std::memcpy(&new_population[0], &old_population[best_index], sizeof(genome));
+    size_t last_parent_index = 0;
+    for(size_t chunk = 0; chunk < this->chunks_count; ++chunk){
+        const size_t begin = std::max<size_t>(1, chunk_begin(chunk));
+        const size_t end = chunk_begin(chunk + 1);
+        repopulate_range(old_population, new_population, begin, end, last_parent_index);
+        mutate_range(new_population, begin, end);
+        submit_chunk(new_population, chunk);
+    }
+}
+
+double PipelinedCalculationScheduler::find_transformation_function(genome &best_genome) {
+    init_calculation();
+
+    std::vector<genome> curr_population (this->input_params.population_size);
+    std::vector<genome> next_population (this->input_params.population_size);
+
+    {
+        ScopedTimer init_timer(PHASE_INITIALIZE);
+        init_population(curr_population);
+    }
+
+    uint32_t step_done_count = 0;
+    double best_corr = 0;
+    size_t best_index = 0;
+    const auto desired_corr = this->input_params.desired_correlation;
+    OpenCLProfiler* profiler = this->device_slices[0].device.get_profiler();
+
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    try{
+#endif
+        for(auto& slice: this->device_slices){
+            slice.device.init_static_buffers(input, slice.offset, sizeof(double) * slice.entries_count,
+                                             slice.work_groups_count);
+        }
+
+        if(profiler != nullptr){
+            profiler->begin_generation();
+        }
+        for(size_t chunk = 0; chunk < this->chunks_count; ++chunk){
+            submit_chunk(curr_population, chunk);
+        }
+
+        std::cout << "Starting the pipelined main cycle with " << this->chunks_count << " chunks." << std::endl;
+        while(step_done_count < this->input_params.max_step_count){
+
+            {
+                ScopedTimer evaluate_timer(PHASE_EVALUATE);
+                ScopedPerfSample evaluate_sample(PERF_EVALUATE,
+                                                 this->input->hr_entries_count * curr_population.size());
+                best_corr = score_population(best_index);
+            }
+            MetricsRegistry::increment(COUNTER_GENERATIONS);
+            MetricsRegistry::increment(COUNTER_EVALUATED_GENOMES, curr_population.size());
+            if(profiler != nullptr){
+                profiler->collect();
+                profiler->print_due_summaries();
+            }
+
+            if(best_corr > desired_corr){
+                std::cout << "Maximal (desired) correlation threshold reached (" << best_corr << ">" << desired_corr
+                          << ")! Stopping at " << step_done_count << "th step!" << std::endl;
+                break;
+            }
+            if(step_done_count % this->input_params.step_info_interval == 0){
+                std::cout << step_done_count + 1 << "th step was done. Current best correlation: " << best_corr
+                          << '\n';
+                print_genome(curr_population[best_index]);
+            }
+
+            if(profiler != nullptr){
+                profiler->begin_generation();
+            }
+            //the offspring chunks are evaluated on the device while the following ones are being bred
+            {
+                //mutation of the chunks is interleaved with their submission, so it is a part of this phase
+                ScopedTimer repopulate_timer(PHASE_REPOPULATE);
+                ScopedPerfSample repopulate_sample(PERF_REPOPULATE, curr_population.size());
+                breed_and_submit(curr_population, next_population, best_index);
+            }
+            std::swap(curr_population, next_population);
+
+            //after new repopulation the best genome is at the first position again
+            best_index = 0;
+            ++step_done_count;
+        }
+
+        //the last submitted population might still be evaluated
+        for(auto& slice: this->device_slices){
+            slice.device.finish();
+        }
+
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    } catch (cl::Error err) {
+        std::cerr << "Error occurred during gpu computation: " << err.what() << "(" << err.err() << " - "
+                  << OpenCLComponent::Get_OpenCL_Error_Desc(err.err()) << ")" << std::endl;
+        exit(1);
+    }
+#endif
+
+    std::memcpy(&best_genome, &curr_population[best_index], sizeof(genome));
+    return best_corr;
+}
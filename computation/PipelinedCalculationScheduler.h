@@ -0,0 +1,50 @@
+#ifndef OCL_TEST_PIPELINEDCALCULATIONSCHEDULER_H
+#define OCL_TEST_PIPELINEDCALCULATIONSCHEDULER_H
+
+
+#include "ParallelCalculationScheduler.h"
+
+/// Scheduler splitting the population into chunks so that the device evaluates one chunk while the host
+/// scores the previous one or breeds the next one. Every offspring chunk is submitted right after it is bred.
+class PipelinedCalculationScheduler : public ParallelCalculationScheduler {
+
+public:
+    PipelinedCalculationScheduler(const std::vector<std::unique_ptr<OpenCLComponent>>& cl_devices,
+                                  const std::shared_ptr<input_data>& input, const input_parameters& input_params);
+
+    double find_transformation_function(genome& best_genome) override;
+
+private:
+    /// count of chunks the population is split into
+    const size_t chunks_count;
+
+    /// marker events of every chunk on every device [chunk][slice]
+    std::vector<std::vector<cl::Event>> chunk_markers;
+
+    /// kernel events of every genome on every device [slice][genome]
+    std::vector<std::vector<cl::Event>> genome_events;
+
+private:
+    /// \return index of the first genome of the chunk
+    [[nodiscard]] size_t chunk_begin(size_t chunk) const;
+
+    /// Enqueues all genomes of the chunk to all devices
+    /// \param population population the chunk belongs to
+    /// \param chunk index of the chunk
+    void submit_chunk(const std::vector<genome>& population, size_t chunk);
+
+    /// Waits for the chunks one by one and calculates correlation of their genomes as soon as they are ready
+    /// \param best_index output index of the best genome
+    /// \return best correlation of the population
+    double score_population(size_t& best_index);
+
+    /// Breeds the new population chunk by chunk and submits every chunk right after it is ready
+    /// \param old_population scored population
+    /// \param new_population population that receives the offspring
+    /// \param best_index index of the best genome of the old population
+    void breed_and_submit(const std::vector<genome>& old_population, std::vector<genome>& new_population,
+                          size_t best_index);
+};
+
+
+#endif //OCL_TEST_PIPELINEDCALCULATIONSCHEDULER_H
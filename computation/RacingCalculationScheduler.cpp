@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include "RacingCalculationScheduler.h"
+#include "../simd/SimdDispatch.h"
+
+
+RacingCalculationScheduler::RacingCalculationScheduler(const std::shared_ptr<input_data> &input,
+                                                       const input_parameters &input_params)
+                                                       : CalculationScheduler(input, input_params){
+}
+
+void RacingCalculationScheduler::init_calculation() {
+    CalculationScheduler::init_calculation();
+    if(!this->sample_x.empty()){
+        return;
+    }
+    build_subsample();
+}
+
+void RacingCalculationScheduler::build_subsample() {
+    const size_t entries_count = this->input->hr_entries_count;
+    if(entries_count < RACING_GROUPS_COUNT){
+        std::cout << "Racing needs at least " << RACING_GROUPS_COUNT << " entries, all genomes are evaluated on all "
+                  << entries_count << " entries" << std::endl;
+        return;
+    }
+    //every group needs at least one entry and no stratum can be empty
+    size_t sample_count = std::min(this->input_params.racing_sample_size, entries_count);
+    sample_count = std::max(RACING_GROUPS_COUNT, sample_count - sample_count % RACING_GROUPS_COUNT);
+    const size_t group_size = sample_count / RACING_GROUPS_COUNT;
+    this->sample_x.resize(sample_count);
+    this->sample_y.resize(sample_count);
+    this->sample_z.resize(sample_count);
+    this->sample_hr.resize(sample_count);
+
+    //own generator, so that the genetic algorithm gets the same random numbers as without racing
+    std::mt19937 generator(this->input_params.seed);
+    for(size_t s = 0; s < sample_count; ++s){
+        std::uniform_int_distribution<size_t> stratum(entries_count * s / sample_count,
+                                                      entries_count * (s + 1) / sample_count - 1);
+        const size_t position = s % RACING_GROUPS_COUNT * group_size + s / RACING_GROUPS_COUNT;
+        read_entry(stratum(generator), this->sample_x[position], this->sample_y[position],
+                   this->sample_z[position], this->sample_hr[position]);
+    }
+    std::cout << "Racing the population on " << sample_count << " of " << entries_count << " entries, "
+              << this->input_params.racing_fraction * 100 << "% of the genomes are evaluated on all of them"
+              << std::endl;
+}
+
+void RacingCalculationScheduler::read_entry(size_t index, double &x, double &y, double &z, double &hr) const {
+    if(this->input->compressed != nullptr){
+        const auto& compressed = *this->input->compressed;
+        x = compressed.acc_x.codes[index] * compressed.acc_x.scale + compressed.acc_x.offset;
+        y = compressed.acc_y.codes[index] * compressed.acc_y.scale + compressed.acc_y.offset;
+        z = compressed.acc_z.codes[index] * compressed.acc_z.scale + compressed.acc_z.offset;
+        hr = compressed.hr.codes[index] * compressed.hr.scale + compressed.hr.offset;
+        return;
+    }
+    x = this->input->acc_x->values[index];
+    y = this->input->acc_y->values[index];
+    z = this->input->acc_z->values[index];
+    hr = this->input->hr->values[index];
+}
+
+double RacingCalculationScheduler::get_estimated_correlation(const correlation_sums &sums, size_t subset_count) const {
+    const auto entries_count = static_cast<double>(this->input->hr_entries_count);
+    const double scale = entries_count / static_cast<double>(subset_count);
+    return get_abs_correlation_coefficient(entries_count, sums.acc_sum * scale, sums.acc_sum_pow_2 * scale,
+                                           sums.hr_acc_sum * scale);
+}
+
+double RacingCalculationScheduler::race_genome(const genome &current_genome, double &error) const {
+    const auto& kernels = SimdDispatch::get_kernels();
+    const size_t group_size = this->sample_x.size() / RACING_GROUPS_COUNT;
+    correlation_sums total;
+    double group_sum = 0, group_sum_pow_2 = 0;
+    for(size_t group = 0; group < RACING_GROUPS_COUNT; ++group){
+        const size_t begin = group * group_size;
+        const auto sums = kernels.correlation_sums(this->sample_x.data() + begin, this->sample_y.data() + begin,
+                                                   this->sample_z.data() + begin, this->sample_hr.data() + begin,
+                                                   current_genome.constants.data(), current_genome.powers.data(),
+                                                   group_size);
+        const correlation_sums group_sums {sums.acc_sum, sums.acc_sum_pow_2, sums.hr_acc_sum};
+        total.acc_sum += group_sums.acc_sum;
+        total.acc_sum_pow_2 += group_sums.acc_sum_pow_2;
+        total.hr_acc_sum += group_sums.hr_acc_sum;
+
+        const double group_corr = get_estimated_correlation(group_sums, group_size);
+        group_sum += group_corr;
+        group_sum_pow_2 += group_corr * group_corr;
+    }
+    //standard error of the mean of the groups estimates the error of the correlation of the whole subsample
+    const auto groups = static_cast<double>(RACING_GROUPS_COUNT);
+    const double variance = std::max(0.0, (group_sum_pow_2 - group_sum * group_sum / groups) / (groups - 1));
+    error = std::sqrt(variance / groups);
+    return get_estimated_correlation(total, this->sample_x.size());
+}
+
+double RacingCalculationScheduler::transform_and_correlation(const std::vector<genome> &population,
+                                                             size_t &best_index) {
+    if(this->sample_x.empty()){
+        this->contenders_count = population.size();
+        return CalculationScheduler::transform_and_correlation(population, best_index);
+    }
+    const size_t population_size = population.size();
+
+    //coarse race on the subsample
+    this->coarse_result.resize(population_size);
+    this->coarse_error.resize(population_size);
+    for(size_t gen_index = 0; gen_index < population_size; ++gen_index){
+        this->coarse_result[gen_index] = race_genome(population[gen_index], this->coarse_error[gen_index]);
+    }
+    this->coarse_order.resize(population_size);
+    std::iota(this->coarse_order.begin(), this->coarse_order.end(), 0);
+    std::stable_sort(this->coarse_order.begin(), this->coarse_order.end(), [this](size_t a, size_t b){
+        return this->coarse_result[a] > this->coarse_result[b];
+    });
+
+    //contenders are the top fraction and every genome that could still be as good as the coarse leader
+    const auto top_count = static_cast<size_t>(std::ceil(this->input_params.racing_fraction
+                                                             * static_cast<double>(population_size)));
+    const size_t leader = this->coarse_order[0];
+    const double leader_lower_bound = this->coarse_result[leader] - RACING_CONFIDENCE_Z * this->coarse_error[leader];
+    const auto entries_count = static_cast<double>(this->input->hr_entries_count);
+    this->contenders_count = 0;
+    double best_corr = 0;
+    for(size_t rank = 0; rank < population_size; ++rank){
+        const size_t gen_index = this->coarse_order[rank];
+        const double upper_bound = this->coarse_result[gen_index] + RACING_CONFIDENCE_Z * this->coarse_error[gen_index];
+        //the first genome is the elite of the last population and keeps its exact correlation
+        const bool contender = rank < top_count || gen_index == 0 || upper_bound >= leader_lower_bound;
+        if(!contender){
+            this->corr_result[gen_index] = this->coarse_result[gen_index];
+            continue;
+        }
+        ++this->contenders_count;
+        const auto sums = calculate_correlation_sums(population[gen_index], 0, this->input->hr_entries_count);
+        this->corr_result[gen_index] = get_abs_correlation_coefficient(entries_count, sums.acc_sum,
+                                                                       sums.acc_sum_pow_2, sums.hr_acc_sum);
+        //only the exactly evaluated genomes can be the best one
+        if(this->corr_result[gen_index] > best_corr){
+            best_corr = this->corr_result[gen_index];
+            best_index = gen_index;
+        }
+    }
+    return best_corr;
+}
+
+uint64_t RacingCalculationScheduler::get_sample_visits(size_t population_size) const {
+    return static_cast<uint64_t>(population_size) * this->sample_x.size()
+           + static_cast<uint64_t>(this->contenders_count) * this->input->hr_entries_count;
+}
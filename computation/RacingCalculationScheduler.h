@@ -0,0 +1,76 @@
+#ifndef OCL_TEST_RACINGCALCULATIONSCHEDULER_H
+#define OCL_TEST_RACINGCALCULATIONSCHEDULER_H
+
+
+#include "CalculationScheduler.h"
+
+/// count of interleaved groups of the subsample, the spread of their correlations estimates the error
+const size_t RACING_GROUPS_COUNT = 8;
+
+/// count of standard errors between the bounds of the confidence interval and the coarse correlation
+const double RACING_CONFIDENCE_Z = 1.96;
+
+/// Scheduler racing the genomes on a subsample first. All genomes are scored on a fixed stratified subsample
+/// and only the top fraction of them and the ones whose confidence interval overlaps the interval of the best
+/// coarse genome are evaluated on the whole data. The rest keeps the coarse correlation, so the selection
+/// of the parents still works with all genomes.
+class RacingCalculationScheduler : public CalculationScheduler {
+
+public:
+    RacingCalculationScheduler(const std::shared_ptr<input_data>& input, const input_parameters& input_params);
+
+protected:
+
+    void init_calculation() override;
+
+    double transform_and_correlation(const std::vector<genome>& population, size_t &best_index) override;
+
+    [[nodiscard]] uint64_t get_sample_visits(size_t population_size) const override;
+
+private:
+    /// normalized columns of the subsample gathered into contiguous vectors, one group after another
+    data_vector sample_x;
+    data_vector sample_y;
+    data_vector sample_z;
+    data_vector sample_hr;
+
+    /// count of genomes evaluated on the whole data by the last evaluation
+    size_t contenders_count = 0;
+
+    /// coarse correlation of every genome of the last population and its standard error
+    std::vector<double> coarse_result;
+    std::vector<double> coarse_error;
+    /// indices of the population ordered by the coarse correlation
+    std::vector<size_t> coarse_order;
+
+private:
+
+    /// Picks one random entry from every of the equally sized strata of the data and gathers them, the strata
+    /// are dealt into the groups in turns, so every group covers the whole data. Data with less entries than
+    /// the groups are not raced at all
+    void build_subsample();
+
+    /// Reads the normalized values of the entry from the normalized or the compressed columns
+    /// \param index index of the entry
+    /// \param x output normalized x
+    /// \param y output normalized y
+    /// \param z output normalized z
+    /// \param hr output normalized hr
+    void read_entry(size_t index, double& x, double& y, double& z, double& hr) const;
+
+    /// Scales the sums of the subset up to the whole data and calculates the correlation from them, the formula
+    /// doesn't scale linearly with the entries count, so the sums of the subset can't be used directly
+    /// \param sums sums of the subset
+    /// \param subset_count count of entries of the subset
+    /// \return estimated correlation of the whole data
+    [[nodiscard]] double get_estimated_correlation(const correlation_sums& sums, size_t subset_count) const;
+
+    /// Scores the genome on the subsample
+    /// \param current_genome scored genome
+    /// \param error output standard error of the score
+    /// \return coarse correlation
+    double race_genome(const genome& current_genome, double& error) const;
+};
+
+
+#endif //OCL_TEST_RACINGCALCULATIONSCHEDULER_H
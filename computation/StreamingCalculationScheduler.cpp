@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <numeric>
+#include <future>
+#include "StreamingCalculationScheduler.h"
+
+
+StreamingCalculationScheduler::StreamingCalculationScheduler(const std::vector<std::unique_ptr<OpenCLComponent>>& cl_devices,
+                                                             const std::shared_ptr<input_data>& input,
+                                                             const input_parameters& input_params)
+                                                             : ParallelCalculationScheduler(cl_devices, input, input_params){
+    this->slice_streams.resize(this->device_slices.size());
+}
+
+bool StreamingCalculationScheduler::is_streaming_needed(const std::vector<std::unique_ptr<OpenCLComponent>> &cl_devices,
+                                                        size_t entries_count) {
+    //data are split evenly between the devices
+    const size_t slice_entries = entries_count / std::max<size_t>(1, cl_devices.size());
+    return std::any_of(cl_devices.begin(), cl_devices.end(), [&](const auto& cl_device){
+        return cl_device->get_max_resident_entries() < slice_entries;
+    });
+}
+
+void StreamingCalculationScheduler::init_calculation() {
+    CalculationScheduler::init_calculation();
+
+    //slices are not rebalanced, so only the offsets are assigned and the results are held per chunk
+    const auto slice_sizes = get_even_slice_sizes();
+    size_t offset = 0;
+    for(size_t i = 0; i < this->device_slices.size(); ++i){
+        auto& slice = this->device_slices[i];
+        auto& stream = this->slice_streams[i];
+        const size_t work_group_size = slice.device.work_group_size;
+        slice.offset = offset;
+        slice.entries_count = slice_sizes[i];
+        slice.work_groups_count = slice.entries_count / work_group_size;
+        offset += slice.entries_count;
+
+        //both stream slots have to fit into the device at once
+        size_t chunk_entries = this->input_params.stream_chunk_size > 0 ? this->input_params.stream_chunk_size
+                                                                        : slice.device.get_max_resident_entries() / 2;
+        chunk_entries = std::min(chunk_entries, slice.entries_count);
+        chunk_entries = std::max(work_group_size, chunk_entries - chunk_entries % work_group_size);
+        stream.chunk_entries_count = chunk_entries;
+
+        const size_t chunk_work_groups = chunk_entries / work_group_size;
+        for(auto& slot_results: stream.chunk_results){
+            slot_results = {this->input_params.population_size,
+                            {data_vector(chunk_work_groups),
+                             data_vector(chunk_work_groups),
+                             data_vector(chunk_work_groups)
+                            }};
+        }
+        stream.genome_sums.resize(this->input_params.population_size);
+
+        slice.device.release_static_buffers();
+        slice.device.init_stream_buffers(chunk_entries);
+        std::cout << "Device " << slice.device.get_device_name() << " streams entries " << slice.offset
+                  << " - " << slice.offset + slice.entries_count << " in chunks of " << chunk_entries
+                  << " entries" << std::endl;
+    }
+}
+
+void StreamingCalculationScheduler::accumulate_chunk(slice_stream &stream, size_t slot, size_t work_groups_count) {
+    for(size_t gen_index = 0; gen_index < stream.genome_sums.size(); ++gen_index){
+        const auto& [out_acc, out_acc2, out_acc_hr] = stream.chunk_results[slot][gen_index];
+        auto& sums = stream.genome_sums[gen_index];
+        for(size_t i = 0; i < work_groups_count; ++i){
+            sums.acc_sum += out_acc[i];
+            sums.acc_sum_pow_2 += out_acc2[i];
+            sums.hr_acc_sum += out_acc_hr[i];
+        }
+    }
+}
+
+void StreamingCalculationScheduler::stream_slice(device_slice &slice, slice_stream &stream,
+                                                 const std::shared_ptr<input_data> &input,
+                                                 const std::vector<genome> &population,
+                                                 const std::vector<size_t> &dispatch_order) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    const size_t chunk_size = stream.chunk_entries_count;
+    const size_t chunks_count = (slice.entries_count + chunk_size - 1) / chunk_size;
+    auto get_chunk_entries = [&](size_t chunk){
+        return std::min(chunk_size, slice.entries_count - chunk * chunk_size);
+    };
+
+    std::fill(stream.genome_sums.begin(), stream.genome_sums.end(), correlation_sums{});
+    std::vector<cl::Event> kernel_events(population.size());
+    //per slot events of the last upload and of the marker after the last evaluation
+    std::array<cl::Event, 2> upload_events;
+    std::array<cl::Event, 2> chunk_markers;
+    std::array<size_t, 2> chunk_work_groups {};
+
+    slice.device.upload_chunk(input, slice.offset, get_chunk_entries(0), 0, {}, upload_events[0]);
+    for(size_t chunk = 0; chunk < chunks_count; ++chunk){
+        const size_t slot = chunk % 2;
+        const size_t next_slot = 1 - slot;
+
+        //the other slot can be overwritten once the evaluation of the previous chunk is done
+        if(chunk + 1 < chunks_count){
+            std::vector<cl::Event> slot_released;
+            if(chunk > 0){
+                slot_released.push_back(chunk_markers[next_slot]);
+            }
+            slice.device.upload_chunk(input, slice.offset + (chunk + 1) * chunk_size, get_chunk_entries(chunk + 1),
+                                      next_slot, slot_released, upload_events[next_slot]);
+        }
+
+        const size_t entries_count = get_chunk_entries(chunk);
+        chunk_work_groups[slot] = entries_count / slice.device.work_group_size;
+        slice.device.bind_stream_slot(slot);
+        //the queue is in-order, so only the first kernel has to wait for the upload
+        const std::vector<cl::Event> chunk_uploaded = {upload_events[slot]};
+        bool first_kernel = true;
+        for(const auto index: dispatch_order){
+            slice.device.calculate_correlation(population[index], stream.chunk_results[slot][index], entries_count,
+                                               chunk_work_groups[slot], kernel_events[index],
+                                               first_kernel ? &chunk_uploaded : nullptr);
+            first_kernel = false;
+        }
+        slice.device.enqueue_marker(chunk_markers[slot]);
+
+        //while the device evaluates this chunk the host accumulates the previous one
+        if(chunk > 0){
+            chunk_markers[next_slot].wait();
+            accumulate_chunk(stream, next_slot, chunk_work_groups[next_slot]);
+        }
+    }
+    const size_t last_slot = (chunks_count - 1) % 2;
+    chunk_markers[last_slot].wait();
+    accumulate_chunk(stream, last_slot, chunk_work_groups[last_slot]);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    slice.last_duration = std::chrono::duration<double>(end_time - start_time).count();
+}
+
+double StreamingCalculationScheduler::transform_and_correlation(const std::vector<genome> &population,
+                                                                size_t &best_index) {
+    const size_t entries_count = this->input->hr_entries_count;
+    double best_corr = 0;
+
+    OpenCLProfiler* profiler = this->device_slices[0].device.get_profiler();
+    if(profiler != nullptr){
+        profiler->begin_generation();
+    }
+
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    try{
+#endif
+        //genomes sharing the power triple are dispatched together so the same kernel variant is reused
+        std::vector<size_t> dispatch_order(population.size());
+        std::iota(dispatch_order.begin(), dispatch_order.end(), 0);
+        if(this->device_slices[0].device.specialized_kernels){
+            std::stable_sort(dispatch_order.begin(), dispatch_order.end(), [&](size_t a, size_t b){
+                return OpenCLComponent::get_power_key(population[a]) < OpenCLComponent::get_power_key(population[b]);
+            });
+        }
+
+        if(this->device_slices.size() == 1){
+            stream_slice(this->device_slices[0], this->slice_streams[0], this->input, population, dispatch_order);
+        }else{
+            std::vector<std::future<void>> device_jobs;
+            for(size_t i = 0; i < this->device_slices.size(); ++i){
+                device_jobs.push_back(std::async(std::launch::async, [&, i](){
+                    stream_slice(this->device_slices[i], this->slice_streams[i], this->input,
+                                 population, dispatch_order);
+                }));
+            }
+            for(auto& device_job: device_jobs){
+                device_job.get();
+            }
+        }
+
+        if(profiler != nullptr){
+            profiler->collect();
+            profiler->print_due_summaries();
+        }
+
+        //combine the accumulated sums of all slices and calculate correlation
+        for(size_t gen_index = 0; gen_index < population.size(); ++gen_index){
+            double acc_sum = 0, acc_sum_pow_2 = 0, hr_acc_sum = 0;
+            for(const auto& stream: this->slice_streams){
+                const auto& sums = stream.genome_sums[gen_index];
+                acc_sum += sums.acc_sum;
+                acc_sum_pow_2 += sums.acc_sum_pow_2;
+                hr_acc_sum += sums.hr_acc_sum;
+            }
+
+            double corr_abs = this->get_abs_correlation_coefficient(static_cast<double>(entries_count),
+                                                                    acc_sum, acc_sum_pow_2, hr_acc_sum);
+            if(corr_abs > best_corr){
+                best_corr = corr_abs;
+                best_index = gen_index;
+            }
+            this->corr_result[gen_index] = corr_abs;
+        }
+
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    } catch (cl::Error err) {
+        std::cerr << "Error occurred during gpu computation: " << err.what() << "(" << err.err() << " - "
+                  << OpenCLComponent::Get_OpenCL_Error_Desc(err.err()) << ")" << std::endl;
+        exit(1);
+    }
+#endif
+
+    return best_corr;
+}
@@ -0,0 +1,63 @@
+#ifndef OCL_TEST_STREAMINGCALCULATIONSCHEDULER_H
+#define OCL_TEST_STREAMINGCALCULATIONSCHEDULER_H
+
+
+#include "ParallelCalculationScheduler.h"
+
+/// Streaming state of one device slice
+struct slice_stream{
+    /// maximal count of data entries in one chunk, divisible by the work group size
+    size_t chunk_entries_count = 0;
+
+    /// partial sums of every genome for both stream slots [slot][genome]
+    std::array<std::vector<partial_sums>, 2> chunk_results;
+
+    /// sums of every genome accumulated over the already evaluated chunks
+    std::vector<correlation_sums> genome_sums;
+};
+
+/// Scheduler for inputs that don't fit into the device memory. Every device slice is split into chunks
+/// which are uploaded into two alternating buffer sets on a second queue, so the upload of the next chunk
+/// overlaps the evaluation of the current one. Sums of every genome are accumulated across the chunks.
+class StreamingCalculationScheduler : public ParallelCalculationScheduler {
+
+public:
+    StreamingCalculationScheduler(const std::vector<std::unique_ptr<OpenCLComponent>>& cl_devices,
+                                  const std::shared_ptr<input_data>& input, const input_parameters& input_params);
+
+    /// Checks whether the data slices of all devices can stay resident in their memory
+    /// \param cl_devices initialized device components
+    /// \param entries_count count of all data entries
+    /// \return true if at least one device can't hold its slice and the data have to be streamed
+    static bool is_streaming_needed(const std::vector<std::unique_ptr<OpenCLComponent>>& cl_devices,
+                                    size_t entries_count);
+
+protected:
+
+    void init_calculation() override;
+
+    double transform_and_correlation(const std::vector<genome>& population, size_t &best_index) override;
+
+private:
+    /// streaming state of every device slice
+    std::vector<slice_stream> slice_streams;
+
+private:
+    /// Streams all chunks of the slice through its device and accumulates the sums of every genome
+    /// \param slice device slice that should be evaluated
+    /// \param stream streaming state of the slice
+    /// \param input input data processed from the input files
+    /// \param population genomes that should be evaluated
+    /// \param dispatch_order order in which the genomes are enqueued
+    static void stream_slice(device_slice& slice, slice_stream& stream, const std::shared_ptr<input_data>& input,
+                             const std::vector<genome>& population, const std::vector<size_t>& dispatch_order);
+
+    /// Adds the partial sums of the evaluated chunk to the sums of every genome
+    /// \param stream streaming state of the slice
+    /// \param slot stream slot of the evaluated chunk
+    /// \param work_groups_count count of work groups of the evaluated chunk
+    static void accumulate_chunk(slice_stream& stream, size_t slot, size_t work_groups_count);
+};
+
+
+#endif //OCL_TEST_STREAMINGCALCULATIONSCHEDULER_H
@@ -8,6 +8,12 @@
 #include <utility>
 #include <vector>
 #include <iostream>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <filesystem>
+#include <numeric>
+#include <random>
 
 #define CL_HPP_ENABLE_EXCEPTIONS
 #include <CL/opencl.hpp>
@@ -18,13 +24,26 @@
 #endif
 
 const char* full_correlation_kernel_name = "FULL_CORRELATION_KERNEL";
+const char* full_correlation_build_options = "-cl-std=CL2.0 -cl-denorms-are-zero";
 const char* full_correlation_kernel_source = R"(
 #pragma OPENCL EXTENSION cl_khr_fp64 : enable
 
-__kernel void FULL_CORRELATION_KERNEL(__constant double *acc_x,
-                                 __constant double *acc_y,
-                                 __constant double *acc_z,
-                                 __constant double *hr_values,
+#ifdef SPECIALIZED_POWERS
+// powers P0, P1 and P2 are passed as compile time defines and expanded into multiplication chains
+#define POW0(v) (1.0)
+#define POW1(v) (v)
+#define POW2(v) ((v) * (v))
+#define POW3(v) (POW2(v) * (v))
+#define POW4(v) (POW2(v) * POW2(v))
+#define POW5(v) (POW4(v) * (v))
+#define POW_EXPAND(n, v) POW##n(v)
+#define POW_CHAIN(n, v) POW_EXPAND(n, v)
+#endif
+
+__kernel void FULL_CORRELATION_KERNEL(__global const double *acc_x,
+                                 __global const double *acc_y,
+                                 __global const double *acc_z,
+                                 __global const double *hr_values,
                                  __global double* c,
                                  __global unsigned char* p,
                                  __local double *local_sum_acc,
@@ -44,8 +63,13 @@ __kernel void FULL_CORRELATION_KERNEL(__constant double *acc_x,
 	double y = acc_y[global_id];
 	double z = acc_z[global_id];
 
+#ifdef SPECIALIZED_POWERS
+	double acc = c[0] * POW_CHAIN(P0, x) + c[1] * POW_CHAIN(P1, y)
+                    + c[2] * POW_CHAIN(P2, z) + c[3];
+#else
 	double acc = c[0] * pow(x, p[0]) + c[1] * pow(y, p[1])
                     + c[2] * pow(z, p[2]) + c[3];
+#endif
 
 	double hr = hr_values[global_id];
 	local_sum_acc[local_id] = acc;
@@ -71,23 +95,43 @@ __kernel void FULL_CORRELATION_KERNEL(__constant double *acc_x,
 }
 )";
 
+void OpenCLComponent::init_opencl_devices(std::vector<std::unique_ptr<OpenCLComponent>> &cl_devices,
+                                          const input_parameters& params) {
+    std::vector<cl::Device> selected_devices;
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    try {
+#endif
+        selected_devices = select_gpus(params.desired_gpu_name, params.sub_devices);
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    } catch (cl::Error &err) {
+        std::cerr << "Error occurred during device selection: " << err.what() << "(" << err.err() << " - "
+                  << Get_OpenCL_Error_Desc(err.err()) << ")" << std::endl;
+        exit(1);
+    }
+#endif
+
+    for(const auto& selected_device: selected_devices){
+        std::unique_ptr<OpenCLComponent> cl_device = nullptr;
+        init_opencl_device(cl_device, selected_device, params);
+        if(cl_device == nullptr){
+            cl_devices.clear();
+            return;
+        }
+        cl_devices.push_back(std::move(cl_device));
+    }
+}
+
 void OpenCLComponent::init_opencl_device(std::unique_ptr<OpenCLComponent> &cl_device,
-                                         const std::string& desired_gpu_device) {
+                                         const cl::Device& selected_device, const input_parameters& params) {
 #if defined(CL_HPP_ENABLE_EXCEPTIONS)
     cl::Program program;
     try {
 #endif
 
-        auto selected_device = select_gpu(desired_gpu_device);
-
-        //select all needed source codes
-        std::vector<std::string> source_codes{full_correlation_kernel_source};
-        const cl::Program::Sources& sources(source_codes);
-        // get program interface for sources and device context
+        // get program interface for sources and device context (possibly from the binary cache)
         cl::Context device_context = cl::Context(selected_device);
-        program = cl::Program(device_context, sources);
-
-        program.build(selected_device, "-cl-std=CL2.0 -cl-denorms-are-zero");
+        program = build_program(device_context, selected_device, full_correlation_kernel_source,
+                                full_correlation_build_options, params.cl_cache_dir);
 
         cl::Kernel full_correlation_kernel = cl::Kernel(program, full_correlation_kernel_name);
         auto build_err = dump_build_log(program);
@@ -105,9 +149,22 @@ void OpenCLComponent::init_opencl_device(std::unique_ptr<OpenCLComponent> &cl_de
         std::cout << "Workgroup size: " << work_group_size << std::endl;
         std::cout << "Max workgroup size: " << max_work_group_size << std::endl;
 
+        if(params.zero_copy && !selected_device.getInfo<CL_DEVICE_HOST_UNIFIED_MEMORY>()){
+            std::cout << "Device doesn't share memory with the host, zero copy buffers will be probably copied"
+                      << std::endl;
+        }
+
+        //requested work group size can't exceed the device limit
+        const size_t used_work_group_size = params.work_group_size > 0
+                                                ? std::min(params.work_group_size, max_work_group_size)
+                                                : max_work_group_size;
+        if(used_work_group_size != max_work_group_size){
+            std::cout << "Used workgroup size: " << used_work_group_size << std::endl;
+        }
+
     	cl_device = std::make_unique<OpenCLComponent>(selected_device, device_context,
                                                       full_correlation_kernel,
-                                                      max_work_group_size);
+                                                      used_work_group_size, params);
 
 #if defined(CL_HPP_ENABLE_EXCEPTIONS)
     } catch (cl::Error &err) {
@@ -119,13 +176,51 @@ void OpenCLComponent::init_opencl_device(std::unique_ptr<OpenCLComponent> &cl_de
 #endif
 }
 
+std::vector<std::string> OpenCLComponent::get_selected_device_names(const input_parameters &params) {
+    std::vector<std::string> device_names;
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    try {
+#endif
+        for(const auto& device: select_gpus(params.desired_gpu_name, params.sub_devices)){
+            device_names.push_back(device.getInfo<CL_DEVICE_NAME>());
+        }
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    } catch (cl::Error &err) {
+        device_names.clear();
+    }
+#endif
+    return device_names;
+}
+
+std::unique_ptr<OpenCLComponent> OpenCLComponent::clone_with_work_group_size(size_t new_work_group_size,
+                                                                             const input_parameters &params) const {
+    //the kernel object is shared, so the clones must not be used at the same time as this component
+    return std::make_unique<OpenCLComponent>(this->selected_device, this->device_context, this->full_corr_kernel,
+                                             new_work_group_size, params);
+}
+
+size_t OpenCLComponent::get_common_work_group_size(const std::vector<std::unique_ptr<OpenCLComponent>> &cl_devices) {
+    size_t common_size = 1;
+    for(const auto& cl_device: cl_devices){
+        common_size = std::lcm(common_size, cl_device->work_group_size);
+    }
+    return common_size;
+}
+
 OpenCLComponent::OpenCLComponent(cl::Device selected_device, cl::Context device_context,
-                                 cl::Kernel full_corr_kernel, size_t work_group_size):
+                                 cl::Kernel full_corr_kernel, size_t work_group_size,
+                                 const input_parameters& params):
 
                                  selected_device(std::move(selected_device)),
                                  device_context(std::move(device_context)),
                                  full_corr_kernel(std::move(full_corr_kernel)),
-                                 work_group_size(work_group_size){
+                                 work_group_size(work_group_size),
+                                 specialized_kernels(params.specialized_kernels),
+                                 program_cache_dir(params.cl_cache_dir),
+                                 zero_copy(params.zero_copy){
+    //single in-order queue so that all commands for this device are finished with finish()
+    this->cmd_queue = cl::CommandQueue(this->device_context, this->selected_device,
+                                       params.cl_profile ? CL_QUEUE_PROFILING_ENABLE : 0);
 
 }
 
@@ -228,6 +323,69 @@ cl_int OpenCLComponent::dump_build_log(cl::Program& program) {
     return build_err;
 }
 
+std::vector<cl::Device> OpenCLComponent::select_gpus(const std::string &desired_gpu_device, size_t sub_devices) {
+    std::vector<cl::Device> selected_devices;
+    if(desired_gpu_device == ALL_GPU_NAME){
+        std::vector<cl::Platform> platforms;
+        cl::Platform::get(&platforms);
+        for (auto& platform : platforms) {
+            std::vector<cl::Device> devices;
+            platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+            for (auto& device : devices) {
+                if(device.getInfo<CL_DEVICE_AVAILABLE>()){
+                    std::cout << "Selected GPU Device " << device.getInfo<CL_DEVICE_NAME>() << " on platform "
+                              << platform.getInfo<CL_PLATFORM_NAME>() << std::endl;
+                    selected_devices.push_back(device);
+                }
+            }
+        }
+        if(selected_devices.empty()){
+            selected_devices.push_back(select_gpu(DEFAULT_GPU_NAME));
+        }
+    }else{
+        selected_devices.push_back(select_gpu(desired_gpu_device));
+    }
+
+    if(sub_devices <= 1){
+        return selected_devices;
+    }
+
+    //split every device into equally sized sub devices
+    std::vector<cl::Device> partitioned_devices;
+    for (auto& device : selected_devices) {
+        const auto compute_units = device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+        const auto units_per_device = static_cast<cl_device_partition_property>(
+                                            std::max<size_t>(1, compute_units / sub_devices));
+        const cl_device_partition_property properties[] = {CL_DEVICE_PARTITION_EQUALLY, units_per_device, 0};
+        std::vector<cl::Device> device_parts;
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+        try {
+#endif
+            device.createSubDevices(properties, &device_parts);
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+        } catch (cl::Error &err) {
+            device_parts.clear();
+        }
+#endif
+        if(device_parts.empty()){
+            std::cout << "Device " << device.getInfo<CL_DEVICE_NAME>()
+                      << " can't be partitioned, using it as a whole" << std::endl;
+            partitioned_devices.push_back(device);
+            continue;
+        }
+        std::cout << "Device " << device.getInfo<CL_DEVICE_NAME>() << " partitioned into "
+                  << device_parts.size() << " sub devices" << std::endl;
+        if(device_parts.size() != sub_devices){
+            //equal partitioning creates as many sub devices as the compute units allow, the data slices are
+            //created for all of them
+            std::cout << "Requested " << sub_devices << " sub devices, using all " << device_parts.size()
+                      << " created ones" << std::endl;
+        }
+        partitioned_devices.insert(partitioned_devices.end(), device_parts.begin(), device_parts.end());
+    }
+    return partitioned_devices;
+}
+
 cl::Device OpenCLComponent::select_gpu(const std::string &desired_gpu_device) {
     std::vector<cl::Platform> platforms;
     cl::Platform::get(&platforms);
@@ -266,24 +424,25 @@ cl::Device OpenCLComponent::select_gpu(const std::string &desired_gpu_device) {
 }
 
 
-void OpenCLComponent::calculate_correlation(const genome &curr_gen, std::array<std::vector<double>, 3>& out_sums,
+void OpenCLComponent::calculate_correlation(const genome &curr_gen, partial_sums& out_sums,
                                             const cl::size_type entries_count, const size_t work_groups_count,
-                                            cl::Event &corr_kernel_event) {
-
-    cl::CommandQueue cmd_queue(this->device_context, this->selected_device);
+                                            cl::Event &corr_kernel_event,
+                                            const std::vector<cl::Event>* wait_events) {
 
-    // first init function specific buffers
-    cl::Buffer out_sum_acc_buff = cl::Buffer(this->device_context,
-                                             CL_MEM_WRITE_ONLY | CL_MEM_HOST_READ_ONLY,
-                                        work_groups_count * sizeof(double), nullptr);
+    // first init function specific buffers, in zero copy mode the kernel writes right into the output vectors
+    const cl_mem_flags out_flags = this->zero_copy ? CL_MEM_WRITE_ONLY | CL_MEM_USE_HOST_PTR
+                                                   : CL_MEM_WRITE_ONLY | CL_MEM_HOST_READ_ONLY;
+    cl::Buffer out_sum_acc_buff = cl::Buffer(this->device_context, out_flags,
+                                        work_groups_count * sizeof(double),
+                                        this->zero_copy ? out_sums[0].data() : nullptr);
 
-    cl::Buffer out_sum_acc2_buff = cl::Buffer(this->device_context,
-                                              CL_MEM_WRITE_ONLY | CL_MEM_HOST_READ_ONLY,
-                                         work_groups_count * sizeof(double), nullptr);
+    cl::Buffer out_sum_acc2_buff = cl::Buffer(this->device_context, out_flags,
+                                         work_groups_count * sizeof(double),
+                                         this->zero_copy ? out_sums[1].data() : nullptr);
 
-    cl::Buffer out_sum_acc_hr_buff = cl::Buffer(this->device_context,
-                                                CL_MEM_WRITE_ONLY | CL_MEM_HOST_READ_ONLY,
-                                           work_groups_count * sizeof(double), nullptr);
+    cl::Buffer out_sum_acc_hr_buff = cl::Buffer(this->device_context, out_flags,
+                                           work_groups_count * sizeof(double),
+                                           this->zero_copy ? out_sums[2].data() : nullptr);
 
     auto constants = cl::Buffer(this->device_context,
                                 CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR | CL_MEM_HOST_NO_ACCESS,
@@ -295,60 +454,321 @@ void OpenCLComponent::calculate_correlation(const genome &curr_gen, std::array<s
                              GENOME_POW_SIZE * sizeof(uint8_t),
                              const_cast<unsigned char *>(curr_gen.powers.data()));
 
+    //pick the generic kernel or the variant with powers of this genome baked in
+    cl::Kernel& kernel = get_kernel(curr_gen);
+
     //assign to kernel arguments
-    this->full_corr_kernel.setArg(4, constants);
-    this->full_corr_kernel.setArg(5, powers);
+    kernel.setArg(4, constants);
+    kernel.setArg(5, powers);
 
-    this->full_corr_kernel.setArg(6, work_group_size * sizeof(double), nullptr);
-    this->full_corr_kernel.setArg(7, work_group_size * sizeof(double), nullptr);
-    this->full_corr_kernel.setArg(8, work_group_size * sizeof(double), nullptr);
+    kernel.setArg(6, work_group_size * sizeof(double), nullptr);
+    kernel.setArg(7, work_group_size * sizeof(double), nullptr);
+    kernel.setArg(8, work_group_size * sizeof(double), nullptr);
 
-    this->full_corr_kernel.setArg(9, out_sum_acc_buff);
-    this->full_corr_kernel.setArg(10, out_sum_acc2_buff);
-    this->full_corr_kernel.setArg(11, out_sum_acc_hr_buff);
+    kernel.setArg(9, out_sum_acc_buff);
+    kernel.setArg(10, out_sum_acc2_buff);
+    kernel.setArg(11, out_sum_acc_hr_buff);
     
-    // Create a command queue to communicate with the OpenCL device.
-    cmd_queue.enqueueNDRangeKernel(this->full_corr_kernel, cl::NullRange,
+    this->cmd_queue.enqueueNDRangeKernel(kernel, cl::NullRange,
                                     cl::NDRange(entries_count),
 									cl::NDRange(this->work_group_size),
-                                   nullptr, &corr_kernel_event);
+                                   wait_events, &corr_kernel_event);
+
+    std::array<cl::Event, 3> read_events;
+    const bool profiled = this->profiler != nullptr;
+    if(this->zero_copy){
+        // mapping makes the results visible in the host memory, on unified memory devices without any copy
+        const std::array<cl::Buffer*, 3> out_buffers = {&out_sum_acc_buff, &out_sum_acc2_buff, &out_sum_acc_hr_buff};
+        for(size_t i = 0; i < out_buffers.size(); ++i){
+            void* mapped = this->cmd_queue.enqueueMapBuffer(*out_buffers[i], CL_FALSE, CL_MAP_READ, 0,
+                                                            work_groups_count * sizeof(double),
+                                                            nullptr, profiled ? &read_events[i] : nullptr);
+            this->cmd_queue.enqueueUnmapMemObject(*out_buffers[i], mapped);
+        }
+        if(profiled){
+            record_profiled(corr_kernel_event, full_correlation_kernel_name, false);
+            for(const auto& read_event: read_events){
+                record_profiled(read_event, "MAP_PARTIAL_SUMS", true);
+            }
+        }
+        return;
+    }
 
     // Read the results from the OpenCL device.
-    cmd_queue.enqueueReadBuffer(out_sum_acc_buff, CL_FALSE, 0,
-                                 work_groups_count * sizeof(double), out_sums[0].data());
-    cmd_queue.enqueueReadBuffer(out_sum_acc2_buff, CL_FALSE, 0,
-                                 work_groups_count * sizeof(double), out_sums[1].data());
-    cmd_queue.enqueueReadBuffer(out_sum_acc_hr_buff, CL_FALSE, 0,
-                                 work_groups_count * sizeof(double), out_sums[2].data());
+    this->cmd_queue.enqueueReadBuffer(out_sum_acc_buff, CL_FALSE, 0,
+                                 work_groups_count * sizeof(double), out_sums[0].data(),
+                                 nullptr, profiled ? &read_events[0] : nullptr);
+    this->cmd_queue.enqueueReadBuffer(out_sum_acc2_buff, CL_FALSE, 0,
+                                 work_groups_count * sizeof(double), out_sums[1].data(),
+                                 nullptr, profiled ? &read_events[1] : nullptr);
+    this->cmd_queue.enqueueReadBuffer(out_sum_acc_hr_buff, CL_FALSE, 0,
+                                 work_groups_count * sizeof(double), out_sums[2].data(),
+                                 nullptr, profiled ? &read_events[2] : nullptr);
+
+    if(profiled){
+        record_profiled(corr_kernel_event, full_correlation_kernel_name, false);
+        for(const auto& read_event: read_events){
+            record_profiled(read_event, "READ_PARTIAL_SUMS", true);
+        }
+    }
 }
 
-void OpenCLComponent::init_static_buffers(const std::shared_ptr<input_data> &input, size_t numbers_bytes_size,
-                                          const size_t work_groups_count) {
+void OpenCLComponent::set_profiler(OpenCLProfiler *device_profiler, size_t device_index) {
+    this->profiler = device_profiler;
+    this->profiler_device_index = device_index;
+}
+
+void OpenCLComponent::record_profiled(const cl::Event &event, const char *name, bool is_transfer) {
+    if(this->profiler != nullptr){
+        this->profiler->record(event, name, is_transfer, this->profiler_device_index);
+    }
+}
+
+void OpenCLComponent::init_static_buffers(const std::shared_ptr<input_data> &input, size_t offset,
+                                          size_t numbers_bytes_size, const size_t work_groups_count) {
     if(buffers_initialized){
         return;
     }
-    this->x_acc_vector = cl::Buffer(this->device_context,
-                                  CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR | CL_MEM_HOST_NO_ACCESS,
-                                                numbers_bytes_size, input->acc_x->values.data());
+    //in zero copy mode the device works with the page aligned input vectors directly
+    const cl_mem_flags data_flags = this->zero_copy ? CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR
+                                                    : CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR | CL_MEM_HOST_NO_ACCESS;
+    this->x_acc_vector = cl::Buffer(this->device_context, data_flags,
+                                                numbers_bytes_size, input->acc_x->values.data() + offset);
 
     this->full_corr_kernel.setArg(0, this->x_acc_vector);
 
 
-    this->y_acc_vector = cl::Buffer(this->device_context,
-                                  CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR | CL_MEM_HOST_NO_ACCESS,
-                                                numbers_bytes_size, input->acc_y->values.data());
+    this->y_acc_vector = cl::Buffer(this->device_context, data_flags,
+                                                numbers_bytes_size, input->acc_y->values.data() + offset);
     this->full_corr_kernel.setArg(1, this->y_acc_vector);
 
 
-    this->z_acc_vector = cl::Buffer(this->device_context,
-                                  CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR | CL_MEM_HOST_NO_ACCESS,
-                                                numbers_bytes_size, input->acc_z->values.data());
+    this->z_acc_vector = cl::Buffer(this->device_context, data_flags,
+                                                numbers_bytes_size, input->acc_z->values.data() + offset);
     this->full_corr_kernel.setArg(2, this->z_acc_vector);
 
-    this->hr_vector = cl::Buffer(this->device_context,
-                                 CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR | CL_MEM_HOST_NO_ACCESS,
-                                 numbers_bytes_size, input->hr->values.data());
+    this->hr_vector = cl::Buffer(this->device_context, data_flags,
+                                 numbers_bytes_size, input->hr->values.data() + offset);
     this->full_corr_kernel.setArg(3, this->hr_vector);
 
+    //variants that were built before the buffers existed need them assigned too
+    for(auto& [key, variant]: this->kernel_variants){
+        set_static_buffer_args(variant);
+    }
+
+    buffers_initialized = true;
+}
+
+void OpenCLComponent::release_static_buffers() {
+    this->x_acc_vector = cl::Buffer();
+    this->y_acc_vector = cl::Buffer();
+    this->z_acc_vector = cl::Buffer();
+    this->hr_vector = cl::Buffer();
+    buffers_initialized = false;
+}
+
+void OpenCLComponent::init_stream_buffers(size_t chunk_entries_count) {
+    const bool profiled = this->profiler != nullptr;
+    this->transfer_queue = cl::CommandQueue(this->device_context, this->selected_device,
+                                            profiled ? CL_QUEUE_PROFILING_ENABLE : 0);
+    for(auto& slot_buffers: this->stream_buffers){
+        for(auto& buffer: slot_buffers){
+            buffer = cl::Buffer(this->device_context, CL_MEM_READ_ONLY | CL_MEM_HOST_WRITE_ONLY,
+                                chunk_entries_count * sizeof(double));
+        }
+    }
+}
+
+void OpenCLComponent::upload_chunk(const std::shared_ptr<input_data> &input, size_t offset, size_t entries_count,
+                                   size_t slot, const std::vector<cl::Event> &wait_events, cl::Event &upload_event) {
+    const std::array<const double*, 4> sources = {input->acc_x->values.data(), input->acc_y->values.data(),
+                                                  input->acc_z->values.data(), input->hr->values.data()};
+    const auto& slot_buffers = this->stream_buffers[slot];
+    //transfer queue is in-order, so the event of the last write completes after the whole chunk
+    std::array<cl::Event, 4> write_events;
+    for(size_t i = 0; i < sources.size(); ++i){
+        this->transfer_queue.enqueueWriteBuffer(slot_buffers[i], CL_FALSE, 0, entries_count * sizeof(double),
+                                                sources[i] + offset, wait_events.empty() ? nullptr : &wait_events,
+                                                &write_events[i]);
+        record_profiled(write_events[i], "WRITE_DATA_CHUNK", true);
+    }
+    upload_event = write_events.back();
+    //the compute queue waits for this event, so it has to be submitted
+    this->transfer_queue.flush();
+}
+
+void OpenCLComponent::bind_stream_slot(size_t slot) {
+    const auto& slot_buffers = this->stream_buffers[slot];
+    this->x_acc_vector = slot_buffers[0];
+    this->y_acc_vector = slot_buffers[1];
+    this->z_acc_vector = slot_buffers[2];
+    this->hr_vector = slot_buffers[3];
+    //kernel arguments are captured at enqueue time, so already enqueued kernels keep the previous slot
+    set_static_buffer_args(this->full_corr_kernel);
+    for(auto& [key, variant]: this->kernel_variants){
+        set_static_buffer_args(variant);
+    }
     buffers_initialized = true;
 }
+
+size_t OpenCLComponent::get_max_resident_entries() const {
+    //some memory is left for the output buffers and the runtime itself
+    const auto global_mem_size = this->selected_device.getInfo<CL_DEVICE_GLOBAL_MEM_SIZE>();
+    const auto max_alloc_size = this->selected_device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
+    const size_t by_global_mem = static_cast<size_t>(global_mem_size / 4 * 3) / (4 * sizeof(double));
+    const size_t by_alloc_size = static_cast<size_t>(max_alloc_size) / sizeof(double);
+    return std::min(by_global_mem, by_alloc_size);
+}
+
+void OpenCLComponent::finish() {
+    this->cmd_queue.finish();
+}
+
+void OpenCLComponent::enqueue_marker(cl::Event &marker_event) {
+    this->cmd_queue.enqueueMarkerWithWaitList(nullptr, &marker_event);
+    this->cmd_queue.flush();
+}
+
+std::string OpenCLComponent::get_device_name() const {
+    return this->selected_device.getInfo<CL_DEVICE_NAME>();
+}
+
+const cl::Device &OpenCLComponent::get_device() const {
+    return this->selected_device;
+}
+
+const cl::Context &OpenCLComponent::get_context() const {
+    return this->device_context;
+}
+
+cl::CommandQueue &OpenCLComponent::get_command_queue() {
+    return this->cmd_queue;
+}
+
+uint32_t OpenCLComponent::get_power_key(const genome &curr_gen) {
+    const auto& p = curr_gen.powers;
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16;
+}
+
+cl::Kernel& OpenCLComponent::get_kernel(const genome &curr_gen) {
+    if(!this->specialized_kernels){
+        return this->full_corr_kernel;
+    }
+    const auto key = get_power_key(curr_gen);
+    auto it = this->kernel_variants.find(key);
+    if(it != this->kernel_variants.end()){
+        return it->second;
+    }
+
+    const auto& p = curr_gen.powers;
+    std::stringstream options;
+    options << full_correlation_build_options << " -D SPECIALIZED_POWERS"
+            << " -D P0=" << (int)p[0] << " -D P1=" << (int)p[1] << " -D P2=" << (int)p[2];
+
+    cl::Program program = build_program(this->device_context, this->selected_device, full_correlation_kernel_source,
+                                        options.str(), this->program_cache_dir);
+
+    cl::Kernel variant(program, full_correlation_kernel_name);
+    if(this->buffers_initialized){
+        set_static_buffer_args(variant);
+    }
+    std::cout << "Built kernel variant for powers (" << (int)p[0] << ", " << (int)p[1] << ", " << (int)p[2]
+              << "), cached variants: " << this->kernel_variants.size() + 1 << std::endl;
+    return this->kernel_variants.emplace(key, std::move(variant)).first->second;
+}
+
+void OpenCLComponent::set_static_buffer_args(cl::Kernel &kernel) const {
+    kernel.setArg(0, this->x_acc_vector);
+    kernel.setArg(1, this->y_acc_vector);
+    kernel.setArg(2, this->z_acc_vector);
+    kernel.setArg(3, this->hr_vector);
+}
+
+uint64_t OpenCLComponent::get_program_cache_key(const cl::Device &device, const std::string &source,
+                                                const std::string &build_options) {
+    return hash_key_parts({device.getInfo<CL_DEVICE_NAME>(), device.getInfo<CL_DRIVER_VERSION>(),
+                           source, build_options});
+}
+
+cl::Program OpenCLComponent::build_program(const cl::Context &context, const cl::Device &device,
+                                           const std::string &source, const std::string &build_options,
+                                           const std::string &cache_dir) {
+    const bool cache_enabled = !cache_dir.empty() && cache_dir != DISABLED_CL_CACHE_DIR;
+    std::filesystem::path cache_file;
+    if(cache_enabled){
+        std::stringstream file_name;
+        file_name << std::hex << std::setw(16) << std::setfill('0')
+                  << get_program_cache_key(device, source, build_options) << ".clbin";
+        cache_file = std::filesystem::path(cache_dir) / file_name.str();
+
+        std::ifstream binary_file(cache_file, std::ios::binary);
+        if(binary_file.is_open()){
+            cl::Program::Binaries binaries {std::vector<unsigned char>(std::istreambuf_iterator<char>(binary_file),
+                                                                        std::istreambuf_iterator<char>())};
+            binary_file.close();
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+            try {
+#endif
+                std::vector<cl_int> binary_status;
+                cl::Program program(context, {device}, binaries, &binary_status);
+                if(!binary_status.empty() && binary_status[0] == CL_SUCCESS
+                        && program.build(device, build_options.c_str()) == CL_SUCCESS){
+                    std::cout << "Loaded cached program binary " << cache_file.string() << std::endl;
+                    return program;
+                }
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+            } catch (cl::Error &err) {
+                //the binary is not valid anymore, so it is rebuilt from the source below
+            }
+#endif
+            std::cout << "Cached program binary " << cache_file.string() << " was rejected, rebuilding" << std::endl;
+        }
+    }
+
+    std::vector<std::string> source_codes{source};
+    const cl::Program::Sources& sources(source_codes);
+    cl::Program program(context, sources);
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    try{
+#endif
+        program.build(device, build_options.c_str());
+#if defined(CL_HPP_ENABLE_EXCEPTIONS)
+    } catch (cl::Error &err) {
+        dump_build_log(program);
+        throw;
+    }
+#endif
+
+    if(cache_enabled){
+        const auto binaries = program.getInfo<CL_PROGRAM_BINARIES>();
+        std::error_code fs_error;
+        std::filesystem::create_directories(cache_dir, fs_error);
+        //binary is written into an unique temporary file and renamed, so concurrent runs never read half written file
+        std::stringstream temp_name;
+        temp_name << cache_file.filename().string() << ".tmp" << std::hex << std::random_device{}();
+        const auto temp_file = cache_file.parent_path() / temp_name.str();
+        bool saved = false;
+        if(!binaries.empty() && !binaries[0].empty()){
+            std::ofstream binary_file(temp_file, std::ios::binary);
+            if(binary_file.is_open()){
+                binary_file.write(reinterpret_cast<const char*>(binaries[0].data()),
+                                  static_cast<std::streamsize>(binaries[0].size()));
+                binary_file.close();
+                saved = binary_file.good();
+            }
+            if(saved){
+                std::filesystem::rename(temp_file, cache_file, fs_error);
+                saved = !fs_error;
+            }
+            if(!saved){
+                std::filesystem::remove(temp_file, fs_error);
+            }
+        }
+        if(saved){
+            std::cout << "Saved program binary to cache " << cache_file.string() << std::endl;
+        }else{
+            std::cerr << "Program binary could not be saved to " << cache_file.string() << std::endl;
+        }
+    }
+    return program;
+}
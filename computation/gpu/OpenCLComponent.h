@@ -9,16 +9,41 @@
 #include "CL/opencl.hpp"
 #include "../../preprocessing/Preprocessor.h"
 #include "../CalculationScheduler.h"
+#include "OpenCLProfiler.h"
+
+/// output buffers with partial sums of acc, acc^2 and acc*hr for every work group
+typedef std::array<data_vector, 3> partial_sums;
 
 class OpenCLComponent {
 
 public:
     OpenCLComponent(cl::Device selected_device, cl::Context device_context,
-                    cl::Kernel full_correlation_kernel, size_t work_group_size);
+                    cl::Kernel full_correlation_kernel, size_t work_group_size, const input_parameters& params);
     ~OpenCLComponent();
 
 public:
-    static void init_opencl_device(std::unique_ptr<OpenCLComponent> &cl_device, const std::string& desired_gpu_device);
+    /// Selects all wanted openCL devices and initializes the component for every one of them
+    /// \param cl_devices output vector with initialized components, empty if the init failed
+    /// \param params input parameters of the application
+    static void init_opencl_devices(std::vector<std::unique_ptr<OpenCLComponent>> &cl_devices,
+                                    const input_parameters& params);
+
+    /// Selects the devices the same way as init_opencl_devices but without initializing them
+    /// \param params input parameters of the application
+    /// \return names of the selected devices, empty if there is none
+    static std::vector<std::string> get_selected_device_names(const input_parameters& params);
+
+    /// Creates component for the same device, context and kernel with different work group size
+    /// \param new_work_group_size work group size of the new component
+    /// \param params input parameters of the application
+    /// \return new component
+    [[nodiscard]] std::unique_ptr<OpenCLComponent> clone_with_work_group_size(size_t new_work_group_size,
+                                                                             const input_parameters& params) const;
+
+    /// Finds the smallest entry count divisible by work group sizes of all passed devices
+    /// \param cl_devices initialized device components
+    /// \return common work group size
+    static size_t get_common_work_group_size(const std::vector<std::unique_ptr<OpenCLComponent>> &cl_devices);
 
     /// Function enqueuing kernel with passed genome and writing it into desire buffers
     /// \param curr_gen current function genome for accelator data transformation
@@ -26,32 +51,129 @@ public:
     /// \param entries_count count of data entries parsed from input files
     /// \param work_groups_count count of work group present for this GPU device
     /// \param corr_kernel_event event that can be used to synchronize with gpu processes
-    void calculate_correlation(const genome &curr_gen, std::array<std::vector<double>, 3>& out_sums,
+    /// \param wait_events events that have to be completed before the kernel starts, e.g. upload of streamed data
+    void calculate_correlation(const genome &curr_gen, partial_sums& out_sums,
                                const cl::size_type entries_count, const size_t work_groups_count,
-                               cl::Event &corr_kernel_event);
+                               cl::Event &corr_kernel_event, const std::vector<cl::Event>* wait_events = nullptr);
 
     /// function used to initialize buffers that dont change
     /// \param input input data processed from the input files
+    /// \param offset index of the first data entry uploaded to this device
     /// \param numbers_bytes_size count of bytes needed for data buffers
     /// \param work_groups_count count of work group present for this GPU device
-    void init_static_buffers(const std::shared_ptr<input_data> &input, size_t numbers_bytes_size,
+    void init_static_buffers(const std::shared_ptr<input_data> &input, size_t offset, size_t numbers_bytes_size,
                              const size_t work_groups_count);
 
+    /// Releases the data buffers so that they can be initialized again with different data slice
+    void release_static_buffers();
+
+    /// Allocates two sets of chunk sized data buffers and the transfer queue used for streaming the data
+    /// so that the upload of the next chunk can overlap the evaluation of the current one
+    /// \param chunk_entries_count maximal count of data entries in one chunk
+    void init_stream_buffers(size_t chunk_entries_count);
+
+    /// Enqueues non-blocking upload of the data chunk into the stream slot on the transfer queue
+    /// \param input input data processed from the input files
+    /// \param offset index of the first data entry of the chunk
+    /// \param entries_count count of data entries of the chunk
+    /// \param slot stream slot (0 or 1) the chunk is uploaded to
+    /// \param wait_events events that have to be completed before the slot can be overwritten
+    /// \param upload_event output event completing once the whole chunk is uploaded
+    void upload_chunk(const std::shared_ptr<input_data> &input, size_t offset, size_t entries_count, size_t slot,
+                      const std::vector<cl::Event>& wait_events, cl::Event& upload_event);
+
+    /// Assigns the data buffers of the stream slot to all kernels, so the following evaluations use its chunk
+    /// \param slot stream slot (0 or 1)
+    void bind_stream_slot(size_t slot);
+
+    /// Estimates how many data entries can stay resident in the device memory
+    /// \return count of entries of all four data columns fitting into the device
+    [[nodiscard]] size_t get_max_resident_entries() const;
+
+    /// Blocks until all enqueued commands of this device are done
+    void finish();
+
+    /// Enqueues marker completing once all previously enqueued commands are done and submits them to the device
+    /// \param marker_event output event of the marker
+    void enqueue_marker(cl::Event& marker_event);
+
+    /// \return name of the selected device
+    [[nodiscard]] std::string get_device_name() const;
+
+    [[nodiscard]] const cl::Device& get_device() const;
+
+    [[nodiscard]] const cl::Context& get_context() const;
+
+    cl::CommandQueue& get_command_queue();
+
+    /// Assigns profiler that receives events of all commands enqueued to this device
+    /// \param device_profiler profiler, the queue has to be created with profiling enabled
+    /// \param device_index index of this device in the profiler output
+    void set_profiler(OpenCLProfiler* device_profiler, size_t device_index);
+
+    /// \return assigned profiler or null if profiling is disabled
+    [[nodiscard]] OpenCLProfiler* get_profiler() const { return this->profiler; }
+
+    /// Passes the command event to the profiler if there is one assigned
+    /// \param event event of the enqueued command
+    /// \param name name of the command
+    /// \param is_transfer flag indicating memory transfer command
+    void record_profiled(const cl::Event& event, const char* name, bool is_transfer);
+
+    /// Builds program for the device. The program binary is loaded from the cache folder
+    /// if it was already built with the same key, otherwise it is built from the source and saved there
+    /// \param context device context
+    /// \param device device the program is built for
+    /// \param source source code of the program
+    /// \param build_options options passed to the compiler
+    /// \param cache_dir folder with cached binaries, caching is disabled if "none" is passed
+    /// \return built program
+    static cl::Program build_program(const cl::Context& context, const cl::Device& device, const std::string& source,
+                                     const std::string& build_options, const std::string& cache_dir);
+
     /// Transform openCL error number into more readable string
     /// \param error integer value of openCL error
     /// \return more readable error string
     static const char* Get_OpenCL_Error_Desc(cl_int error) noexcept;
 
+    /// Packs the powers used by the kernel (x, y and z axis) into single key
+    /// \param curr_gen genome to get the powers from
+    /// \return key identifying the kernel variant of the genome
+    static uint32_t get_power_key(const genome &curr_gen);
+
 public:
     const size_t work_group_size;
 
+    /// flag indicating that kernels with the genome powers compiled in are used instead of generic pow()
+    const bool specialized_kernels;
+
+    /// folder with cached program binaries
+    const std::string program_cache_dir;
+
+    /// flag indicating that the host memory is used by the device directly (CL_MEM_USE_HOST_PTR, map/unmap)
+    const bool zero_copy;
+
 private:
     cl::Device selected_device;
 
     cl::Context device_context;
 
+    cl::CommandQueue cmd_queue;
+
+    /// second queue used for uploads of streamed data chunks
+    cl::CommandQueue transfer_queue;
+
+    /// double buffered data buffers (x, y, z and hr) of the streamed chunks
+    std::array<std::array<cl::Buffer, 4>, 2> stream_buffers;
+
     cl::Kernel full_corr_kernel;
 
+    OpenCLProfiler* profiler = nullptr;
+    size_t profiler_device_index = 0;
+
+    /// kernels built on demand for every distinct power triple (key from get_power_key)
+    std::map<uint32_t, cl::Kernel> kernel_variants;
+
     bool buffers_initialized = false;
     cl::Buffer hr_vector;
     cl::Buffer x_acc_vector;
@@ -66,10 +188,42 @@ private:
     /// \return selected openCL GPU device
     static cl::Device select_gpu(const std::string &desired_gpu_device);
 
+    /// Function used to select all openCL devices that should be used
+    /// \param desired_gpu_device name of the GPU that should be selected, if "ALL" then all available GPUs are used
+    /// \param sub_devices count of equally sized sub devices every selected device is split into
+    /// \return selected openCL devices
+    static std::vector<cl::Device> select_gpus(const std::string &desired_gpu_device, size_t sub_devices);
+
+    /// Initializes the component for single openCL device
+    /// \param cl_device output component, null if the init failed
+    /// \param selected_device device that is initialized
+    /// \param params input parameters of the application
+    static void init_opencl_device(std::unique_ptr<OpenCLComponent> &cl_device, const cl::Device& selected_device,
+                                   const input_parameters& params);
+
     /// This function prints out build logs from building kernels of the implemented openCL program interface
     /// \param program program interface used to build kernels
     /// \return error value if something during compilation failed
     static cl_int dump_build_log(cl::Program& program);
+
+
+    /// Returns kernel that should be used for the passed genome. When specialized kernels are enabled
+    /// the variant for its power triple is built and cached on the first use
+    /// \param curr_gen genome that is going to be evaluated
+    /// \return kernel to be enqueued
+    cl::Kernel& get_kernel(const genome &curr_gen);
+
+    /// Creates key of the program binary from device name, driver version, kernel source and build options
+    /// \param device device the program is built for
+    /// \param source source code of the program
+    /// \param build_options options passed to the compiler
+    /// \return hash identifying the program binary
+    static uint64_t get_program_cache_key(const cl::Device& device, const std::string& source,
+                                          const std::string& build_options);
+
+    /// Assigns the static data buffers to the first kernel arguments
+    /// \param kernel kernel that should receive the buffers
+    void set_static_buffer_args(cl::Kernel& kernel) const;
 };
 
 
@@ -0,0 +1,485 @@
+#include "OpenCLGeneticComponent.h"
+
+#include <random>
+#include <iostream>
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+#include <CL/opencl.hpp>
+
+
+const char* genetic_build_options = "-cl-std=CL2.0 -cl-denorms-are-zero";
+const char* genetic_kernels_source = R"(
+#pragma OPENCL EXTENSION cl_khr_fp64 : enable
+
+#define GENOME_CONSTANTS_SIZE 4
+#define GENOME_POW_SIZE 4
+#define MUTABLE_GENES_COUNT 7
+
+#define TOURNAMENT_SELECTION 0
+#define ROULETTE_SELECTION 1
+#define TOURNAMENT_SIZE 4
+
+// xorshift64* generator, every offspring slot has its own state
+inline ulong next_random(ulong *state) {
+    ulong x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DUL;
+}
+
+inline double random_double(ulong *state) {
+    return (double)(next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+inline uint random_uint(ulong *state, uint bound) {
+    return (uint)(next_random(state) % bound);
+}
+
+__kernel void POPULATION_SUMS_KERNEL(__global const double *acc_x,
+                                     __global const double *acc_y,
+                                     __global const double *acc_z,
+                                     __global const double *hr_values,
+                                     __global const double *constants,
+                                     __global const uchar *powers,
+                                     const uint entries_count,
+                                     __local double *local_sum_acc,
+                                     __local double *local_sum_acc2,
+                                     __local double *local_sum_acc_hr,
+                                     __global double *partial_acc,
+                                     __global double *partial_acc2,
+                                     __global double *partial_acc_hr) {
+    size_t local_id = get_local_id(0);
+    size_t group_id = get_group_id(0);
+    size_t group_size = get_local_size(0);
+    size_t genome = get_global_id(1);
+    size_t stride = get_global_size(0);
+
+    __global const double *c = constants + genome * GENOME_CONSTANTS_SIZE;
+    __global const uchar *p = powers + genome * GENOME_POW_SIZE;
+    const double c0 = c[0], c1 = c[1], c2 = c[2], c3 = c[3];
+    const int p0 = p[0], p1 = p[1], p2 = p[2];
+
+    double sum_acc = 0, sum_acc2 = 0, sum_acc_hr = 0;
+    for(size_t i = get_global_id(0); i < entries_count; i += stride) {
+        double acc = c0 * pown(acc_x[i], p0) + c1 * pown(acc_y[i], p1) + c2 * pown(acc_z[i], p2) + c3;
+        sum_acc += acc;
+        sum_acc2 += acc * acc;
+        sum_acc_hr += acc * hr_values[i];
+    }
+    local_sum_acc[local_id] = sum_acc;
+    local_sum_acc2[local_id] = sum_acc2;
+    local_sum_acc_hr[local_id] = sum_acc_hr;
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for(int i = group_size/2; i > 0; i >>= 1) {
+        if(local_id < i) {
+            local_sum_acc[local_id] += local_sum_acc[local_id + i];
+            local_sum_acc2[local_id] += local_sum_acc2[local_id + i];
+            local_sum_acc_hr[local_id] += local_sum_acc_hr[local_id + i];
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (local_id == 0) {
+        size_t index = genome * get_num_groups(0) + group_id;
+        partial_acc[index] = local_sum_acc[0];
+        partial_acc2[index] = local_sum_acc2[0];
+        partial_acc_hr[index] = local_sum_acc_hr[0];
+    }
+}
+
+__kernel void POPULATION_FITNESS_KERNEL(__global const double *partial_acc,
+                                        __global const double *partial_acc2,
+                                        __global const double *partial_acc_hr,
+                                        const uint groups_count,
+                                        const uint population_size,
+                                        const double entries_count,
+                                        const double hr_sum,
+                                        const double squared_hr_corr_sum,
+                                        __global double *fitness) {
+    size_t genome = get_global_id(0);
+    if(genome >= population_size) {
+        return;
+    }
+    double acc_sum = 0, acc_sum_pow_2 = 0, hr_acc_sum = 0;
+    for(uint i = 0; i < groups_count; ++i) {
+        acc_sum += partial_acc[genome * groups_count + i];
+        acc_sum_pow_2 += partial_acc2[genome * groups_count + i];
+        hr_acc_sum += partial_acc_hr[genome * groups_count + i];
+    }
+
+    // same formula as CalculationScheduler::get_abs_correlation_coefficient
+    double divident = (entries_count * hr_acc_sum) - (hr_sum * acc_sum);
+    double divisor1 = sqrt(squared_hr_corr_sum);
+    double divisor2 = sqrt(entries_count * acc_sum_pow_2) - (acc_sum * acc_sum);
+    double corr = fabs(divident / (divisor1 * divisor2));
+    // invalid values would break the selection
+    fitness[genome] = isfinite(corr) ? corr : 0.0;
+}
+
+__kernel void BEST_GENOME_KERNEL(__global const double *fitness,
+                                 const uint population_size,
+                                 __global const double *constants,
+                                 __global const uchar *powers,
+                                 __local double *local_fitness,
+                                 __local uint *local_index,
+                                 __global uint *best_index,
+                                 __global double *best_fitness,
+                                 __global double *best_constants,
+                                 __global uchar *best_powers) {
+    size_t local_id = get_local_id(0);
+    size_t group_size = get_local_size(0);
+
+    double best = -1.0;
+    uint index = 0;
+    for(uint i = local_id; i < population_size; i += group_size) {
+        if(fitness[i] > best) {
+            best = fitness[i];
+            index = i;
+        }
+    }
+    local_fitness[local_id] = best;
+    local_index[local_id] = index;
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for(int i = group_size/2; i > 0; i >>= 1) {
+        if(local_id < i) {
+            double other = local_fitness[local_id + i];
+            uint other_index = local_index[local_id + i];
+            if(other > local_fitness[local_id] || (other == local_fitness[local_id]
+                                                    && other_index < local_index[local_id])) {
+                local_fitness[local_id] = other;
+                local_index[local_id] = other_index;
+            }
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if(local_id == 0) {
+        uint best_genome = local_index[0];
+        *best_index = best_genome;
+        *best_fitness = local_fitness[0];
+        for(int i = 0; i < GENOME_CONSTANTS_SIZE; ++i) {
+            best_constants[i] = constants[best_genome * GENOME_CONSTANTS_SIZE + i];
+        }
+        for(int i = 0; i < GENOME_POW_SIZE; ++i) {
+            best_powers[i] = powers[best_genome * GENOME_POW_SIZE + i];
+        }
+    }
+}
+
+__kernel void CUMULATIVE_FITNESS_KERNEL(__global const double *fitness,
+                                        const uint population_size,
+                                        __global double *cumulative_fitness) {
+    if(get_global_id(0) != 0) {
+        return;
+    }
+    double sum = 0;
+    for(uint i = 0; i < population_size; ++i) {
+        sum += fitness[i];
+        cumulative_fitness[i] = sum;
+    }
+}
+
+inline uint select_parent(__global const double *fitness,
+                          __global const double *cumulative_fitness,
+                          const uint population_size,
+                          const uint selection,
+                          ulong *state) {
+    if(selection == ROULETTE_SELECTION) {
+        double total = cumulative_fitness[population_size - 1];
+        if(total <= 0) {
+            return random_uint(state, population_size);
+        }
+        double needed = random_double(state) * total;
+        uint low = 0, high = population_size - 1;
+        while(low < high) {
+            uint middle = (low + high) / 2;
+            if(cumulative_fitness[middle] > needed) {
+                high = middle;
+            } else {
+                low = middle + 1;
+            }
+        }
+        return low;
+    }
+
+    uint best = random_uint(state, population_size);
+    for(int i = 1; i < TOURNAMENT_SIZE; ++i) {
+        uint candidate = random_uint(state, population_size);
+        if(fitness[candidate] > fitness[best]) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+__kernel void BREED_KERNEL(__global const double *old_constants,
+                           __global const uchar *old_powers,
+                           __global const double *fitness,
+                           __global const double *cumulative_fitness,
+                           __global const uint *best_index,
+                           __global double *new_constants,
+                           __global uchar *new_powers,
+                           __global ulong *rng_states,
+                           const uint population_size,
+                           const uint selection,
+                           const double mutate_scope,
+                           const uint pow_scope) {
+    size_t genome = get_global_id(0);
+    if(genome >= population_size) {
+        return;
+    }
+
+    // the best genome is copied to the next generation untouched
+    if(genome == 0) {
+        uint best = *best_index;
+        for(int i = 0; i < GENOME_CONSTANTS_SIZE; ++i) {
+            new_constants[i] = old_constants[best * GENOME_CONSTANTS_SIZE + i];
+        }
+        for(int i = 0; i < GENOME_POW_SIZE; ++i) {
+            new_powers[i] = old_powers[best * GENOME_POW_SIZE + i];
+        }
+        return;
+    }
+
+    ulong state = rng_states[genome];
+    uint parent1 = select_parent(fitness, cumulative_fitness, population_size, selection, &state);
+    uint parent2 = select_parent(fitness, cumulative_fitness, population_size, selection, &state);
+
+    // powers are inherited from the first parent and constants from the second one
+    for(int i = 0; i < GENOME_POW_SIZE; ++i) {
+        new_powers[genome * GENOME_POW_SIZE + i] = old_powers[parent1 * GENOME_POW_SIZE + i];
+    }
+    for(int i = 0; i < GENOME_CONSTANTS_SIZE; ++i) {
+        new_constants[genome * GENOME_CONSTANTS_SIZE + i] = old_constants[parent2 * GENOME_CONSTANTS_SIZE + i];
+    }
+
+    // mutate one of the four constants or one of the three used powers
+    uint gene = random_uint(&state, MUTABLE_GENES_COUNT);
+    if(gene < GENOME_CONSTANTS_SIZE) {
+        new_constants[genome * GENOME_CONSTANTS_SIZE + gene] += (2.0 * random_double(&state) - 1.0) * mutate_scope;
+    } else {
+        new_powers[genome * GENOME_POW_SIZE + gene - GENOME_CONSTANTS_SIZE] = 1 + random_uint(&state, pow_scope);
+    }
+    rng_states[genome] = state;
+}
+)";
+
+
+OpenCLGeneticComponent::OpenCLGeneticComponent(OpenCLComponent &cl_device, const std::shared_ptr<input_data> &input,
+                                               const input_parameters &input_params):
+                                               cl_device(cl_device), input_params(input_params),
+                                               population_size(input_params.population_size),
+                                               entries_count(input->hr_entries_count),
+                                               hr_sum(input->hr_sum),
+                                               squared_hr_corr_sum(input->squared_hr_corr_sum),
+                                               selection(input_params.selection == "roulette"
+                                                            ? ROULETTE_SELECTION : TOURNAMENT_SELECTION){
+
+    const auto& device = cl_device.get_device();
+    cl::Program program = OpenCLComponent::build_program(cl_device.get_context(), device, genetic_kernels_source,
+                                                         genetic_build_options, input_params.cl_cache_dir);
+    this->sums_kernel = cl::Kernel(program, "POPULATION_SUMS_KERNEL");
+    this->fitness_kernel = cl::Kernel(program, "POPULATION_FITNESS_KERNEL");
+    this->best_kernel = cl::Kernel(program, "BEST_GENOME_KERNEL");
+    this->cumulative_kernel = cl::Kernel(program, "CUMULATIVE_FITNESS_KERNEL");
+    this->breed_kernel = cl::Kernel(program, "BREED_KERNEL");
+
+    //every work item sums many entries, so only a few groups per genome are needed
+    this->sums_groups_count = std::max<size_t>(1, std::min<size_t>(DEVICE_GA_GROUPS_PER_GENOME,
+                                                             this->entries_count / cl_device.work_group_size));
+    this->best_group_size = 1;
+    while(this->best_group_size * 2 <= std::min<size_t>(cl_device.work_group_size, 256)){
+        this->best_group_size *= 2;
+    }
+
+    init_buffers(input);
+}
+
+void OpenCLGeneticComponent::init_buffers(const std::shared_ptr<input_data> &input) {
+    const auto& context = this->cl_device.get_context();
+    const size_t numbers_bytes_size = sizeof(double) * this->entries_count;
+    const cl_mem_flags data_flags = CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR | CL_MEM_HOST_NO_ACCESS;
+
+    this->x_acc_vector = cl::Buffer(context, data_flags, numbers_bytes_size, input->acc_x->values.data());
+    this->y_acc_vector = cl::Buffer(context, data_flags, numbers_bytes_size, input->acc_y->values.data());
+    this->z_acc_vector = cl::Buffer(context, data_flags, numbers_bytes_size, input->acc_z->values.data());
+    this->hr_vector = cl::Buffer(context, data_flags, numbers_bytes_size, input->hr->values.data());
+
+    for(size_t i = 0; i < 2; ++i){
+        this->constants[i] = cl::Buffer(context, CL_MEM_READ_WRITE,
+                                        this->population_size * GENOME_CONSTANTS_SIZE * sizeof(double));
+        this->powers[i] = cl::Buffer(context, CL_MEM_READ_WRITE,
+                                     this->population_size * GENOME_POW_SIZE * sizeof(uint8_t));
+    }
+
+    const size_t partial_bytes_size = this->population_size * this->sums_groups_count * sizeof(double);
+    this->partial_acc = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS, partial_bytes_size);
+    this->partial_acc2 = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS, partial_bytes_size);
+    this->partial_acc_hr = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS, partial_bytes_size);
+    this->fitness = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS,
+                               this->population_size * sizeof(double));
+    this->cumulative_fitness = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_HOST_NO_ACCESS,
+                                          this->population_size * sizeof(double));
+
+    //seed the generator of every offspring slot from the application seed
+    std::vector<cl_ulong> states(this->population_size);
+    std::mt19937_64 seed_generator(this->input_params.seed);
+    for(auto& state: states){
+        do{
+            state = seed_generator();
+        }while(state == 0);
+    }
+    this->rng_states = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR | CL_MEM_HOST_NO_ACCESS,
+                                  states.size() * sizeof(cl_ulong), states.data());
+
+    this->best_index = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY, sizeof(cl_uint));
+    this->best_fitness = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY, sizeof(double));
+    this->best_constants = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY,
+                                      GENOME_CONSTANTS_SIZE * sizeof(double));
+    this->best_powers = cl::Buffer(context, CL_MEM_READ_WRITE | CL_MEM_HOST_READ_ONLY,
+                                   GENOME_POW_SIZE * sizeof(uint8_t));
+
+    const size_t work_group_size = this->cl_device.work_group_size;
+    this->sums_kernel.setArg(0, this->x_acc_vector);
+    this->sums_kernel.setArg(1, this->y_acc_vector);
+    this->sums_kernel.setArg(2, this->z_acc_vector);
+    this->sums_kernel.setArg(3, this->hr_vector);
+    this->sums_kernel.setArg(6, static_cast<cl_uint>(this->entries_count));
+    this->sums_kernel.setArg(7, work_group_size * sizeof(double), nullptr);
+    this->sums_kernel.setArg(8, work_group_size * sizeof(double), nullptr);
+    this->sums_kernel.setArg(9, work_group_size * sizeof(double), nullptr);
+    this->sums_kernel.setArg(10, this->partial_acc);
+    this->sums_kernel.setArg(11, this->partial_acc2);
+    this->sums_kernel.setArg(12, this->partial_acc_hr);
+
+    this->fitness_kernel.setArg(0, this->partial_acc);
+    this->fitness_kernel.setArg(1, this->partial_acc2);
+    this->fitness_kernel.setArg(2, this->partial_acc_hr);
+    this->fitness_kernel.setArg(3, static_cast<cl_uint>(this->sums_groups_count));
+    this->fitness_kernel.setArg(4, static_cast<cl_uint>(this->population_size));
+    this->fitness_kernel.setArg(5, static_cast<double>(this->entries_count));
+    this->fitness_kernel.setArg(6, this->hr_sum);
+    this->fitness_kernel.setArg(7, this->squared_hr_corr_sum);
+    this->fitness_kernel.setArg(8, this->fitness);
+
+    this->best_kernel.setArg(0, this->fitness);
+    this->best_kernel.setArg(1, static_cast<cl_uint>(this->population_size));
+    this->best_kernel.setArg(4, this->best_group_size * sizeof(double), nullptr);
+    this->best_kernel.setArg(5, this->best_group_size * sizeof(cl_uint), nullptr);
+    this->best_kernel.setArg(6, this->best_index);
+    this->best_kernel.setArg(7, this->best_fitness);
+    this->best_kernel.setArg(8, this->best_constants);
+    this->best_kernel.setArg(9, this->best_powers);
+
+    this->cumulative_kernel.setArg(0, this->fitness);
+    this->cumulative_kernel.setArg(1, static_cast<cl_uint>(this->population_size));
+    this->cumulative_kernel.setArg(2, this->cumulative_fitness);
+
+    this->breed_kernel.setArg(2, this->fitness);
+    this->breed_kernel.setArg(3, this->cumulative_fitness);
+    this->breed_kernel.setArg(4, this->best_index);
+    this->breed_kernel.setArg(7, this->rng_states);
+    this->breed_kernel.setArg(8, static_cast<cl_uint>(this->population_size));
+    this->breed_kernel.setArg(9, static_cast<cl_uint>(this->selection));
+    this->breed_kernel.setArg(10, this->input_params.const_scope * 0.01); //we want only 1% of the original
+    this->breed_kernel.setArg(11, static_cast<cl_uint>(this->input_params.pow_scope));
+}
+
+void OpenCLGeneticComponent::upload_population(const std::vector<genome> &population) {
+    std::vector<double> population_constants(this->population_size * GENOME_CONSTANTS_SIZE);
+    std::vector<uint8_t> population_powers(this->population_size * GENOME_POW_SIZE);
+    for(size_t i = 0; i < this->population_size; ++i){
+        std::copy(population[i].constants.begin(), population[i].constants.end(),
+                  population_constants.begin() + i * GENOME_CONSTANTS_SIZE);
+        std::copy(population[i].powers.begin(), population[i].powers.end(),
+                  population_powers.begin() + i * GENOME_POW_SIZE);
+    }
+    auto& cmd_queue = this->cl_device.get_command_queue();
+    this->current_population = 0;
+    cmd_queue.enqueueWriteBuffer(this->constants[0], CL_TRUE, 0,
+                                 population_constants.size() * sizeof(double), population_constants.data());
+    cmd_queue.enqueueWriteBuffer(this->powers[0], CL_TRUE, 0,
+                                 population_powers.size() * sizeof(uint8_t), population_powers.data());
+}
+
+void OpenCLGeneticComponent::evaluate_population() {
+    auto& cmd_queue = this->cl_device.get_command_queue();
+    const auto& current_constants = this->constants[this->current_population];
+    const auto& current_powers = this->powers[this->current_population];
+
+    const bool profiled = this->cl_device.get_profiler() != nullptr;
+    std::array<cl::Event, 3> kernel_events;
+
+    this->sums_kernel.setArg(4, current_constants);
+    this->sums_kernel.setArg(5, current_powers);
+    cmd_queue.enqueueNDRangeKernel(this->sums_kernel, cl::NullRange,
+                                   cl::NDRange(this->sums_groups_count * this->cl_device.work_group_size,
+                                               this->population_size),
+                                   cl::NDRange(this->cl_device.work_group_size, 1),
+                                   nullptr, profiled ? &kernel_events[0] : nullptr);
+
+    cmd_queue.enqueueNDRangeKernel(this->fitness_kernel, cl::NullRange, cl::NDRange(this->population_size),
+                                   cl::NullRange, nullptr, profiled ? &kernel_events[1] : nullptr);
+
+    this->best_kernel.setArg(2, current_constants);
+    this->best_kernel.setArg(3, current_powers);
+    cmd_queue.enqueueNDRangeKernel(this->best_kernel, cl::NullRange, cl::NDRange(this->best_group_size),
+                                   cl::NDRange(this->best_group_size), nullptr,
+                                   profiled ? &kernel_events[2] : nullptr);
+
+    if(profiled){
+        this->cl_device.record_profiled(kernel_events[0], "POPULATION_SUMS_KERNEL", false);
+        this->cl_device.record_profiled(kernel_events[1], "POPULATION_FITNESS_KERNEL", false);
+        this->cl_device.record_profiled(kernel_events[2], "BEST_GENOME_KERNEL", false);
+    }
+}
+
+void OpenCLGeneticComponent::breed_population() {
+    auto& cmd_queue = this->cl_device.get_command_queue();
+    const bool profiled = this->cl_device.get_profiler() != nullptr;
+    std::array<cl::Event, 2> kernel_events;
+    if(this->selection == ROULETTE_SELECTION){
+        cmd_queue.enqueueNDRangeKernel(this->cumulative_kernel, cl::NullRange, cl::NDRange(1), cl::NullRange,
+                                       nullptr, profiled ? &kernel_events[0] : nullptr);
+        if(profiled){
+            this->cl_device.record_profiled(kernel_events[0], "CUMULATIVE_FITNESS_KERNEL", false);
+        }
+    }
+
+    const size_t next_population = 1 - this->current_population;
+    this->breed_kernel.setArg(0, this->constants[this->current_population]);
+    this->breed_kernel.setArg(1, this->powers[this->current_population]);
+    this->breed_kernel.setArg(5, this->constants[next_population]);
+    this->breed_kernel.setArg(6, this->powers[next_population]);
+    cmd_queue.enqueueNDRangeKernel(this->breed_kernel, cl::NullRange, cl::NDRange(this->population_size),
+                                   cl::NullRange, nullptr, profiled ? &kernel_events[1] : nullptr);
+    if(profiled){
+        this->cl_device.record_profiled(kernel_events[1], "BREED_KERNEL", false);
+    }
+    this->current_population = next_population;
+}
+
+double OpenCLGeneticComponent::read_best_genome(genome &best_genome) {
+    auto& cmd_queue = this->cl_device.get_command_queue();
+    double corr = 0;
+    const bool profiled = this->cl_device.get_profiler() != nullptr;
+    std::array<cl::Event, 3> read_events;
+    cmd_queue.enqueueReadBuffer(this->best_constants, CL_FALSE, 0, GENOME_CONSTANTS_SIZE * sizeof(double),
+                                best_genome.constants.data(), nullptr, profiled ? &read_events[0] : nullptr);
+    cmd_queue.enqueueReadBuffer(this->best_powers, CL_FALSE, 0, GENOME_POW_SIZE * sizeof(uint8_t),
+                                best_genome.powers.data(), nullptr, profiled ? &read_events[1] : nullptr);
+    cmd_queue.enqueueReadBuffer(this->best_fitness, CL_TRUE, 0, sizeof(double), &corr,
+                                nullptr, profiled ? &read_events[2] : nullptr);
+    if(profiled){
+        for(const auto& read_event: read_events){
+            this->cl_device.record_profiled(read_event, "READ_BEST_GENOME", true);
+        }
+    }
+    return corr;
+}
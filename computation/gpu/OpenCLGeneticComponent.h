@@ -0,0 +1,87 @@
+#ifndef OCL_TEST_OPENCLGENETICCOMPONENT_H
+#define OCL_TEST_OPENCLGENETICCOMPONENT_H
+
+
+#include "OpenCLComponent.h"
+
+/// selection methods of the device genetic algorithm (have to match the defines in the kernel source)
+enum device_selection{
+    TOURNAMENT_SELECTION = 0, ROULETTE_SELECTION = 1
+};
+
+/// Component running the whole genetic algorithm on the openCL device. Population, fitness values
+/// and random generator states never leave the device, only the best genome is read back on demand.
+class OpenCLGeneticComponent {
+
+public:
+    OpenCLGeneticComponent(OpenCLComponent& cl_device, const std::shared_ptr<input_data>& input,
+                           const input_parameters& input_params);
+
+public:
+    /// Uploads the initial population to the device
+    /// \param population initial population
+    void upload_population(const std::vector<genome>& population);
+
+    /// Enqueues calculation of fitness of the whole current population and search of its best genome
+    void evaluate_population();
+
+    /// Enqueues generation of new population from the evaluated one (elitism, selection, crossover, mutation)
+    void breed_population();
+
+    /// Reads the best genome of the last evaluated population, blocks until it is available
+    /// \param best_genome output best genome
+    /// \return fitness (correlation) of the best genome
+    double read_best_genome(genome& best_genome);
+
+private:
+    OpenCLComponent& cl_device;
+    const input_parameters input_params;
+
+    const size_t population_size;
+    const size_t entries_count;
+    const double hr_sum;
+    const double squared_hr_corr_sum;
+
+    const device_selection selection;
+
+    /// count of work groups each genome is evaluated with (data are traversed with grid stride)
+    size_t sums_groups_count = 0;
+    /// work group size of the single group searching for the best genome
+    size_t best_group_size = 1;
+
+    cl::Kernel sums_kernel;
+    cl::Kernel fitness_kernel;
+    cl::Kernel best_kernel;
+    cl::Kernel cumulative_kernel;
+    cl::Kernel breed_kernel;
+
+    cl::Buffer hr_vector;
+    cl::Buffer x_acc_vector;
+    cl::Buffer y_acc_vector;
+    cl::Buffer z_acc_vector;
+
+    /// population buffers, current one is evaluated and the other one receives offspring
+    std::array<cl::Buffer, 2> constants;
+    std::array<cl::Buffer, 2> powers;
+    size_t current_population = 0;
+
+    cl::Buffer partial_acc;
+    cl::Buffer partial_acc2;
+    cl::Buffer partial_acc_hr;
+    cl::Buffer fitness;
+    cl::Buffer cumulative_fitness;
+    cl::Buffer rng_states;
+
+    cl::Buffer best_index;
+    cl::Buffer best_fitness;
+    cl::Buffer best_constants;
+    cl::Buffer best_powers;
+
+private:
+    /// Creates all buffers and uploads the static data and random generator states
+    /// \param input input data processed from the input files
+    void init_buffers(const std::shared_ptr<input_data>& input);
+};
+
+
+#endif //OCL_TEST_OPENCLGENETICCOMPONENT_H
@@ -0,0 +1,139 @@
+#include "OpenCLProfiler.h"
+
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+#include <CL/opencl.hpp>
+
+
+OpenCLProfiler::OpenCLProfiler(size_t step_info_interval) : step_info_interval(std::max<size_t>(1, step_info_interval)){
+}
+
+void OpenCLProfiler::begin_generation() {
+    std::lock_guard<std::mutex> lock(this->profiler_mutex);
+    ++this->current_generation;
+}
+
+void OpenCLProfiler::record(const cl::Event &event, const char *name, bool is_transfer, size_t device_index) {
+    std::lock_guard<std::mutex> lock(this->profiler_mutex);
+    profiled_command command;
+    command.name = name;
+    command.is_transfer = is_transfer;
+    command.device_index = device_index;
+    command.generation = this->current_generation;
+    this->pending_commands.emplace_back(event, command);
+    if(this->pending_commands.size() % PROFILER_DRAIN_INTERVAL == 0){
+        drain_finished();
+    }
+}
+
+void OpenCLProfiler::collect() {
+    std::lock_guard<std::mutex> lock(this->profiler_mutex);
+    for(auto& [event, command]: this->pending_commands){
+        aggregate(event, command);
+    }
+    this->pending_commands.clear();
+    this->collected_generation = this->current_generation;
+}
+
+void OpenCLProfiler::drain_finished() {
+    auto unfinished = std::remove_if(this->pending_commands.begin(), this->pending_commands.end(),
+                                     [this](auto& pending){
+        if(pending.first.template getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() != CL_COMPLETE){
+            return false;
+        }
+        aggregate(pending.first, pending.second);
+        return true;
+    });
+    this->pending_commands.erase(unfinished, this->pending_commands.end());
+}
+
+void OpenCLProfiler::aggregate(const cl::Event &event, profiled_command &command) {
+    command.queued = event.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>();
+    command.submit = event.getProfilingInfo<CL_PROFILING_COMMAND_SUBMIT>();
+    command.start = event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+    command.end = event.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+
+    auto& profile = this->generations[command.generation];
+    const auto duration = command.end - command.start;
+    if(command.is_transfer){
+        ++profile.transfer_count;
+        profile.transfer_time += duration;
+    }else{
+        ++profile.kernel_count;
+        profile.kernel_time += duration;
+    }
+    profile.queued_to_start_time += command.start - command.queued;
+    profile.first_queued = std::min(profile.first_queued, command.queued);
+    profile.last_end = std::max(profile.last_end, command.end);
+
+    if(this->commands.size() < MAX_TRACED_COMMANDS){
+        this->commands.push_back(command);
+    }else{
+        ++this->dropped_commands;
+    }
+}
+
+void OpenCLProfiler::print_due_summaries() {
+    std::lock_guard<std::mutex> lock(this->profiler_mutex);
+    //generations with commands still in flight are printed after the next collect
+    const auto collected_end = this->generations.upper_bound(this->collected_generation);
+    for(auto it = this->generations.begin(); it != collected_end; it = this->generations.erase(it)){
+        const auto& [generation, profile] = *it;
+        if(generation <= this->printed_generations){
+            continue;
+        }
+        this->printed_generations = generation;
+        if((generation - 1) % this->step_info_interval != 0){
+            continue;
+        }
+        const size_t commands_count = profile.kernel_count + profile.transfer_count;
+        std::cout << "Device profile of " << generation << "th step: "
+                  << profile.kernel_count << " kernels " << profile.kernel_time / 1e6 << " ms, "
+                  << profile.transfer_count << " transfers " << profile.transfer_time / 1e6 << " ms, "
+                  << "mean queued to start " << (commands_count > 0
+                                                    ? profile.queued_to_start_time / 1e3 / commands_count : 0)
+                  << " us, device span " << (profile.last_end - profile.first_queued) / 1e6 << " ms" << '\n';
+    }
+}
+
+bool OpenCLProfiler::export_chrome_trace(const std::string &path) const {
+    std::ofstream trace_file(path);
+    if(!trace_file.is_open()){
+        std::cerr << "Failed to open trace file " << path << std::endl;
+        return false;
+    }
+
+    cl_ulong time_origin = std::numeric_limits<cl_ulong>::max();
+    for(const auto& command: this->commands){
+        time_origin = std::min(time_origin, command.queued);
+    }
+
+    //complete events ("X") in microseconds, every device is a process with kernels and transfers as threads
+    trace_file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    for(const auto& command: this->commands){
+        if(!first){
+            trace_file << ",\n";
+        }
+        first = false;
+        trace_file << "{\"name\":\"" << command.name << "\",\"cat\":\""
+                   << (command.is_transfer ? "transfer" : "kernel") << "\",\"ph\":\"X\""
+                   << ",\"ts\":" << (command.start - time_origin) / 1e3
+                   << ",\"dur\":" << (command.end - command.start) / 1e3
+                   << ",\"pid\":" << command.device_index << ",\"tid\":" << (command.is_transfer ? 1 : 0)
+                   << ",\"args\":{\"generation\":" << command.generation
+                   << ",\"queued_us\":" << (command.queued - time_origin) / 1e3
+                   << ",\"submit_us\":" << (command.submit - time_origin) / 1e3 << "}}";
+    }
+    trace_file << "\n]}\n";
+    trace_file.close();
+    std::cout << "OpenCL trace with " << this->commands.size() << " commands written to " << path << std::endl;
+    if(this->dropped_commands > 0){
+        std::cout << "Trace is limited to " << MAX_TRACED_COMMANDS << " commands, " << this->dropped_commands
+                  << " later commands were only aggregated" << std::endl;
+    }
+    return true;
+}
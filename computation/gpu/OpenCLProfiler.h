@@ -0,0 +1,98 @@
+#ifndef OCL_TEST_OPENCLPROFILER_H
+#define OCL_TEST_OPENCLPROFILER_H
+
+
+#include <mutex>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+#include "CL/opencl.hpp"
+
+/// One profiled openCL command
+struct profiled_command{
+    const char* name = "";
+    bool is_transfer = false;
+    size_t device_index = 0;
+    size_t generation = 0;
+    /// timestamps in ns from the device clock
+    cl_ulong queued = 0;
+    cl_ulong submit = 0;
+    cl_ulong start = 0;
+    cl_ulong end = 0;
+};
+
+/// Aggregated times of single generation in ns
+struct generation_profile{
+    size_t kernel_count = 0;
+    size_t transfer_count = 0;
+    cl_ulong kernel_time = 0;
+    cl_ulong transfer_time = 0;
+    /// time the commands waited from enqueue to start of the execution
+    cl_ulong queued_to_start_time = 0;
+    cl_ulong first_queued = std::numeric_limits<cl_ulong>::max();
+    cl_ulong last_end = 0;
+};
+
+/// count of recorded commands after which the finished ones are aggregated and their events released
+#define PROFILER_DRAIN_INTERVAL 256
+/// maximal count of commands kept for the chrome trace, the following ones are only aggregated
+#define MAX_TRACED_COMMANDS 262144
+
+/// Collects profiling info of openCL commands for every generation and exports them as chrome trace.
+/// Events are released as soon as their commands finish, only the aggregated generations that were not
+/// printed yet and limited count of the trace records are kept.
+class OpenCLProfiler {
+
+public:
+    explicit OpenCLProfiler(size_t step_info_interval);
+
+    /// Starts new generation, all commands recorded from now on belong to it
+    void begin_generation();
+
+    /// Records command event of a queue with enabled profiling. Profiling info is read later in collect()
+    /// \param event event of the enqueued command
+    /// \param name name of the command shown in the trace
+    /// \param is_transfer flag indicating that the command is memory transfer and not kernel
+    /// \param device_index index of the device the command was enqueued to
+    void record(const cl::Event& event, const char* name, bool is_transfer, size_t device_index);
+
+    /// Reads profiling info of all recorded commands, they have to be already finished
+    void collect();
+
+    /// Prints aggregated times of collected generations that fall on the step info interval, printed
+    /// generations are released
+    void print_due_summaries();
+
+    /// Writes all collected commands as chrome trace json (chrome://tracing, Perfetto)
+    /// \param path path of the output file
+    /// \return true if the file was written
+    bool export_chrome_trace(const std::string& path) const;
+
+private:
+    /// Reads profiling info of the finished command and adds it to its generation and the trace
+    /// \param event event of the finished command
+    /// \param command recorded command
+    void aggregate(const cl::Event& event, profiled_command& command);
+
+    /// Aggregates commands that already finished and releases their events
+    void drain_finished();
+
+    const size_t step_info_interval;
+
+    std::mutex profiler_mutex;
+
+    size_t current_generation = 0;
+    size_t printed_generations = 0;
+    /// last generation whose all commands were collected
+    size_t collected_generation = 0;
+    /// count of commands that didn't fit into the trace
+    size_t dropped_commands = 0;
+
+    std::vector<std::pair<cl::Event, profiled_command>> pending_commands;
+    std::vector<profiled_command> commands;
+    std::map<size_t, generation_profile> generations;
+};
+
+
+#endif //OCL_TEST_OPENCLPROFILER_H
@@ -1,20 +1,38 @@
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <map>
 #include "preprocessing/Preprocessor.h"
 #include "computation/CalculationScheduler.h"
 #include "preprocessing/ParallelPreprocessor.h"
+#include "preprocessing/MemoryPlanner.h"
 
-#include <ppl.h>
 #include <array>
 
 #include "computation/gpu/OpenCLComponent.h"
 #include "computation/ParallelCalculationScheduler.h"
+#include "computation/HybridCalculationScheduler.h"
+#include "computation/DeviceCalculationScheduler.h"
+#include "computation/PipelinedCalculationScheduler.h"
+#include "computation/StreamingCalculationScheduler.h"
+#include "computation/NumaCalculationScheduler.h"
+#include "computation/RacingCalculationScheduler.h"
+#include "computation/AutoTuner.h"
+#include "computation/GenomeFile.h"
+#include "visualization/DensityHistogram.h"
+#include "visualization/DensityPlotWriter.h"
+#include "metrics/MetricsRegistry.h"
+#include "metrics/PerfCounters.h"
+#include "simd/SimdDispatch.h"
 
 
 void init_svg_header(std::ofstream &svgFile, double hr_min, double hr_max, double min_acc,
                      double max_acc);
 
-int createSVG(std::unique_ptr<input_vector>& hr, std::unique_ptr<input_vector>& trs_acc){
+int createSVG(std::unique_ptr<input_vector>& hr, std::unique_ptr<input_vector>& trs_acc,
+              const std::string& plot_mode){
+    ScopedTimer plot_timer(PHASE_PLOT);
     // Open an output file for writing
     std::ofstream svgFile("graph.svg");
 
@@ -33,34 +51,19 @@ int createSVG(std::unique_ptr<input_vector>& hr, std::unique_ptr<input_vector>&
     svgFile << "<!-- data -->\n";
 
     const size_t count = hr->values.size();
-    const auto scope = (max_acc - min_acc);
 
-    std::map<double, std::map<double, double>> canvas;
-
-    double wanted_precision = 100.0;
+    //points are binned into pixel sized cells, so every cell is written only once
+    DensityHistogram histogram;
+    histogram.fill(hr, trs_acc);
 
     const double point_opacity = count < 65000 ? 0.6 : count < 650000 ? 0.3 : count < 5000000 ? 0.02 : 0.01;
 
-    for(int i = 0; i < count; i++){
-        //first we have to norm transformed acc data
-        const double norm_acc = (trs_acc->values[i] - min_acc) / scope;
-        // we don't need full precision of double for visualization
-        const double x = floor(norm_acc  * 975.0 * wanted_precision) / wanted_precision + 25.0;
-        //hr is already normed
-        const double y = 975.0 - floor(hr->values[i] * 975.0 * wanted_precision) / wanted_precision;
-
-        //we first put it to map, so we can reduce duplicates
-        canvas[x][y] += point_opacity;
-    }
-
-    for(const auto& horizontal_pair : canvas){
-
-        const double x = horizontal_pair.first;
-        for(const auto& vertical_pair: horizontal_pair.second){
-            const double y = vertical_pair.first;
-            const double opacity = vertical_pair.second;
-            svgFile << "<circle cx=\"" << x << "\" cy=\"" << y << R"(" r="1" opacity=")" << opacity << "\"/>\n";
-        }
+    if(plot_mode == PLOT_MODE_RASTER){
+        DensityPlotWriter::write_raster(svgFile, histogram, point_opacity);
+    }else if(plot_mode == PLOT_MODE_RECTS){
+        DensityPlotWriter::write_rect_rows(svgFile, histogram, point_opacity);
+    }else{
+        DensityPlotWriter::write_circles(svgFile, histogram, point_opacity);
     }
 
     // Close the SVG document
@@ -104,29 +107,54 @@ void dump_result(const genome& best_genome, const double max_corr){
     std::cout << "_________________________________" << std::endl;
     std::cout << "The best correlation found: " << max_corr << std::endl;
     print_genome(best_genome);
+    //the file can be passed to -warm_start of the next run
+    if(!GenomeFile::write(BEST_GENOME_FILE_NAME, best_genome, max_corr)){
+        std::cerr << "Best genome cannot be written into " << BEST_GENOME_FILE_NAME << std::endl;
+    }
 }
 
 void parallel_run(const input_parameters& params){
 
     //init gpu and check if it is even possible
-    std::unique_ptr<OpenCLComponent> cl = nullptr;
-    OpenCLComponent::init_opencl_device(cl, params.desired_gpu_name);
-    if(cl == nullptr){
+    std::vector<std::unique_ptr<OpenCLComponent>> cl_devices;
+    OpenCLComponent::init_opencl_devices(cl_devices, params);
+    if(cl_devices.empty()){
         std::cerr << "GPU init failed!" << std::endl;
         exit(1);
     }
+    //commands of all devices are collected by single profiler
+    std::unique_ptr<OpenCLProfiler> profiler = nullptr;
+    if(params.cl_profile){
+        profiler = std::make_unique<OpenCLProfiler>(params.step_info_interval);
+        for(size_t i = 0; i < cl_devices.size(); ++i){
+            cl_devices[i]->set_profiler(profiler.get(), i);
+        }
+    }
+    //every device slice has to be divisible by work group size of its device
+    const size_t work_group_size = OpenCLComponent::get_common_work_group_size(cl_devices);
     std::cout << TEXT_SEPARATOR << std::endl << std::endl;
 
     //first we load and preprocess the input files
-    ParallelPreprocessor preprocessor {params.input_folder};
+    if(params.compressed_columns){
+        std::cerr << "Compressed columns are used only by the sequential run, the devices need the full ones"
+                  << std::endl;
+    }
+    const auto plan = MemoryPlanner::create_plan(params);
+    MemoryPlanner::print_plan(plan);
+    ParallelPreprocessor preprocessor {params.input_folder, false, params.positional_pairing};
+    preprocessor.set_memory_plan(plan);
     auto input = std::make_shared<input_data>();
     std::cout << TEXT_SEPARATOR << std::endl ;
-    preprocessor.load_and_preprocess_folder(input);
+    {
+        ScopedPerfSample load_sample(PERF_LOAD);
+        preprocessor.load_and_preprocess_folder(input);
+        load_sample.set_samples(input->hr_entries_count);
+    }
     std::cout << TEXT_SEPARATOR << std::endl << std::endl;
 
 
-    input->acc_entries_count -= input->acc_entries_count % cl->work_group_size;
-    input->hr_entries_count -= input->hr_entries_count % cl->work_group_size;
+    input->acc_entries_count -= input->acc_entries_count % (work_group_size * cl_devices.size());
+    input->hr_entries_count -= input->hr_entries_count % (work_group_size * cl_devices.size());
 
     if(input->acc_entries_count <= 0 || input->hr_entries_count <= 0){
         std::cerr << "Not enough data loaded! Terminating application!" << std::endl;
@@ -138,26 +166,55 @@ void parallel_run(const input_parameters& params){
     input->acc_z->values.resize(input->acc_entries_count);
     input->hr->values.resize(input->hr_entries_count);
 
-    //then we put the data to genetic algo
-    ParallelCalculationScheduler scheduler(*cl, input, params);
+    //then we put the data to genetic algo, chunks chosen by the memory plan bound the device buffers
+    const auto run_params = params.with_stream_chunk_size(plan.stream_chunk_size);
+    std::unique_ptr<CalculationScheduler> scheduler;
+    if(run_params.device_ga){
+        scheduler = std::make_unique<DeviceCalculationScheduler>(*cl_devices[0], input, run_params);
+    }else if(run_params.hybrid){
+        scheduler = std::make_unique<HybridCalculationScheduler>(cl_devices, input, run_params);
+    }else if(run_params.stream_chunk_size > 0
+                || StreamingCalculationScheduler::is_streaming_needed(cl_devices, input->hr_entries_count)){
+        //data that don't fit into the device memory are uploaded in chunks during every evaluation
+        if(run_params.pipeline_chunks > 1){
+            std::cout << "Notice: streamed evaluation doesn't pipeline the generations, -pipeline_chunks "
+                      << run_params.pipeline_chunks << " is ignored" << std::endl;
+        }
+        scheduler = std::make_unique<StreamingCalculationScheduler>(cl_devices, input, run_params);
+    }else if(run_params.pipeline_chunks > 1){
+        scheduler = std::make_unique<PipelinedCalculationScheduler>(cl_devices, input, run_params);
+    }else{
+        scheduler = std::make_unique<ParallelCalculationScheduler>(cl_devices, input, run_params);
+    }
     genome best_genome{};
-    double max_corr = scheduler.find_transformation_function(best_genome);
+    double max_corr = scheduler->find_transformation_function(best_genome);
 
     //now dumb the statistics of the best result and plot the correlation into svg
     auto trs_acc = std::make_unique<input_vector>();
     dump_result(best_genome, max_corr);
-    scheduler.transform(best_genome);
-    trs_acc->values = scheduler.transformation_result;
+    scheduler->transform(best_genome);
+    trs_acc->values = std::move(scheduler->transformation_result);
     preprocessor.find_min_max(trs_acc);
-    createSVG(input->hr, trs_acc);
+    createSVG(input->hr, trs_acc, params.plot_mode);
+
+    if(profiler != nullptr){
+        profiler->export_chrome_trace(CL_TRACE_FILE_NAME);
+    }
 }
 
 void serial_run(const input_parameters& params){
-    Preprocessor preprocessor {params.input_folder};
+    const auto plan = MemoryPlanner::create_plan(params);
+    MemoryPlanner::print_plan(plan);
+    Preprocessor preprocessor {params.input_folder, plan.storage != STORAGE_DOUBLE, params.positional_pairing};
+    preprocessor.set_memory_plan(plan);
 
     //first we load and preprocess the input files
     auto input = std::make_shared<input_data>();
-    preprocessor.load_and_preprocess_folder(input);
+    {
+        ScopedPerfSample load_sample(PERF_LOAD);
+        preprocessor.load_and_preprocess_folder(input);
+        load_sample.set_samples(input->hr_entries_count);
+    }
     std::cout << TEXT_SEPARATOR << std::endl << std::endl;
 
     if(input->acc_entries_count <= 0 || input->hr_entries_count <= 0){
@@ -166,18 +223,46 @@ void serial_run(const input_parameters& params){
     }
 
     //then we put the data to genetic algo
-    CalculationScheduler scheduler(input, params);
+    std::unique_ptr<CalculationScheduler> scheduler;
+    if(params.racing_sample_size > 0){
+        if(params.numa){
+            std::cerr << "Warning: racing evaluation doesn't support the NUMA mode, -numa is ignored!" << std::endl;
+        }
+        scheduler = std::make_unique<RacingCalculationScheduler>(input, params);
+    }else if(params.numa){
+        scheduler = std::make_unique<NumaCalculationScheduler>(input, params);
+    }else{
+        scheduler = std::make_unique<CalculationScheduler>(input, params);
+    }
     genome best_genome{};
-    double max_corr = scheduler.find_transformation_function(best_genome);
+    double max_corr = scheduler->find_transformation_function(best_genome);
 
     //now dumb the statistics of the best result and plot the correlation into svg
     dump_result(best_genome, max_corr);
     auto trs_acc = std::make_unique<input_vector>();
-    scheduler.transform(best_genome);
-    trs_acc->values = scheduler.transformation_result;
+    scheduler->transform(best_genome);
+    trs_acc->values = std::move(scheduler->transformation_result);
     preprocessor.find_min_max(trs_acc);
 
-    createSVG(input->hr, trs_acc);
+    if(input->compressed != nullptr){
+        //only the plot needs the normalized heart rates
+        Preprocessor::decompress_hr(input);
+    }
+    createSVG(input->hr, trs_acc, params.plot_mode);
+}
+
+void execute(const input_parameters& params){
+    //counters are opened before the run so that they are inherited by all its threads
+    if(params.perf_counters){
+        PerfCounters::get_instance().enable();
+    }
+    //columns are allocated during the loading, so their backing has to be chosen before it
+    HugePages::set_enabled(params.huge_pages);
+    std::cout << "Executing code in " << (params.parallel ? "parallel" : "sequential") << std::endl;
+    params.parallel ? parallel_run(params) : serial_run(params);
+    HugePages::print_usage();
+    MetricsRegistry::get_instance().report(params.metrics_output);
+    PerfCounters::get_instance().report();
 }
 
 inline bool is_quoted(const std::string& s) {
@@ -191,82 +276,200 @@ inline std::string remove_quotes(const std::string& s) {
 /// all possible args input arguments
 std::vector<std::string> possible_input_parameters = {"max_step_count", "population_size", "seed",
                                                       "desired_correlation", "const_scope", "pow_scope",
-                                                      "gpu_name", "parallel", "step_info_interval"};
+                                                      "gpu_name", "parallel", "step_info_interval",
+                                                      "specialized_kernels", "cl_cache_dir", "sub_devices",
+                                                      "hybrid", "hybrid_batch_size", "cpu_threads",
+                                                      "device_ga", "selection", "cl_profile", "pipeline_chunks",
+                                                      "zero_copy", "stream_chunk_size", "auto_tune",
+                                                      "work_group_size", "plot_mode", "metrics_output",
+                                                      "perf_counters", "simd_level", "numa", "huge_pages",
+                                                      "compressed_columns", "racing_sample_size",
+                                                      "racing_fraction", "positional_pairing", "memory_limit",
+                                                      "warm_start"};
+
+/// input arguments that are flags and don't take any value
+std::vector<std::string> possible_input_flags = {"parallel", "specialized_kernels", "hybrid", "device_ga",
+                                                 "cl_profile", "zero_copy", "auto_tune", "perf_counters",
+                                                 "numa", "huge_pages", "compressed_columns", "positional_pairing"};
+
+inline bool is_input_flag(const std::string& argument_name) {
+    return std::find(possible_input_flags.begin(), possible_input_flags.end(), argument_name)
+                != possible_input_flags.end();
+}
 
 input_parameters map_arguments(std::map<size_t, std::string> &arguments, const std::string &input_folder) {
-    //first get default values
-    size_t max_step_count = DEFAULT_MAX_STEP_COUNT;
-    size_t population_size = DEFAULT_POPULATION_SIZE;
-    size_t seed = time(nullptr);
-
-    double desired_correlation = DEFAULT_DESIRED_CORRELATION;
-
-    double const_scope = DEFAULT_CONST_SCOPE;
-    int pow_scope = DEFAULT_POW_SCOPE;
-
-    std::string desired_gpu_name = DEFAULT_GPU_NAME;
-
-    bool parallel = false;
-
-    size_t step_info_interval = DEFAULT_STEP_INFO_INTERVAL;
+    //first get default values, the seed defaults to the current time
+    input_parameters params;
+    params.seed = time(nullptr);
+    params.input_folder = input_folder;
 
     //check if there are any arguments passed that could override default values
     for (const auto& pair : arguments) {
         switch(pair.first){
             case 0:
-                max_step_count = abs(std::stoi(pair.second));
+                params.max_step_count = abs(std::stoi(pair.second));
                 break;
             case 1:
-                population_size = abs(std::stoi(pair.second));
-                if(population_size < VECTOR_SIZE){
+                params.population_size = abs(std::stoi(pair.second));
+                if(params.population_size < VECTOR_SIZE){
                     std::cerr << "Population size has to be dividable by number " << VECTOR_SIZE << std::endl;
                     exit(-1);
                 }
-                population_size -= population_size % VECTOR_SIZE;
+                params.population_size -= params.population_size % VECTOR_SIZE;
                 break;
             case 2:
-                seed = std::stoi(pair.second);
+                params.seed = std::stoi(pair.second);
                 break;
             case 3:
-                desired_correlation = abs(std::stoi(pair.second));
-                if(desired_correlation < 0 && desired_correlation > 1){
+                params.desired_correlation = abs(std::stoi(pair.second));
+                if(params.desired_correlation < 0 && params.desired_correlation > 1){
                     std::cerr << "Desired correlation value has to be between 0 and 1!" << std::endl;
                     exit(-1);
                 }
                 break;
             case 4:
-                const_scope = abs(std::stoi(pair.second));
-                if(const_scope > 10000 || const_scope < -10000){
+                params.const_scope = abs(std::stoi(pair.second));
+                if(params.const_scope > 10000 || params.const_scope < -10000){
                     std::cerr << "The value you passed for const scope is too great. "
                                  "The calculated sums will probably overflow." << std::endl;
                     exit(-1);
                 }
                 break;
             case 5:
-                pow_scope = abs(std::stoi(pair.second));
-                if(pow_scope > 5){
+                params.pow_scope = abs(std::stoi(pair.second));
+                if(params.pow_scope > 5){
                     std::cerr << "The value you passed for power scope is too great. "
                                  "The calculated sums will probably overflow." << std::endl;
                     exit(-1);
-                }else if(pow_scope < 1){
+                }else if(params.pow_scope < 1){
                     std::cerr << "The value you passed for power scope is small. " << std::endl;
                     exit(-1);
                 }
                 break;
             case 6:
-                desired_gpu_name = pair.second;
+                params.desired_gpu_name = pair.second;
                 break;
             case 7:
-                parallel = true;
+                params.parallel = true;
                 break;
             case 8:
-                step_info_interval = abs(std::stoi(pair.second));
+                params.step_info_interval = abs(std::stoi(pair.second));
+                break;
+            case 9:
+                params.specialized_kernels = true;
+                break;
+            case 10:
+                params.cl_cache_dir = pair.second;
+                break;
+            case 11:
+                params.sub_devices = abs(std::stoi(pair.second));
+                if(params.sub_devices < 1){
+                    params.sub_devices = 1;
+                }
+                break;
+            case 12:
+                //params.hybrid evaluation runs on top of the openCL path
+                params.hybrid = true;
+                params.parallel = true;
+                break;
+            case 13:
+                params.hybrid_batch_size = std::max(1, abs(std::stoi(pair.second)));
+                break;
+            case 14:
+                params.cpu_threads = abs(std::stoi(pair.second));
+                break;
+            case 15:
+                //device genetic algorithm runs on top of the openCL path
+                params.device_ga = true;
+                params.parallel = true;
+                break;
+            case 16:
+                params.selection = pair.second;
+                if(params.selection != "tournament" && params.selection != "roulette"){
+                    std::cerr << "Selection has to be either tournament or roulette!" << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 17:
+                params.cl_profile = true;
+                break;
+            case 18:
+                params.pipeline_chunks = std::max(1, abs(std::stoi(pair.second)));
+                break;
+            case 19:
+                params.zero_copy = true;
+                break;
+            case 20:
+                params.stream_chunk_size = std::stoull(pair.second);
+                break;
+            case 21:
+                params.auto_tune = true;
+                break;
+            case 22:
+                params.work_group_size = abs(std::stoi(pair.second));
+                //the kernel reduces the work group by halving it
+                if(params.work_group_size == 0 || (params.work_group_size & (params.work_group_size - 1)) != 0){
+                    std::cerr << "Work group size has to be a positive power of two!" << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 23:
+                params.plot_mode = pair.second;
+                if(params.plot_mode != PLOT_MODE_CIRCLES && params.plot_mode != PLOT_MODE_RECTS && params.plot_mode != PLOT_MODE_RASTER){
+                    std::cerr << "Plot mode has to be either circles, rects or raster!" << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 24:
+                params.metrics_output = pair.second;
+                break;
+            case 25:
+                params.perf_counters = true;
+                break;
+            case 26:
+                params.simd_level = pair.second;
+                if(params.simd_level != SIMD_LEVEL_AUTO && params.simd_level != SIMD_LEVEL_SCALAR && params.simd_level != SIMD_LEVEL_SSE2
+                        && params.simd_level != SIMD_LEVEL_AVX2 && params.simd_level != SIMD_LEVEL_AVX512){
+                    std::cerr << "SIMD level has to be either auto, scalar, sse2, avx2 or avx512!" << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 27:
+                params.numa = true;
+                break;
+            case 28:
+                params.huge_pages = true;
+                break;
+            case 29:
+                params.compressed_columns = true;
+                break;
+            case 30:
+                params.racing_sample_size = std::stoull(pair.second);
+                break;
+            case 31:
+                params.racing_fraction = std::stod(pair.second);
+                if(params.racing_fraction <= 0 || params.racing_fraction > 1){
+                    std::cerr << "Racing fraction has to be greater than 0 and at most 1!" << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 32:
+                params.positional_pairing = true;
+                break;
+            case 33:
+                try{
+                    params.memory_limit = MemoryPlanner::parse_memory_size(pair.second);
+                }catch(const std::exception&){
+                    std::cerr << "Memory limit has to be a size in bytes with optional K, M or G suffix!" << std::endl;
+                    exit(-1);
+                }
+                break;
+            case 34:
+                params.warm_start = pair.second;
                 break;
         }
     }
 
-    input_parameters params(max_step_count, population_size, seed, desired_correlation, const_scope,
-                            pow_scope, desired_gpu_name, parallel, input_folder, step_info_interval);
     return params;
 }
 
@@ -276,14 +479,16 @@ void print_help_message() {
 
     std::cout << "Possible parameters:" << std::endl;
     for (const auto& parameter: possible_input_parameters) {
-        if(parameter == "parallel"){
+        if(is_input_flag(parameter)){
             continue;
         }
         std::cout << "\t-" << parameter << " \"<value>\"" << std::endl;
     }
 
     std::cout << "Possible flags:" << std::endl;
-    std::cout << "\t-parallel" << std::endl;
+    for (const auto& flag: possible_input_flags) {
+        std::cout << "\t-" << flag << std::endl;
+    }
 
     std::cout << "More information can be found in documentation." << std::endl;
 }
@@ -307,7 +512,7 @@ void split_arguments(int argc, char *const *argv, std::map<size_t, std::string>
             }
             size_t index = it - possible_input_parameters.begin();
             // Check if there is a corresponding value
-            if (i + 1 < argc) {
+            if (!is_input_flag(argName) && i + 1 < argc) {
                 std::string argValue = argv[i + 1];
 
                 // Remove quotes if present
@@ -343,8 +548,24 @@ int main(int argc, char* argv[]) {
     input_parameters params = parse_arguments(argc, argv);
     params.print_input_parameters();
 
-    std::cout << "Executing code in " << (params.parallel ? "parallel" : "sequential") << std::endl;
-    params.parallel ? parallel_run(params) : serial_run(params);
+    //kernels are selected before the tuning, so the candidates are measured with them
+    if(!SimdDispatch::select_level(params.simd_level)){
+        std::cerr << "SIMD level " << params.simd_level << " is not supported by this CPU (the best supported is "
+                  << SimdDispatch::get_level_name(SimdDispatch::detect_level()) << ")!" << std::endl;
+        exit(-1);
+    }
+    std::cout << "Using " << SimdDispatch::get_level_name(SimdDispatch::get_kernels().level) << " CPU kernels"
+              << std::endl;
+
+    if(params.auto_tune){
+        //backend and its configuration are chosen by measurement instead of the passed parameters
+        AutoTuner tuner(params);
+        const input_parameters tuned_params = tuner.get_tuned_parameters();
+        execute(tuned_params);
+        return EXIT_SUCCESS;
+    }
+
+    execute(params);
     return EXIT_SUCCESS;
 }
 
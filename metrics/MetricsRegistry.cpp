@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include "MetricsRegistry.h"
+#include "../utils.h"
+
+
+MetricsRegistry& MetricsRegistry::get_instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+thread_metrics* MetricsRegistry::register_thread() {
+    std::lock_guard<std::mutex> lock(this->buffers_mutex);
+    this->thread_buffers.push_back(std::make_unique<thread_metrics>());
+    return this->thread_buffers.back().get();
+}
+
+const char* MetricsRegistry::get_phase_name(metric_phase phase) {
+    switch(phase){
+        case PHASE_PARSE:
+            return "parse";
+        case PHASE_NORMALIZE:
+            return "normalize";
+        case PHASE_INITIALIZE:
+            return "initialize";
+        case PHASE_EVALUATE:
+            return "evaluate";
+        case PHASE_REPOPULATE:
+            return "repopulate";
+        case PHASE_MUTATE:
+            return "mutate";
+        case PHASE_PLOT:
+            return "plot";
+        default:
+            return "unknown";
+    }
+}
+
+const char* MetricsRegistry::get_counter_name(metric_counter counter) {
+    switch(counter){
+        case COUNTER_PARSED_FILES:
+            return "parsed_files";
+        case COUNTER_GENERATIONS:
+            return "generations";
+        case COUNTER_EVALUATED_GENOMES:
+            return "evaluated_genomes";
+        case COUNTER_MUTATED_GENOMES:
+            return "mutated_genomes";
+        case COUNTER_SAMPLE_VISITS:
+            return "sample_visits";
+        case COUNTER_HYBRID_CPU_GENOMES:
+            return "hybrid_cpu_genomes";
+        case COUNTER_HYBRID_DEVICE_GENOMES:
+            return "hybrid_device_genomes";
+        default:
+            return "unknown";
+    }
+}
+
+std::vector<phase_summary> MetricsRegistry::summarize() const {
+    std::lock_guard<std::mutex> lock(this->buffers_mutex);
+    std::vector<phase_summary> summaries;
+    for(size_t phase = 0; phase < PHASE_COUNT; ++phase){
+        std::vector<uint64_t> durations;
+        for(const auto& buffer: this->thread_buffers){
+            durations.insert(durations.end(), buffer->durations[phase].begin(), buffer->durations[phase].end());
+        }
+        if(durations.empty()){
+            continue;
+        }
+        std::sort(durations.begin(), durations.end());
+
+        phase_summary summary;
+        summary.phase = static_cast<metric_phase>(phase);
+        summary.count = durations.size();
+        //nearest rank percentiles
+        auto percentile = [&](double rank){
+            const auto index = static_cast<size_t>(rank * static_cast<double>(durations.size() - 1) + 0.5);
+            return durations[index];
+        };
+        summary.min = durations.front();
+        summary.p50 = percentile(0.5);
+        summary.p99 = percentile(0.99);
+        summary.max = durations.back();
+        for(const auto duration: durations){
+            summary.total += duration;
+            size_t bucket = 0;
+            while(bucket + 1 < METRICS_HISTOGRAM_BUCKETS && (duration >> (bucket + 1)) != 0){
+                ++bucket;
+            }
+            ++summary.histogram[bucket];
+        }
+        summaries.push_back(summary);
+    }
+    return summaries;
+}
+
+std::array<uint64_t, COUNTER_COUNT> MetricsRegistry::sum_counters() const {
+    std::lock_guard<std::mutex> lock(this->buffers_mutex);
+    std::array<uint64_t, COUNTER_COUNT> counters {};
+    for(const auto& buffer: this->thread_buffers){
+        for(size_t counter = 0; counter < COUNTER_COUNT; ++counter){
+            counters[counter] += buffer->counters[counter];
+        }
+    }
+    return counters;
+}
+
+void MetricsRegistry::report(const std::string &output_name) const {
+    const auto summaries = summarize();
+    const auto counters = sum_counters();
+    print_summary(summaries, counters);
+    if(output_name == DISABLED_METRICS_OUTPUT){
+        return;
+    }
+    write_json(output_name + ".json", summaries, counters);
+    write_csv(output_name + ".csv", summaries);
+    std::cout << "Metrics were written into " << output_name << ".json and " << output_name << ".csv" << std::endl;
+}
+
+void MetricsRegistry::print_summary(const std::vector<phase_summary> &summaries,
+                                    const std::array<uint64_t, COUNTER_COUNT> &counters) {
+    auto to_ms = [](uint64_t duration){
+        return static_cast<double>(duration) / 1e6;
+    };
+    std::cout << TEXT_SEPARATOR << "\n" << "Metrics of the run (ms):" << "\n";
+    std::cout << std::left << std::setw(12) << "phase" << std::right << std::setw(8) << "count"
+              << std::setw(12) << "total" << std::setw(12) << "mean" << std::setw(12) << "p50"
+              << std::setw(12) << "p99" << std::setw(12) << "max" << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    for(const auto& summary: summaries){
+        std::cout << std::left << std::setw(12) << get_phase_name(summary.phase) << std::right
+                  << std::setw(8) << summary.count << std::setw(12) << to_ms(summary.total)
+                  << std::setw(12) << to_ms(summary.total) / static_cast<double>(summary.count)
+                  << std::setw(12) << to_ms(summary.p50) << std::setw(12) << to_ms(summary.p99)
+                  << std::setw(12) << to_ms(summary.max) << "\n";
+    }
+    std::cout << std::defaultfloat;
+    for(size_t counter = 0; counter < COUNTER_COUNT; ++counter){
+        std::cout << get_counter_name(static_cast<metric_counter>(counter)) << ": " << counters[counter] << "\n";
+    }
+    std::cout << TEXT_SEPARATOR << std::endl;
+}
+
+void MetricsRegistry::write_json(const std::string &file_name, const std::vector<phase_summary> &summaries,
+                                 const std::array<uint64_t, COUNTER_COUNT> &counters) {
+    std::ofstream json_file(file_name);
+    if(!json_file.is_open()){
+        std::cerr << "Failed to open metrics file " << file_name << std::endl;
+        return;
+    }
+    json_file << "{\n  \"phases\": [";
+    for(size_t i = 0; i < summaries.size(); ++i){
+        const auto& summary = summaries[i];
+        json_file << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << get_phase_name(summary.phase)
+                  << "\", \"count\": " << summary.count << ", \"total_ns\": " << summary.total
+                  << ", \"min_ns\": " << summary.min << ", \"p50_ns\": " << summary.p50
+                  << ", \"p99_ns\": " << summary.p99 << ", \"max_ns\": " << summary.max << ", \"histogram\": [";
+        //only the non empty buckets are written, every bucket is identified by its upper bound
+        bool first_bucket = true;
+        for(size_t bucket = 0; bucket < METRICS_HISTOGRAM_BUCKETS; ++bucket){
+            if(summary.histogram[bucket] == 0){
+                continue;
+            }
+            json_file << (first_bucket ? "" : ", ") << "{\"below_ns\": ";
+            if(bucket + 1 < METRICS_HISTOGRAM_BUCKETS){
+                json_file << (uint64_t{1} << (bucket + 1));
+            }else{
+                json_file << "null";
+            }
+            json_file << ", \"count\": " << summary.histogram[bucket] << "}";
+            first_bucket = false;
+        }
+        json_file << "]}";
+    }
+    json_file << "\n  ],\n  \"counters\": {";
+    for(size_t counter = 0; counter < COUNTER_COUNT; ++counter){
+        json_file << (counter == 0 ? "\n" : ",\n") << "    \""
+                  << get_counter_name(static_cast<metric_counter>(counter)) << "\": " << counters[counter];
+    }
+    json_file << "\n  }\n}\n";
+}
+
+void MetricsRegistry::write_csv(const std::string &file_name, const std::vector<phase_summary> &summaries) {
+    std::ofstream csv_file(file_name);
+    if(!csv_file.is_open()){
+        std::cerr << "Failed to open metrics file " << file_name << std::endl;
+        return;
+    }
+    csv_file << "phase,count,total_ns,min_ns,p50_ns,p99_ns,max_ns\n";
+    for(const auto& summary: summaries){
+        csv_file << get_phase_name(summary.phase) << "," << summary.count << "," << summary.total << ","
+                 << summary.min << "," << summary.p50 << "," << summary.p99 << "," << summary.max << "\n";
+    }
+}
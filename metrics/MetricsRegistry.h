@@ -0,0 +1,150 @@
+#ifndef OCL_TEST_METRICSREGISTRY_H
+#define OCL_TEST_METRICSREGISTRY_H
+
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Phases of the run whose durations are recorded
+enum metric_phase : uint8_t{
+    PHASE_PARSE,
+    PHASE_NORMALIZE,
+    PHASE_INITIALIZE,
+    PHASE_EVALUATE,
+    PHASE_REPOPULATE,
+    PHASE_MUTATE,
+    PHASE_PLOT,
+    PHASE_COUNT
+};
+
+/// Events of the run that are counted
+enum metric_counter : uint8_t{
+    COUNTER_PARSED_FILES,
+    COUNTER_GENERATIONS,
+    COUNTER_EVALUATED_GENOMES,
+    COUNTER_MUTATED_GENOMES,
+    /// data entries the evaluations went through
+    COUNTER_SAMPLE_VISITS,
+    /// genomes evaluated by the CPU threads and by the devices of the hybrid run
+    COUNTER_HYBRID_CPU_GENOMES,
+    COUNTER_HYBRID_DEVICE_GENOMES,
+    COUNTER_COUNT
+};
+
+/// count of power of two buckets of the latency histogram, the last one holds everything above 2^63 ns
+const size_t METRICS_HISTOGRAM_BUCKETS = 64;
+
+/// Durations and counters recorded by one thread, only the owning thread writes into it
+struct thread_metrics{
+    std::array<std::vector<uint64_t>, PHASE_COUNT> durations;
+    std::array<uint64_t, COUNTER_COUNT> counters {};
+};
+
+/// Statistics of one phase aggregated over all threads
+struct phase_summary{
+    metric_phase phase = PHASE_PARSE;
+    size_t count = 0;
+    uint64_t total = 0;
+    uint64_t min = 0;
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t max = 0;
+    /// bucket i holds the durations from the interval [2^i, 2^(i+1)) ns
+    std::array<size_t, METRICS_HISTOGRAM_BUCKETS> histogram {};
+};
+
+/// Collects durations of the run phases and counters of its events. Every thread records into its own buffer
+/// without any locking, the buffers are merged only when the report is created at the end of the run.
+class MetricsRegistry {
+
+public:
+    /// \return registry shared by the whole application
+    static MetricsRegistry& get_instance();
+
+    /// Stores the duration of the phase into the buffer of the calling thread
+    /// \param phase measured phase
+    /// \param duration duration in nanoseconds
+    static void record(metric_phase phase, uint64_t duration){
+        get_thread_metrics().durations[phase].push_back(duration);
+    }
+
+    /// Increments the counter in the buffer of the calling thread
+    /// \param counter incremented counter
+    /// \param value added value
+    static void increment(metric_counter counter, uint64_t value = 1){
+        get_thread_metrics().counters[counter] += value;
+    }
+
+    /// Merges the buffers of all threads, has to be called when no other thread records anymore
+    /// \return statistics of the phases that were recorded at least once
+    [[nodiscard]] std::vector<phase_summary> summarize() const;
+
+    /// \return counters summed over all threads
+    [[nodiscard]] std::array<uint64_t, COUNTER_COUNT> sum_counters() const;
+
+    /// Prints the summary table and writes the metrics into <output_name>.json and <output_name>.csv
+    /// \param output_name name of the output files without extension, DISABLED_METRICS_OUTPUT writes no files
+    void report(const std::string& output_name) const;
+
+    /// \return printable name of the phase
+    static const char* get_phase_name(metric_phase phase);
+
+    /// \return printable name of the counter
+    static const char* get_counter_name(metric_counter counter);
+
+private:
+    MetricsRegistry() = default;
+
+    /// guards only the list of the buffers, the buffers themselves are written without locking
+    mutable std::mutex buffers_mutex;
+    /// buffers are owned by the registry so that the samples of finished threads are kept
+    std::vector<std::unique_ptr<thread_metrics>> thread_buffers;
+
+private:
+    /// \return buffer of the calling thread, it is registered on the first use
+    static thread_metrics& get_thread_metrics(){
+        thread_local thread_metrics* buffer = get_instance().register_thread();
+        return *buffer;
+    }
+
+    /// Creates new buffer for the calling thread
+    thread_metrics* register_thread();
+
+    /// Prints the phases and counters as a table
+    static void print_summary(const std::vector<phase_summary>& summaries,
+                              const std::array<uint64_t, COUNTER_COUNT>& counters);
+
+    static void write_json(const std::string& file_name, const std::vector<phase_summary>& summaries,
+                           const std::array<uint64_t, COUNTER_COUNT>& counters);
+
+    /// Writes one row per phase, counters are present only in the json output
+    static void write_csv(const std::string& file_name, const std::vector<phase_summary>& summaries);
+};
+
+/// Records the duration between its construction and destruction into the metrics registry
+class ScopedTimer {
+
+public:
+    explicit ScopedTimer(metric_phase phase): phase(phase), start_time(std::chrono::steady_clock::now()){}
+
+    ~ScopedTimer(){
+        const auto duration = std::chrono::steady_clock::now() - this->start_time;
+        MetricsRegistry::record(this->phase,
+                                std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const metric_phase phase;
+    const std::chrono::steady_clock::time_point start_time;
+};
+
+
+#endif //OCL_TEST_METRICSREGISTRY_H
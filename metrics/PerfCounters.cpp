@@ -0,0 +1,174 @@
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include "PerfCounters.h"
+#include "../utils.h"
+
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+PerfCounters& PerfCounters::get_instance() {
+    static PerfCounters counters;
+    return counters;
+}
+
+PerfCounters::PerfCounters() {
+    this->descriptors.fill(-1);
+}
+
+PerfCounters::~PerfCounters() {
+#if defined(__linux__)
+    for(const int descriptor: this->descriptors){
+        if(descriptor >= 0){
+            close(descriptor);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::enable() {
+    if(this->enabled){
+        return true;
+    }
+#if defined(__linux__)
+    const std::array<uint32_t, PERF_EVENT_COUNT> event_types = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                                                PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                                                PERF_TYPE_HW_CACHE};
+    const std::array<uint64_t, PERF_EVENT_COUNT> event_configs = {PERF_COUNT_HW_CPU_CYCLES,
+                                                                  PERF_COUNT_HW_INSTRUCTIONS,
+                                                                  PERF_COUNT_HW_CACHE_MISSES,
+                                                                  PERF_COUNT_HW_BRANCH_MISSES,
+                                                                  PERF_COUNT_HW_CACHE_DTLB
+                                                                    | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                                                    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+    int last_error = 0;
+    for(size_t event = 0; event < PERF_EVENT_COUNT; ++event){
+        perf_event_attr attributes {};
+        attributes.type = event_types[event];
+        attributes.size = sizeof(perf_event_attr);
+        attributes.config = event_configs[event];
+        //events are not grouped, grouped reads can't be combined with the inheritance to the child threads
+        attributes.inherit = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        const long descriptor = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+        if(descriptor < 0){
+            last_error = errno;
+            continue;
+        }
+        this->descriptors[event] = static_cast<int>(descriptor);
+        this->enabled = true;
+    }
+    if(!this->enabled){
+        std::cerr << "Hardware performance counters are not available (" << std::strerror(last_error)
+                  << "), the counter measurement is skipped" << std::endl;
+    }
+#else
+    std::cerr << "Hardware performance counters are supported only on Linux, the counter measurement is skipped"
+              << std::endl;
+#endif
+    return this->enabled;
+}
+
+perf_reading PerfCounters::read() const {
+    perf_reading reading;
+#if defined(__linux__)
+    for(size_t event = 0; event < PERF_EVENT_COUNT; ++event){
+        if(this->descriptors[event] < 0){
+            continue;
+        }
+        //value, time enabled and time running
+        uint64_t values[3] = {};
+        if(::read(this->descriptors[event], values, sizeof(values)) != sizeof(values) || values[2] == 0){
+            continue;
+        }
+        //the value is extrapolated when the event shared the hardware counter with other events
+        reading.values[event] = static_cast<double>(values[0]) * static_cast<double>(values[1])
+                                    / static_cast<double>(values[2]);
+    }
+#endif
+    return reading;
+}
+
+void PerfCounters::add(perf_phase phase, const perf_reading &begin, const perf_reading &end, uint64_t samples) {
+    auto& phase_totals = this->totals[phase];
+    for(size_t event = 0; event < PERF_EVENT_COUNT; ++event){
+        phase_totals.events[event] += end.values[event] - begin.values[event];
+    }
+    phase_totals.samples += samples;
+    ++phase_totals.executions_count;
+}
+
+const char* PerfCounters::get_phase_name(perf_phase phase) {
+    switch(phase){
+        case PERF_LOAD:
+            return "load";
+        case PERF_POST_PROCESS:
+            return "post_process";
+        case PERF_EVALUATE:
+            return "evaluate";
+        case PERF_REPOPULATE:
+            return "repopulate";
+        default:
+            return "unknown";
+    }
+}
+
+void PerfCounters::report() const {
+    if(!this->enabled){
+        return;
+    }
+    auto print_ratio = [this](perf_event_kind event, double value, double divisor){
+        if(this->descriptors[event] < 0 || divisor <= 0){
+            std::cout << std::setw(14) << "n/a";
+        }else{
+            std::cout << std::setw(14) << value / divisor;
+        }
+    };
+    std::cout << TEXT_SEPARATOR << "\n" << "Hardware counters of the run (load includes post_process):" << "\n";
+    std::cout << std::left << std::setw(14) << "phase" << std::right << std::setw(8) << "runs"
+              << std::setw(14) << "samples" << std::setw(14) << "IPC" << std::setw(14) << "bytes/sample"
+              << std::setw(14) << "LLC/sample" << std::setw(14) << "branch/sample" << std::setw(14) << "dTLB/sample"
+              << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    for(size_t phase = 0; phase < PERF_PHASE_COUNT; ++phase){
+        const auto& phase_totals = this->totals[phase];
+        if(phase_totals.executions_count == 0){
+            continue;
+        }
+        const auto& events = phase_totals.events;
+        const auto samples = static_cast<double>(phase_totals.samples);
+        std::cout << std::left << std::setw(14) << get_phase_name(static_cast<perf_phase>(phase)) << std::right
+                  << std::setw(8) << phase_totals.executions_count << std::setw(14) << phase_totals.samples;
+        print_ratio(PERF_INSTRUCTIONS, events[PERF_INSTRUCTIONS], events[PERF_CYCLES]);
+        //every miss of the last level cache loads one cache line from the memory
+        print_ratio(PERF_LLC_MISSES, events[PERF_LLC_MISSES] * PERF_CACHE_LINE_SIZE, samples);
+        print_ratio(PERF_LLC_MISSES, events[PERF_LLC_MISSES], samples);
+        print_ratio(PERF_BRANCH_MISSES, events[PERF_BRANCH_MISSES], samples);
+        //huge pages should lower the data TLB misses of the evaluation
+        print_ratio(PERF_DTLB_MISSES, events[PERF_DTLB_MISSES], samples);
+        std::cout << "\n";
+    }
+    std::cout << std::defaultfloat << TEXT_SEPARATOR << std::endl;
+}
+
+
+ScopedPerfSample::ScopedPerfSample(perf_phase phase, uint64_t samples): phase(phase), samples(samples) {
+    auto& counters = PerfCounters::get_instance();
+    if(counters.is_enabled()){
+        this->begin = counters.read();
+    }
+}
+
+ScopedPerfSample::~ScopedPerfSample() {
+    auto& counters = PerfCounters::get_instance();
+    if(counters.is_enabled()){
+        counters.add(this->phase, this->begin, counters.read(), this->samples);
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef OCL_TEST_PERFCOUNTERS_H
+#define OCL_TEST_PERFCOUNTERS_H
+
+
+#include <array>
+#include <cstdint>
+
+/// Phases of the run that are measured by the hardware counters
+enum perf_phase : uint8_t{
+    PERF_LOAD,
+    PERF_POST_PROCESS,
+    PERF_EVALUATE,
+    PERF_REPOPULATE,
+    PERF_PHASE_COUNT
+};
+
+/// Hardware events counted during the phases
+enum perf_event_kind : uint8_t{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_EVENT_COUNT
+};
+
+/// size of the cache line used to estimate the memory traffic from the last level cache misses
+const uint64_t PERF_CACHE_LINE_SIZE = 64;
+
+/// Values of all events at one moment, scaled if the events were multiplexed
+struct perf_reading{
+    std::array<double, PERF_EVENT_COUNT> values {};
+};
+
+/// Events of one phase summed over all its executions
+struct perf_phase_totals{
+    std::array<double, PERF_EVENT_COUNT> events {};
+    /// count of processed data samples (entries or genomes)
+    uint64_t samples = 0;
+    size_t executions_count = 0;
+};
+
+/// Counts cycles, instructions, last level cache misses, branch misses and data TLB load misses of the whole process with Linux
+/// perf_event_open. Counters are inherited by the threads created after they were opened, so the work
+/// of the parallel phases is included. If the counters can't be opened (other platform, missing permissions,
+/// virtual machine) the measurement is silently skipped.
+class PerfCounters {
+
+public:
+    /// \return counters shared by the whole application
+    static PerfCounters& get_instance();
+
+    ~PerfCounters();
+
+    /// Opens the counters, events that are not supported by the hardware are left out
+    /// \return true if at least one event can be counted
+    bool enable();
+
+    [[nodiscard]] bool is_enabled() const{
+        return this->enabled;
+    }
+
+    /// \return current values of the events
+    [[nodiscard]] perf_reading read() const;
+
+    /// Adds the events counted between the readings to the phase
+    /// \param phase measured phase
+    /// \param begin reading at the start of the phase
+    /// \param end reading at the end of the phase
+    /// \param samples count of data samples processed by the phase
+    void add(perf_phase phase, const perf_reading& begin, const perf_reading& end, uint64_t samples);
+
+    /// Prints IPC, estimated memory traffic per sample and misses per sample of all measured phases
+    void report() const;
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+private:
+    PerfCounters();
+
+    bool enabled = false;
+    /// file descriptors of the events, -1 if the event isn't counted
+    std::array<int, PERF_EVENT_COUNT> descriptors {};
+    /// phases are measured from the main thread only, so the totals don't need any locking
+    std::array<perf_phase_totals, PERF_PHASE_COUNT> totals {};
+
+private:
+    /// \return printable name of the phase
+    static const char* get_phase_name(perf_phase phase);
+};
+
+/// Adds the events counted between its construction and destruction to the phase, does nothing if the counters
+/// are disabled
+class ScopedPerfSample {
+
+public:
+    explicit ScopedPerfSample(perf_phase phase, uint64_t samples = 0);
+
+    ~ScopedPerfSample();
+
+    /// Sets count of the processed samples if it isn't known at the start of the phase
+    void set_samples(uint64_t samples_count){
+        this->samples = samples_count;
+    }
+
+    ScopedPerfSample(const ScopedPerfSample&) = delete;
+    ScopedPerfSample& operator=(const ScopedPerfSample&) = delete;
+
+private:
+    const perf_phase phase;
+    uint64_t samples;
+    perf_reading begin;
+};
+
+
+#endif //OCL_TEST_PERFCOUNTERS_H
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "NumaTopology.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#define NUMA_SYSFS_NODES_DIR "/sys/devices/system/node"
+
+
+std::vector<unsigned> NumaTopology::parse_cpu_list(const std::string &cpu_list) {
+    std::vector<unsigned> cpus;
+    std::stringstream list_stream(cpu_list);
+    std::string range;
+    while(std::getline(list_stream, range, ',')){
+        if(range.empty() || !std::isdigit(static_cast<unsigned char>(range[0]))){
+            continue;
+        }
+        const auto dash = range.find('-');
+        const auto first = static_cast<unsigned>(std::stoul(range.substr(0, dash)));
+        const auto last = dash == std::string::npos ? first : static_cast<unsigned>(std::stoul(range.substr(dash + 1)));
+        for(unsigned cpu = first; cpu <= last; ++cpu){
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+std::vector<numa_node> NumaTopology::detect_nodes() {
+    std::vector<numa_node> nodes;
+#if defined(__linux__)
+    cpu_set_t allowed_cpus;
+    CPU_ZERO(&allowed_cpus);
+    const bool has_affinity = sched_getaffinity(0, sizeof(allowed_cpus), &allowed_cpus) == 0;
+
+    std::error_code fs_error;
+    for(const auto& entry: std::filesystem::directory_iterator(NUMA_SYSFS_NODES_DIR, fs_error)){
+        const std::string name = entry.path().filename().string();
+        if(name.compare(0, 4, "node") != 0 || name.size() == 4
+                || !std::all_of(name.begin() + 4, name.end(), [](char c){ return std::isdigit(c); })){
+            continue;
+        }
+        std::ifstream cpu_list_file(entry.path() / "cpulist");
+        std::string cpu_list;
+        if(!std::getline(cpu_list_file, cpu_list)){
+            continue;
+        }
+        numa_node node;
+        node.id = std::stoul(name.substr(4));
+        for(const auto cpu: parse_cpu_list(cpu_list)){
+            if(!has_affinity || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed_cpus))){
+                node.cpus.push_back(cpu);
+            }
+        }
+        //memory only nodes are skipped, they have no CPU that could touch their memory first
+        if(!node.cpus.empty()){
+            nodes.push_back(node);
+        }
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const numa_node& a, const numa_node& b){ return a.id < b.id; });
+#endif
+    if(nodes.empty()){
+        numa_node node;
+        const unsigned cpus_count = std::max(1u, std::thread::hardware_concurrency());
+        for(unsigned cpu = 0; cpu < cpus_count; ++cpu){
+            node.cpus.push_back(cpu);
+        }
+        nodes.push_back(node);
+    }
+    return nodes;
+}
+
+bool NumaTopology::pin_current_thread(const std::vector<unsigned> &cpus) {
+#if defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for(const auto cpu: cpus){
+        if(cpu < CPU_SETSIZE){
+            CPU_SET(cpu, &cpu_set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+    return false;
+#endif
+}
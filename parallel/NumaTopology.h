@@ -0,0 +1,36 @@
+#ifndef OCL_TEST_NUMATOPOLOGY_H
+#define OCL_TEST_NUMATOPOLOGY_H
+
+
+#include <string>
+#include <vector>
+
+/// Memory node and the CPUs attached to it
+struct numa_node{
+    size_t id = 0;
+    /// logical CPUs of the node this process is allowed to run on
+    std::vector<unsigned> cpus;
+};
+
+/// Reads the NUMA topology of the machine and pins threads to its CPUs. On Linux the nodes are read from
+/// sysfs, elsewhere (or if sysfs is not available) the whole machine is reported as one node without pinning.
+class NumaTopology {
+
+public:
+    /// \return nodes with at least one CPU usable by this process
+    static std::vector<numa_node> detect_nodes();
+
+    /// Restricts the calling thread to the CPUs, the memory it touches first is then allocated on their node
+    /// \param cpus CPUs the thread may run on
+    /// \return false if the thread could not be pinned
+    static bool pin_current_thread(const std::vector<unsigned>& cpus);
+
+private:
+    /// Parses the list of CPUs in the sysfs format (e.g. "0-3,8,10-11")
+    /// \param cpu_list list of CPUs
+    /// \return all listed CPUs
+    static std::vector<unsigned> parse_cpu_list(const std::string& cpu_list);
+};
+
+
+#endif //OCL_TEST_NUMATOPOLOGY_H
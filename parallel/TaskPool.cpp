@@ -0,0 +1,145 @@
+#include "TaskPool.h"
+
+/// set in the worker threads, their nested parallel calls are executed serially
+static thread_local bool is_pool_worker = false;
+/// set in the thread calling run while its job is running, so the tasks it executes don't lock the job again
+static thread_local bool is_running_job = false;
+
+
+TaskPool& TaskPool::get_instance() {
+    static TaskPool pool(std::max<unsigned>(1, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+TaskPool::TaskPool(size_t threads_count) {
+    for(size_t i = 0; i < threads_count; ++i){
+        this->queues.push_back(std::make_unique<task_queue>());
+    }
+    //the first queue belongs to the thread calling run
+    for(size_t i = 1; i < threads_count; ++i){
+        this->workers.emplace_back(&TaskPool::worker_loop, this, i);
+    }
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->wake_mutex);
+        this->stopping = true;
+    }
+    this->wake_condition.notify_all();
+    for(auto& worker: this->workers){
+        worker.join();
+    }
+}
+
+void TaskPool::run(size_t tasks_count, const std::function<void(size_t)> &task) {
+    if(is_pool_worker || is_running_job || this->workers.empty()){
+        for(size_t i = 0; i < tasks_count; ++i){
+            task(i);
+        }
+        return;
+    }
+    std::unique_lock<std::mutex> job_lock(this->job_mutex, std::try_to_lock);
+    if(!job_lock.owns_lock()){
+        for(size_t i = 0; i < tasks_count; ++i){
+            task(i);
+        }
+        return;
+    }
+    //the flag is cleared even when a task exception is rethrown
+    struct running_job_flag{
+        running_job_flag(){ is_running_job = true; }
+        ~running_job_flag(){ is_running_job = false; }
+    } running_flag;
+
+    pool_job job;
+    job.task = &task;
+    job.remaining = tasks_count;
+
+    //every thread gets contiguous block of the tasks, so the neighbouring parts of the data stay on one core
+    const size_t queues_count = this->queues.size();
+    for(size_t q = 0; q < queues_count; ++q){
+        auto& queue = *this->queues[q];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        for(size_t i = tasks_count * q / queues_count; i < tasks_count * (q + 1) / queues_count; ++i){
+            queue.tasks.push_back({&job, i});
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->wake_mutex);
+        ++this->job_generation;
+    }
+    this->wake_condition.notify_all();
+
+    pool_task current;
+    while(job.remaining.load(std::memory_order_acquire) > 0){
+        if(take_task(0, current)){
+            execute(current);
+        }else{
+            //the last tasks are being finished by the workers
+            std::this_thread::yield();
+        }
+    }
+    if(job.error){
+        std::rethrow_exception(job.error);
+    }
+}
+
+void TaskPool::worker_loop(size_t queue_index) {
+    is_pool_worker = true;
+    uint64_t seen_generation = 0;
+    pool_task current;
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(this->wake_mutex);
+            this->wake_condition.wait(lock, [&](){
+                return this->stopping || this->job_generation != seen_generation;
+            });
+            if(this->stopping){
+                return;
+            }
+            seen_generation = this->job_generation;
+        }
+        while(take_task(queue_index, current)){
+            execute(current);
+        }
+    }
+}
+
+bool TaskPool::take_task(size_t queue_index, pool_task &task) {
+    {
+        auto& own_queue = *this->queues[queue_index];
+        std::lock_guard<std::mutex> lock(own_queue.mutex);
+        if(!own_queue.tasks.empty()){
+            task = own_queue.tasks.back();
+            own_queue.tasks.pop_back();
+            return true;
+        }
+    }
+    const size_t queues_count = this->queues.size();
+    for(size_t offset = 1; offset < queues_count; ++offset){
+        auto& victim_queue = *this->queues[(queue_index + offset) % queues_count];
+        std::lock_guard<std::mutex> lock(victim_queue.mutex);
+        if(!victim_queue.tasks.empty()){
+            task = victim_queue.tasks.front();
+            victim_queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskPool::execute(const pool_task &task) {
+    if(!task.job->failed.load(std::memory_order_acquire)){
+        try{
+            (*task.job->task)(task.index);
+        } catch (...) {
+            //only the first exception is kept, it is published by the release of the remaining counter
+            if(!task.job->failed.exchange(true, std::memory_order_acq_rel)){
+                task.job->error = std::current_exception();
+            }
+        }
+    }
+    //the job may be destroyed by its caller right after the last decrement
+    task.job->remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
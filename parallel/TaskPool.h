@@ -0,0 +1,194 @@
+#ifndef OCL_TEST_TASKPOOL_H
+#define OCL_TEST_TASKPOOL_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// count of tasks every thread gets in one parallel loop, more tasks than threads let the idle ones steal
+const size_t TASKS_PER_THREAD = 8;
+
+/// ranges smaller than this are not split, the task overhead would be greater than the work
+const size_t DEFAULT_PARALLEL_GRAIN = 4096;
+
+/// Pool of worker threads executing indexed tasks. Every thread owns a queue of task indices, it takes
+/// the tasks from the back of its queue and when it's empty it steals from the front of the other queues.
+/// The calling thread works on the tasks too, so the pool has hardware concurrency - 1 workers.
+class TaskPool {
+
+public:
+    /// \return pool shared by the whole application
+    static TaskPool& get_instance();
+
+    ~TaskPool();
+
+    /// \return count of threads executing the tasks including the calling one
+    [[nodiscard]] size_t get_threads_count() const { return this->queues.size(); }
+
+    /// Executes task(i) for every i in [0, tasks_count) and waits until all tasks are done. Calls from
+    /// the tasks or while another job is running are executed serially by the calling thread. If any task
+    /// throws, the remaining tasks are skipped and the first exception is rethrown here.
+    /// \param tasks_count count of tasks
+    /// \param task task called with the task index
+    void run(size_t tasks_count, const std::function<void(size_t)>& task);
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+private:
+    explicit TaskPool(size_t threads_count);
+
+    /// Tasks of one run call, it lives on the stack of the calling thread until all tasks are done
+    struct pool_job{
+        const std::function<void(size_t)>* task = nullptr;
+        std::atomic<size_t> remaining {0};
+        /// set by the first failed task, the following tasks are only marked as done
+        std::atomic<bool> failed {false};
+        std::exception_ptr error;
+    };
+
+    struct pool_task{
+        pool_job* job = nullptr;
+        size_t index = 0;
+    };
+
+    /// queues are aligned to the cache line so the threads don't invalidate each other's locks
+    struct alignas(64) task_queue{
+        std::mutex mutex;
+        std::deque<pool_task> tasks;
+    };
+
+    std::vector<std::unique_ptr<task_queue>> queues;
+    std::vector<std::thread> workers;
+
+    /// only one job runs at once, nested or concurrent calls run serially
+    std::mutex job_mutex;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake_condition;
+    /// incremented with every new job so that the workers know there is something to steal
+    uint64_t job_generation = 0;
+    bool stopping = false;
+
+private:
+    /// Main loop of the worker owning the queue
+    void worker_loop(size_t queue_index);
+
+    /// Takes task from the back of own queue or steals it from the front of another queue
+    /// \param queue_index index of the queue of the calling thread
+    /// \param task output task
+    /// \return false if all queues are empty
+    bool take_task(size_t queue_index, pool_task& task);
+
+    /// Executes the task and marks it as done, exception of the task is stored into its job
+    static void execute(const pool_task& task);
+};
+
+/// Splits the range into tasks of at least grain size
+/// \return count of tasks
+inline size_t get_parallel_tasks_count(size_t range_size, size_t grain){
+    const size_t max_tasks = TaskPool::get_instance().get_threads_count() * TASKS_PER_THREAD;
+    return std::max<size_t>(1, std::min(max_tasks, range_size / std::max<size_t>(1, grain)));
+}
+
+/// Splits the range into contiguous parts and calls body(part_begin, part_end) for every part on all threads
+/// of the task pool
+/// \param begin first index
+/// \param end index after the last one
+/// \param body function called with the bounds of every part
+/// \param grain minimal count of indices in one part
+template<class Body>
+void parallel_for_ranges(size_t begin, size_t end, const Body& body, size_t grain = DEFAULT_PARALLEL_GRAIN){
+    if(end <= begin){
+        return;
+    }
+    const size_t range_size = end - begin;
+    const size_t tasks_count = get_parallel_tasks_count(range_size, grain);
+    if(tasks_count == 1){
+        body(begin, end);
+        return;
+    }
+    TaskPool::get_instance().run(tasks_count, [&](size_t task){
+        body(begin + range_size * task / tasks_count, begin + range_size * (task + 1) / tasks_count);
+    });
+}
+
+/// Calls body(i) for every i in [begin, end) on all threads of the task pool. Every task iterates over
+/// a contiguous part of the range, so the body is inlined into the loop and can be vectorized
+/// \param begin first index
+/// \param end index after the last one
+/// \param body function called with every index
+/// \param grain minimal count of indices in one task
+template<class Body>
+void parallel_for(size_t begin, size_t end, const Body& body, size_t grain = DEFAULT_PARALLEL_GRAIN){
+    parallel_for_ranges(begin, end, [&](size_t part_begin, size_t part_end){
+        for(size_t i = part_begin; i < part_end; ++i){
+            body(i);
+        }
+    }, grain);
+}
+
+/// Reduces contiguous parts of the range on all threads of the task pool, the partial results are combined
+/// in the order of the parts, so the result doesn't depend on the scheduling
+/// \param begin first index
+/// \param end index after the last one
+/// \param identity result of an empty range
+/// \param body function returning the result of the part body(part_begin, part_end)
+/// \param combine function returning combination of two partial results
+/// \param grain minimal count of indices in one part
+/// \return combined result
+template<class T, class Body, class Combine>
+T parallel_reduce_ranges(size_t begin, size_t end, const T& identity, const Body& body, const Combine& combine,
+                         size_t grain = DEFAULT_PARALLEL_GRAIN){
+    if(end <= begin){
+        return identity;
+    }
+    const size_t range_size = end - begin;
+    const size_t tasks_count = get_parallel_tasks_count(range_size, grain);
+    if(tasks_count == 1){
+        return body(begin, end);
+    }
+    std::vector<T> partials(tasks_count, identity);
+    TaskPool::get_instance().run(tasks_count, [&](size_t task){
+        partials[task] = body(begin + range_size * task / tasks_count, begin + range_size * (task + 1) / tasks_count);
+    });
+
+    T result = partials[0];
+    for(size_t task = 1; task < tasks_count; ++task){
+        result = combine(result, partials[task]);
+    }
+    return result;
+}
+
+/// Reduces the range on all threads of the task pool, every part accumulates its indices into its own
+/// partial result
+/// \param begin first index
+/// \param end index after the last one
+/// \param identity initial value of every partial result
+/// \param body function called as body(i, partial) for every index
+/// \param combine function returning combination of two partial results
+/// \param grain minimal count of indices in one task
+/// \return combined result
+template<class T, class Body, class Combine>
+T parallel_reduce(size_t begin, size_t end, const T& identity, const Body& body, const Combine& combine,
+                  size_t grain = DEFAULT_PARALLEL_GRAIN){
+    return parallel_reduce_ranges(begin, end, identity, [&](size_t part_begin, size_t part_end){
+        T partial = identity;
+        for(size_t i = part_begin; i < part_end; ++i){
+            body(i, partial);
+        }
+        return partial;
+    }, combine, grain);
+}
+
+
+#endif //OCL_TEST_TASKPOOL_H
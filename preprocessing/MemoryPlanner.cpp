@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include "MemoryPlanner.h"
+#include "Preprocessor.h"
+#include "../utils.h"
+#include "../visualization/DensityHistogram.h"
+
+/// bytes of the four double columns of one entry
+const size_t DOUBLE_COLUMNS_ENTRY_BYTES = 4 * sizeof(double);
+/// bytes of the four 16 bit codes of one entry
+const size_t COMPRESSED_COLUMNS_ENTRY_BYTES = 4 * sizeof(int16_t);
+/// transformed value of the best genome held at the end of the run and the bins of the plot threads,
+/// the plot starts a thread grid only for every grid sized block of entries
+const size_t PLOT_ENTRY_BYTES = sizeof(double) + sizeof(uint32_t);
+/// hr decoded from the compressed column for the plot
+const size_t DECODED_HR_ENTRY_BYTES = sizeof(double);
+/// both stream slots of the device run are allocated at once
+const size_t STREAM_SLOTS_COUNT = 2;
+/// typical acc line held by the line buffers of the load, its text and the string itself
+const size_t ACC_LINE_BUFFER_BYTES = 48 + sizeof(std::string);
+/// the parallel positional load holds the whole acc file as strings, their headers about double its size
+const size_t POSITIONAL_BUFFER_FILE_FACTOR = 2;
+
+
+size_t MemoryPlanner::parse_memory_size(const std::string &text) {
+    size_t suffix_index = 0;
+    const auto value = std::stoull(text, &suffix_index);
+    const auto suffix = text.substr(suffix_index);
+    if(suffix.empty() || suffix == "B" || suffix == "b"){
+        return value;
+    }
+    int shift;
+    switch(suffix[0]){
+        case 'K': case 'k':
+            shift = 10;
+            break;
+        case 'M': case 'm':
+            shift = 20;
+            break;
+        case 'G': case 'g':
+            shift = 30;
+            break;
+        default:
+            throw std::invalid_argument("Unknown memory size suffix " + suffix);
+    }
+    if(value > (std::numeric_limits<size_t>::max() >> shift)){
+        throw std::out_of_range("Memory size " + text + " is too large");
+    }
+    return value << shift;
+}
+
+memory_plan MemoryPlanner::create_plan(const input_parameters &params) {
+    memory_plan plan {};
+    plan.memory_limit = params.memory_limit;
+    plan.storage = params.compressed_columns && !params.parallel ? STORAGE_COMPRESSED : STORAGE_DOUBLE;
+    plan.stream_chunk_size = params.stream_chunk_size;
+    if(params.memory_limit == 0){
+        return plan;
+    }
+
+    plan.predicted_entries = Preprocessor::predict_entries_count(params.input_folder);
+    const size_t reserve = (params.parallel ? DEVICE_MEMORY_RESERVE_BYTES : MEMORY_RESERVE_BYTES)
+                           + get_buffer_bytes(params);
+    const size_t available_bytes = params.memory_limit > reserve ? params.memory_limit - reserve : 0;
+    if(params.parallel){
+        plan_device_run(plan, available_bytes, params);
+    }else{
+        plan_serial_run(plan, available_bytes, params);
+    }
+    plan.estimated_peak_bytes += reserve;
+    if(plan.estimated_peak_bytes > plan.memory_limit){
+        //at least one vector of entries is always loaded
+        std::cerr << "Warning: the memory limit can't be met, the run needs about "
+                  << plan.estimated_peak_bytes / (1024 * 1024) << " MB!" << std::endl;
+    }
+
+    if(plan.max_entries > 0 && params.positional_pairing){
+        //positional pairing writes all entries of the files, only the join can stop at the capacity
+        std::cerr << "Warning: the input doesn't fit into the memory limit and the entries can't be limited "
+                     "with the positional pairing!" << std::endl;
+        plan.max_entries = 0;
+    }
+    return plan;
+}
+
+size_t MemoryPlanner::get_buffer_bytes(const input_parameters &params) {
+    //the plot bins into its own grid besides the grids of the threads
+    const size_t plot_bytes = PLOT_BINS * PLOT_BINS * sizeof(uint32_t);
+    if(!params.positional_pairing){
+        return plot_bytes + ACC_JOIN_BLOCK_LINES * (ACC_LINE_BUFFER_BYTES + sizeof(acc_sample));
+    }
+    if(params.parallel){
+        //the parallel positional load buffers all lines of the acc file before parsing them
+        const auto acc_file_size = Preprocessor::get_largest_acc_file_size(params.input_folder);
+        return plot_bytes + POSITIONAL_BUFFER_FILE_FACTOR * acc_file_size;
+    }
+    //serial positional load parses the lines one by one
+    return plot_bytes;
+}
+
+size_t MemoryPlanner::get_serial_entry_bytes(column_storage storage, const input_parameters &params) {
+    //NUMA workers hold node local copy of the columns besides the loaded ones
+    const size_t copy_factor = params.numa ? 2 : 1;
+    switch(storage){
+        case STORAGE_DOUBLE:
+            return copy_factor * DOUBLE_COLUMNS_ENTRY_BYTES + PLOT_ENTRY_BYTES;
+        case STORAGE_COMPRESSED:
+            //the doubles are released one by one while encoding, the plot needs decoded hr at the end
+            return std::max(DOUBLE_COLUMNS_ENTRY_BYTES + sizeof(int16_t),
+                            copy_factor * COMPRESSED_COLUMNS_ENTRY_BYTES + PLOT_ENTRY_BYTES + DECODED_HR_ENTRY_BYTES);
+        case STORAGE_STREAMED:
+        default:
+            return copy_factor * COMPRESSED_COLUMNS_ENTRY_BYTES + PLOT_ENTRY_BYTES + DECODED_HR_ENTRY_BYTES;
+    }
+}
+
+void MemoryPlanner::plan_serial_run(memory_plan &plan, size_t available_bytes, const input_parameters &params) {
+    std::vector<column_storage> candidates {STORAGE_DOUBLE, STORAGE_COMPRESSED, STORAGE_STREAMED};
+    if(params.compressed_columns){
+        candidates.erase(candidates.begin());
+    }
+    if(params.positional_pairing){
+        //streamed load is done only by the join
+        candidates.pop_back();
+    }
+
+    //the most precise storage that fits is used, otherwise the smallest one with less entries
+    plan.storage = candidates.back();
+    for(const auto storage: candidates){
+        if(get_serial_entry_bytes(storage, params) * plan.predicted_entries <= available_bytes){
+            plan.storage = storage;
+            break;
+        }
+    }
+    const size_t entry_bytes = get_serial_entry_bytes(plan.storage, params);
+    size_t entries = plan.predicted_entries;
+    if(entry_bytes * entries > available_bytes){
+        entries = available_bytes / entry_bytes;
+        entries -= entries % VECTOR_SIZE;
+        plan.max_entries = std::max<size_t>(VECTOR_SIZE, entries);
+        entries = plan.max_entries;
+    }
+    plan.estimated_peak_bytes = entry_bytes * entries;
+}
+
+void MemoryPlanner::plan_device_run(memory_plan &plan, size_t available_bytes, const input_parameters &params) {
+    //host keeps the double columns for the upload and the transformation for the plot
+    const size_t host_entry_bytes = DOUBLE_COLUMNS_ENTRY_BYTES + PLOT_ENTRY_BYTES;
+    //buffers of the devices sharing the host memory (CPU devices) are mapped onto the columns only with zero copy
+    const size_t device_entry_bytes = params.zero_copy ? 0 : DOUBLE_COLUMNS_ENTRY_BYTES;
+    const size_t chunk_entry_bytes = STREAM_SLOTS_COUNT * DOUBLE_COLUMNS_ENTRY_BYTES;
+    //device GA and hybrid runs keep the whole slices resident
+    const bool can_stream = !params.device_ga && !params.hybrid;
+
+    size_t entries = plan.predicted_entries;
+    if((host_entry_bytes + device_entry_bytes) * entries <= available_bytes){
+        plan.estimated_peak_bytes = (host_entry_bytes + device_entry_bytes) * entries;
+        return;
+    }
+    if(!can_stream){
+        entries = available_bytes / (host_entry_bytes + device_entry_bytes);
+        entries -= entries % VECTOR_SIZE;
+        plan.max_entries = std::max<size_t>(VECTOR_SIZE, entries);
+        plan.estimated_peak_bytes = (host_entry_bytes + device_entry_bytes) * plan.max_entries;
+        return;
+    }
+
+    //chunks get the memory left after the host columns, with less than the minimal chunk the entries are limited
+    const size_t min_chunks_bytes = chunk_entry_bytes * MIN_STREAM_CHUNK_ENTRIES;
+    if(host_entry_bytes * entries + min_chunks_bytes > available_bytes){
+        entries = available_bytes > min_chunks_bytes ? (available_bytes - min_chunks_bytes) / host_entry_bytes : 0;
+        entries -= entries % VECTOR_SIZE;
+        plan.max_entries = std::max<size_t>(VECTOR_SIZE, entries);
+        entries = plan.max_entries;
+    }
+    size_t chunk_entries = (available_bytes - std::min(available_bytes, host_entry_bytes * entries)) / chunk_entry_bytes;
+    chunk_entries = std::max<size_t>(MIN_STREAM_CHUNK_ENTRIES, chunk_entries);
+    if(params.stream_chunk_size > 0){
+        chunk_entries = std::min(chunk_entries, params.stream_chunk_size);
+    }
+    plan.stream_chunk_size = chunk_entries;
+    plan.estimated_peak_bytes = host_entry_bytes * entries + chunk_entry_bytes * chunk_entries;
+}
+
+void MemoryPlanner::print_plan(const memory_plan &plan) {
+    if(plan.memory_limit == 0){
+        return;
+    }
+    const double megabyte = 1024.0 * 1024.0;
+    const char* storage_names[] = {"double columns", "compressed columns", "streamed compressed columns"};
+    std::cout << TEXT_SEPARATOR << std::endl;
+    std::cout << "Memory plan:" << std::endl;
+    std::cout << "Memory limit: " << static_cast<double>(plan.memory_limit) / megabyte << " MB" << std::endl;
+    std::cout << "Predicted entries: " << plan.predicted_entries << std::endl;
+    std::cout << "Storage: " << storage_names[plan.storage] << std::endl;
+    if(plan.max_entries > 0){
+        std::cout << "Loaded entries limited to: " << plan.max_entries << std::endl;
+    }
+    if(plan.stream_chunk_size > 0){
+        std::cout << "Stream chunk size: " << plan.stream_chunk_size << std::endl;
+    }
+    std::cout << "Estimated peak: " << static_cast<double>(plan.estimated_peak_bytes) / megabyte << " MB" << std::endl;
+    std::cout << TEXT_SEPARATOR << std::endl;
+}
@@ -0,0 +1,80 @@
+#ifndef OCL_TEST_MEMORYPLANNER_H
+#define OCL_TEST_MEMORYPLANNER_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct input_parameters;
+
+/// memory kept free for the code, the runtime and the populations
+#define MEMORY_RESERVE_BYTES (32ull * 1024 * 1024)
+/// openCL runtimes and the compiled programs need more memory than the serial run
+#define DEVICE_MEMORY_RESERVE_BYTES (256ull * 1024 * 1024)
+
+/// streamed chunks smaller than this would spend more time by the upload overhead than by the evaluation
+#define MIN_STREAM_CHUNK_ENTRIES 65536
+
+/// How the input columns are held in the memory, ordered from the most precise
+enum column_storage : uint8_t{
+    /// four normalized double columns
+    STORAGE_DOUBLE,
+    /// double columns loaded first and then encoded into 16 bit codes one by one
+    STORAGE_COMPRESSED,
+    /// files are joined twice, the first pass finds the ranges and the second one encodes the codes directly,
+    /// so the double columns are never allocated
+    STORAGE_STREAMED
+};
+
+/// Plan of the memory usage of the run fitting into the memory limit
+struct memory_plan{
+    /// limit in bytes, 0 if the memory is not limited
+    size_t memory_limit = 0;
+    /// count of entries predicted from the sizes of the input files
+    size_t predicted_entries = 0;
+    /// maximal count of loaded entries, 0 if all entries are loaded
+    size_t max_entries = 0;
+    column_storage storage = STORAGE_DOUBLE;
+    /// count of entries in one streamed chunk of the device run, 0 if the data stay resident
+    size_t stream_chunk_size = 0;
+    /// predicted peak of the resident memory
+    size_t estimated_peak_bytes = 0;
+};
+
+/// Chooses the column precision, streaming and count of loaded entries so that the run fits into the memory
+/// limit. Needed bytes are estimated from the sizes of the input files and the bytes every phase of the run
+/// holds per entry, the most precise variant that fits is used.
+class MemoryPlanner {
+
+public:
+    /// Parses memory size with optional K, M or G suffix (powers of 1024)
+    /// \param text size like 512M
+    /// \return size in bytes, std::out_of_range is thrown if it doesn't fit into size_t
+    static size_t parse_memory_size(const std::string& text);
+
+    /// Creates the plan of the run, if the memory is not limited all entries are loaded with the storage
+    /// requested by the parameters
+    /// \param params parameters of the run
+    /// \return plan of the run
+    static memory_plan create_plan(const input_parameters& params);
+
+    static void print_plan(const memory_plan& plan);
+
+private:
+    /// \param params parameters of the run
+    /// \return bytes of the line buffers of the load and the grid of the plot, which don't depend on the entries
+    static size_t get_buffer_bytes(const input_parameters& params);
+
+    /// \param storage storage of the columns
+    /// \param params parameters of the run
+    /// \return peak of the bytes held per one entry during the serial run
+    static size_t get_serial_entry_bytes(column_storage storage, const input_parameters& params);
+
+    static void plan_serial_run(memory_plan& plan, size_t available_bytes, const input_parameters& params);
+
+    static void plan_device_run(memory_plan& plan, size_t available_bytes, const input_parameters& params);
+};
+
+
+#endif //OCL_TEST_MEMORYPLANNER_H
@@ -0,0 +1,211 @@
+#ifndef OCL_TEST_PAGEALLOCATOR_H
+#define OCL_TEST_PAGEALLOCATOR_H
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <map>
+#include <mutex>
+
+//older headers don't define the size flags, the size is encoded as log2 of the page size
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#endif
+
+#define PAGE_SIZE_BYTES 4096
+
+/// size of allocations is rounded up to this value (needed by openCL runtimes to share the memory without copy)
+#define ALLOCATION_SIZE_GRANULARITY 64
+
+/// size of the huge page, allocations of at least this size are mapped directly when the huge pages are enabled
+#define HUGE_PAGE_SIZE_BYTES (2 * 1024 * 1024)
+
+#define TRANSPARENT_HUGE_PAGES_FILE "/sys/kernel/mm/transparent_hugepage/enabled"
+
+/// Maps the big data columns directly from the system when the huge pages are enabled. Explicit 2 MB huge
+/// pages (MAP_HUGETLB) are tried first, then the mapping is aligned to the huge page and advised to be backed
+/// by transparent huge pages, and if neither is available the normal pages are used. Sizes of the mappings
+/// are kept, so the columns are unmapped exactly and the allocations made with disabled huge pages are told
+/// apart. Only Linux is supported, elsewhere the columns are always allocated with normal pages.
+class HugePages {
+
+public:
+    static void set_enabled(bool enabled){
+        huge_pages_enabled = enabled;
+    }
+
+    [[nodiscard]] static bool is_enabled(){
+        return huge_pages_enabled;
+    }
+
+#if defined(__linux__)
+    /// Maps the memory of the passed size, the huge pages have to be enabled
+    /// \param bytes size of the memory rounded up to the huge page size
+    /// \return page aligned memory
+    static void* allocate(std::size_t bytes){
+        void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+        if(memory != MAP_FAILED){
+            explicit_bytes += bytes;
+            return add_mapping(memory, bytes);
+        }
+        //there are no reserved huge pages, the mapping is aligned so the kernel can use transparent ones
+        auto* mapping = static_cast<char*>(mmap(nullptr, bytes + HUGE_PAGE_SIZE_BYTES, PROT_READ | PROT_WRITE,
+                                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if(mapping == MAP_FAILED){
+            throw std::bad_alloc();
+        }
+        const auto address = reinterpret_cast<std::uintptr_t>(mapping);
+        const std::size_t head = (HUGE_PAGE_SIZE_BYTES - address % HUGE_PAGE_SIZE_BYTES) % HUGE_PAGE_SIZE_BYTES;
+        if(head > 0){
+            munmap(mapping, head);
+        }
+        munmap(mapping + head + bytes, HUGE_PAGE_SIZE_BYTES - head);
+        if(is_transparent_available() && madvise(mapping + head, bytes, MADV_HUGEPAGE) == 0){
+            transparent_bytes += bytes;
+        }else{
+            normal_bytes += bytes;
+        }
+        return add_mapping(mapping + head, bytes);
+    }
+
+    /// Unmaps the memory if it was mapped by allocate
+    /// \param memory allocated memory
+    /// \return false if the memory was not mapped here
+    static bool deallocate(void* memory) noexcept{
+        std::size_t bytes;
+        {
+            std::lock_guard<std::mutex> lock(mappings_mutex);
+            const auto mapping = mappings.find(memory);
+            if(mapping == mappings.end()){
+                return false;
+            }
+            bytes = mapping->second;
+            mappings.erase(mapping);
+        }
+        munmap(memory, bytes);
+        return true;
+    }
+#endif
+
+    /// Prints how the mapped columns are backed, nothing is printed if the huge pages are disabled
+    static void print_usage(){
+        if(!huge_pages_enabled){
+            return;
+        }
+#if defined(__linux__)
+        const double megabyte = 1024.0 * 1024.0;
+        std::cout << "Huge pages: " << static_cast<double>(explicit_bytes) / megabyte << " MB explicit, "
+                  << static_cast<double>(transparent_bytes) / megabyte << " MB transparent, "
+                  << static_cast<double>(normal_bytes) / megabyte << " MB in normal pages" << std::endl;
+#else
+        std::cout << "Huge pages are supported only on Linux, the columns use normal pages" << std::endl;
+#endif
+    }
+
+private:
+    static inline bool huge_pages_enabled = false;
+
+    /// mapped bytes according to their backing, the columns may be allocated from multiple threads
+    static inline std::atomic<std::size_t> explicit_bytes {0};
+    static inline std::atomic<std::size_t> transparent_bytes {0};
+    static inline std::atomic<std::size_t> normal_bytes {0};
+
+#if defined(__linux__)
+    /// sizes of the live mappings, there are only few of them as only the big columns are mapped
+    static inline std::map<void*, std::size_t> mappings;
+    static inline std::mutex mappings_mutex;
+#endif
+
+private:
+#if defined(__linux__)
+    static void* add_mapping(void* memory, std::size_t bytes){
+        std::lock_guard<std::mutex> lock(mappings_mutex);
+        mappings.emplace(memory, bytes);
+        return memory;
+    }
+#endif
+
+    /// \return false if the transparent huge pages are disabled in the system
+    static bool is_transparent_available(){
+        static const bool available = [](){
+            std::ifstream settings(TRANSPARENT_HUGE_PAGES_FILE);
+            std::string line;
+            return std::getline(settings, line) && line.find("[never]") == std::string::npos;
+        }();
+        return available;
+    }
+};
+
+/// Allocator returning page aligned memory, so that the data can be used by openCL devices
+/// with CL_MEM_USE_HOST_PTR without any copy. Big allocations are mapped by HugePages if they are enabled.
+template <class T>
+struct page_allocator{
+    typedef T value_type;
+
+    page_allocator() noexcept = default;
+
+    template <class U>
+    page_allocator(const page_allocator<U>&) noexcept{ // NOLINT(google-explicit-constructor)
+    }
+
+    T* allocate(std::size_t count){
+#if defined(__linux__)
+        if(HugePages::is_enabled() && count * sizeof(T) >= HUGE_PAGE_SIZE_BYTES){
+            return static_cast<T*>(HugePages::allocate(get_huge_allocation_size(count)));
+        }
+#endif
+        return static_cast<T*>(::operator new(get_allocation_size(count), std::align_val_t(PAGE_SIZE_BYTES)));
+    }
+
+    void deallocate(T* pointer, std::size_t count) noexcept{
+#if defined(__linux__)
+        //the huge pages may be enabled after the allocation, so the mapped memory is looked up
+        if(count * sizeof(T) >= HUGE_PAGE_SIZE_BYTES && HugePages::deallocate(pointer)){
+            return;
+        }
+#endif
+        ::operator delete(pointer, get_allocation_size(count), std::align_val_t(PAGE_SIZE_BYTES));
+    }
+
+    template <class U>
+    bool operator==(const page_allocator<U>&) const noexcept{
+        return true;
+    }
+
+    template <class U>
+    bool operator!=(const page_allocator<U>&) const noexcept{
+        return false;
+    }
+
+private:
+    static std::size_t get_allocation_size(std::size_t count){
+        const std::size_t bytes = count * sizeof(T);
+        return (bytes + ALLOCATION_SIZE_GRANULARITY - 1) / ALLOCATION_SIZE_GRANULARITY * ALLOCATION_SIZE_GRANULARITY;
+    }
+
+    /// the untouched tail of the last huge page is not backed by memory when the normal pages are used
+    static std::size_t get_huge_allocation_size(std::size_t count){
+        const std::size_t bytes = count * sizeof(T);
+        return (bytes + HUGE_PAGE_SIZE_BYTES - 1) / HUGE_PAGE_SIZE_BYTES * HUGE_PAGE_SIZE_BYTES;
+    }
+};
+
+/// vector type used for all big data columns
+typedef std::vector<double, page_allocator<double>> data_vector;
+
+
+#endif //OCL_TEST_PAGEALLOCATOR_H
@@ -5,10 +5,11 @@
 
 #include "ParallelPreprocessor.h"
 #include "../utils.h"
+#include "../parallel/TaskPool.h"
+#include "../simd/SimdDispatch.h"
 #include <fstream>
-#include <ppl.h>
 #include <iostream>
-#include <execution>
+#include <limits>
 
 void ParallelPreprocessor::load_hr_file_content(const std::shared_ptr<input_data> &result, std::ifstream &file) const {
     Preprocessor::load_hr_file_content(result, file);
@@ -48,9 +49,9 @@ void ParallelPreprocessor::load_acc_file_content(const std::shared_ptr<input_dat
     auto& z_input = result->acc_z->values;
     //now we can start saving some data
     const size_t data_start_index = result->acc_date_end_index + 1;
-    std::for_each(std::execution::par,begin(all_lines), end(all_lines),
-                  [&](const acc_minute_sample& sample){
-
+    //lines are parsed in tasks of whole seconds, parsing one second is already expensive enough
+    parallel_for(0, entry_count, [&](size_t sample_index){
+        const auto& sample = all_lines[sample_index];
         double x_result = 0;
         double y_result = 0;
         double z_result = 0;
@@ -69,32 +70,44 @@ void ParallelPreprocessor::load_acc_file_content(const std::shared_ptr<input_dat
         x_input[offset + sample.index] = x_result;
         y_input[offset + sample.index] = y_result;
         z_input[offset + sample.index] = z_result;
-    });
+    }, 1);
 
     result->acc_entries_count += entry_count - entry_count % VECTOR_SIZE;
     std::cout << "Loaded " << entry_count << " entries from acc file" << std::endl;
 }
 
+void ParallelPreprocessor::parse_acc_lines(const std::vector<std::string> &lines, std::vector<acc_sample> &samples,
+                                           size_t count) const {
+    //the join reads the lines serially, the parsing of the block is split between the threads
+    parallel_for(0, count, [&](size_t i){
+        samples[i] = parse_acc_line(lines[i]);
+    }, 1024);
+}
+
 void ParallelPreprocessor::norm_input_vector(const std::unique_ptr<input_vector> &input) const {
     auto max = input->max;
     auto min = input->min;
     auto& arr = input->values;
     const size_t count = arr.size();
     const auto scope = (max - min);
-    #pragma loop(hint_parallel(VECTOR_SIZE_MACRO))
-    for(size_t i = 0; i < count; ++i){
-        auto value = arr[i];
-        arr[i] = (value - min) / scope;
-    }
+    const auto& kernels = SimdDispatch::get_kernels();
+    parallel_for_ranges(0, count, [&](size_t begin, size_t end){
+        kernels.normalize(arr.data() + begin, end - begin, min, scope);
+    });
 }
 
 void ParallelPreprocessor::find_min_max(const std::unique_ptr<input_vector> &input) const {
-    const auto values = input->values;
-    const auto [min, max]
-                                    = std::minmax_element(values.begin(), values.end());
+    const auto& values = input->values;
+    const auto& kernels = SimdDispatch::get_kernels();
+    const simd_min_max empty_range {std::numeric_limits<double>::max(), -std::numeric_limits<double>::max()};
+    const auto [min, max] = parallel_reduce_ranges(0, values.size(), empty_range, [&](size_t begin, size_t end){
+        return kernels.min_max(values.data() + begin, end - begin);
+    }, [](const simd_min_max& a, const simd_min_max& b){
+        return simd_min_max {std::min(a.min, b.min), std::max(a.max, b.max)};
+    });
 
-    input->min = *min;
-    input->max = *max;
+    input->min = min;
+    input->max = max;
 }
 
 void ParallelPreprocessor::preprocess_acc_vectors(const std::shared_ptr<input_data> &result,
@@ -109,10 +122,10 @@ void ParallelPreprocessor::preprocess_acc_vectors(const std::shared_ptr<input_da
     }
 
     const auto count = result->acc_entries_count;
-#pragma loop(hint_parallel(VECTOR_SIZE_MACRO))
-    for(size_t i = current_offset; i < count; ++i){
-        x_input[i] /= sampling_rate;
-        y_input[i] /= sampling_rate;
-        z_input[i] /= sampling_rate;
-    }
+    const auto& kernels = SimdDispatch::get_kernels();
+    //sums of the samples are averaged
+    parallel_for_ranges(current_offset, count, [&](size_t begin, size_t end){
+        kernels.divide_columns(x_input.data() + begin, y_input.data() + begin, z_input.data() + begin,
+                               end - begin, sampling_rate);
+    });
 }
@@ -22,7 +22,9 @@ public:
 class ParallelPreprocessor : public Preprocessor {
 
 public:
-    explicit ParallelPreprocessor(const std::string& input_folder): Preprocessor(input_folder){};
+    explicit ParallelPreprocessor(const std::string& input_folder, bool compress_columns = false,
+                                  bool positional_pairing = false)
+                                    : Preprocessor(input_folder, compress_columns, positional_pairing){};
 
     void find_min_max(const std::unique_ptr<input_vector> &input) const override;
 
@@ -34,6 +36,9 @@ protected:
 
     void load_hr_file_content(const std::shared_ptr<input_data> &result, std::ifstream &file) const override;
 
+    void parse_acc_lines(const std::vector<std::string>& lines, std::vector<acc_sample>& samples,
+                         size_t count) const override;
+
     void norm_input_vector(const std::unique_ptr<input_vector> &input) const override;
 };
 
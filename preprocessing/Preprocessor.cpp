@@ -2,23 +2,38 @@
 // Created by pulta on 23.10.2023.
 //
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <sstream>
-#include <ppl.h>
 #include <limits>
 #include <filesystem>
 #include <stack>
 #include <utility>
-#include <execution>
 #include "Preprocessor.h"
 #include "../utils.h"
+#include "../metrics/MetricsRegistry.h"
+#include "../metrics/PerfCounters.h"
+#include "../simd/SimdDispatch.h"
+
+/// count of steps between the min and max of the compressed column
+const double COMPRESSED_CODE_RANGE = 65535.0;
+/// the signed ACC codes are shifted so that the min is encoded as the lowest int16 value
+const double COMPRESSED_ACC_CODE_SHIFT = 32768.0;
 
 
 bool Preprocessor::load_and_preprocess(std::string &hr_file, std::string &acc_file,
                                        const std::shared_ptr<input_data> &result,
                                        const std::string &folder_name) const {
 
+    if(!this->positional_pairing){
+        std::cout << "Joining files under folder " << folder_name << " on their time stamps" << std::endl;
+        join_file_content(hr_file, acc_file, result);
+        return true;
+    }
+
     bool files_ok = analyze_files(hr_file, acc_file, result);
     if(!files_ok){
         return false;
@@ -47,13 +62,13 @@ void Preprocessor::preprocess_acc_vectors(const std::shared_ptr<input_data> &res
     }
 
     const auto count = result->acc_entries_count;
-
-    #pragma loop(no_vector)
-    for(size_t i = current_offset; i < count; ++i){
-        x_input[i] /= sampling_rate;
-        y_input[i] /= sampling_rate;
-        z_input[i] /= sampling_rate;
+    if(count <= current_offset){
+        return;
     }
+    //sums of the samples are averaged
+    SimdDispatch::get_kernels().divide_columns(x_input.data() + current_offset, y_input.data() + current_offset,
+                                               z_input.data() + current_offset, count - current_offset,
+                                               sampling_rate);
 }
 
 bool Preprocessor::load_and_preprocess_folder(const std::shared_ptr<input_data> &result){
@@ -64,11 +79,23 @@ bool Preprocessor::load_and_preprocess_folder(const std::shared_ptr<input_data>
         return false;
     }
 
-    //init all vectors according to all files size
-    result->hr = std::make_unique<input_vector>(this->total_predicted_input_size);
-    result->acc_x = std::make_unique<input_vector>(this->total_predicted_input_size);
-    result->acc_y = std::make_unique<input_vector>(this->total_predicted_input_size);
-    result->acc_z = std::make_unique<input_vector>(this->total_predicted_input_size);
+    if(this->plan.storage == STORAGE_STREAMED && !this->positional_pairing){
+        if(!stream_compressed_folder(directories, result)){
+            return false;
+        }
+        print_input_data_statistics(result);
+        return true;
+    }
+
+    //init all vectors according to all files size, the memory plan may load only part of the entries
+    uintmax_t entries_count = this->total_predicted_input_size;
+    if(this->plan.max_entries > 0){
+        entries_count = std::min<uintmax_t>(entries_count, this->plan.max_entries);
+    }
+    result->hr = std::make_unique<input_vector>(entries_count);
+    result->acc_x = std::make_unique<input_vector>(entries_count);
+    result->acc_y = std::make_unique<input_vector>(entries_count);
+    result->acc_z = std::make_unique<input_vector>(entries_count);
 
     for (const auto& data_entry: directories) {
         std::string hr_file = data_entry.second.first;
@@ -83,18 +110,25 @@ bool Preprocessor::load_and_preprocess_folder(const std::shared_ptr<input_data>
         return false;
     }
 
-    __int64 elapsed = time_call([&] {
+    //the unused tail of the predicted (or grown) vectors must not get into the min and max
+    result->hr->values.resize(result->hr_entries_count);
+    result->acc_x->values.resize(result->acc_entries_count);
+    result->acc_y->values.resize(result->acc_entries_count);
+    result->acc_z->values.resize(result->acc_entries_count);
+
+    {
+        ScopedTimer normalize_timer(PHASE_NORMALIZE);
+        ScopedPerfSample post_process_sample(PERF_POST_PROCESS, result->hr_entries_count);
         //after all files are loaded normalization is done + calculate sums that can be calculated one time
         calculate_hr_init_data(result);
 
         post_process(result);
-    });
-    std::cout << "Normalization of input data took " << elapsed << " ms" << std::endl;
+    }
 
-    result->hr->values.resize(result->hr_entries_count);
-    result->acc_x->values.resize(result->acc_entries_count);
-    result->acc_y->values.resize(result->acc_entries_count);
-    result->acc_z->values.resize(result->acc_entries_count);
+    if(this->compress_columns){
+        ScopedTimer normalize_timer(PHASE_NORMALIZE);
+        compress_input_columns(result);
+    }
 
     print_input_data_statistics(result);
     return true;
@@ -178,15 +212,16 @@ void Preprocessor::process_file_content(const std::string &input_file, bool is_a
     std::ifstream file(input_file);
     if (file.is_open()) {
 
-        __int64 elapsed = time_call([&] {
+        {
+            ScopedTimer parse_timer(PHASE_PARSE);
             if (is_acc_file) {
                 load_acc_file_content(result, file);
             } else {
                 load_hr_file_content(result, file);
             }
-        });
+        }
+        MetricsRegistry::increment(COUNTER_PARSED_FILES);
         file.close();
-        std::cout << "Parsing of file (" << input_file << ") took " << elapsed << " ms" << std::endl;
 
     } else {
         std::cerr << "Error: Unable to open the file." << std::endl;
@@ -194,6 +229,221 @@ void Preprocessor::process_file_content(const std::string &input_file, bool is_a
     }
 }
 
+acc_sample Preprocessor::parse_acc_line(const std::string &line) {
+    acc_sample sample;
+    sample.time = parse_timestamp_seconds(line);
+    const auto separator = line.find(',');
+    if(sample.time < 0 || separator == std::string::npos){
+        return sample;
+    }
+    //every value has to be followed by the next separator, so the parsing never starts behind the terminator
+    char* value_end = nullptr;
+    const char* value_begin = line.c_str() + separator + 1;
+    sample.x = std::strtod(value_begin, &value_end);
+    if(value_end == value_begin || *value_end != ','){
+        return sample;
+    }
+    value_begin = value_end + 1;
+    sample.y = std::strtod(value_begin, &value_end);
+    if(value_end == value_begin || *value_end != ','){
+        return sample;
+    }
+    value_begin = value_end + 1;
+    sample.z = std::strtod(value_begin, &value_end);
+    sample.valid = value_end != value_begin;
+    return sample;
+}
+
+bool Preprocessor::parse_hr_line(const std::string &line, int64_t &time, double &hr) {
+    time = parse_timestamp_seconds(line);
+    const auto separator = line.find(',');
+    if(time < 0 || separator == std::string::npos){
+        return false;
+    }
+    char* value_end = nullptr;
+    const char* value_begin = line.c_str() + separator + 1;
+    hr = std::strtod(value_begin, &value_end);
+    return value_end != value_begin;
+}
+
+void Preprocessor::parse_acc_lines(const std::vector<std::string> &lines, std::vector<acc_sample> &samples,
+                                   size_t count) const {
+    for(size_t i = 0; i < count; ++i){
+        samples[i] = parse_acc_line(lines[i]);
+    }
+}
+
+/// Counts of the seconds processed by one join of the file pair
+struct join_stats{
+    size_t count = 0;
+    size_t skipped_hr = 0;
+    size_t skipped_acc = 0;
+    /// lines with the time stamp and malformed values
+    size_t malformed_lines = 0;
+    /// flag indicating that the join stopped at the maximal count before the end of the files
+    bool truncated = false;
+};
+
+/// Joins the hr and acc file on their time stamps in one forward pass over both files and passes every joined
+/// second to emit(index, hr, acc_x, acc_y, acc_z), acc samples of one second are already averaged
+/// \param hr_file path to the hr_file
+/// \param acc_file path to the acc_file
+/// \param max_count maximal count of joined seconds
+/// \param parse_block function parsing block of acc lines parse_block(lines, samples, count)
+/// \param emit function receiving the joined seconds
+/// \return counts of the joined and skipped seconds
+template <class ParseBlock, class Emit>
+static join_stats join_files(const std::string &hr_file, const std::string &acc_file, size_t max_count,
+                             const ParseBlock &parse_block, const Emit &emit){
+    std::ifstream hfile(hr_file);
+    std::ifstream afile(acc_file);
+    if(!hfile.is_open() || !afile.is_open()){
+        std::cerr << "Error: Unable to open the file." << std::endl;
+        exit(-1);
+    }
+    ScopedTimer parse_timer(PHASE_PARSE);
+    join_stats stats {};
+
+    //the lines that don't start with a date time (headers) are skipped, malformed ones are counted
+    std::string hr_line;
+    int64_t hr_time = -1;
+    double hr_value = 0;
+    auto next_hr = [&](){
+        while(std::getline(hfile, hr_line)){
+            if(Preprocessor::parse_hr_line(hr_line, hr_time, hr_value)){
+                return true;
+            }
+            stats.malformed_lines += hr_time >= 0;
+        }
+        return false;
+    };
+
+    //acc lines are read by blocks and parsed at once, which is the expensive part of the join
+    std::vector<std::string> acc_lines(ACC_JOIN_BLOCK_LINES);
+    std::vector<acc_sample> acc_block(ACC_JOIN_BLOCK_LINES);
+    size_t block_size = 0;
+    size_t block_index = 0;
+    auto next_acc_sample = [&](acc_sample& sample){
+        while(true){
+            if(block_index == block_size){
+                block_size = 0;
+                block_index = 0;
+                while(block_size < acc_lines.size() && std::getline(afile, acc_lines[block_size])){
+                    ++block_size;
+                }
+                if(block_size == 0){
+                    return false;
+                }
+                parse_block(acc_lines, acc_block, block_size);
+            }
+            sample = acc_block[block_index++];
+            if(sample.valid){
+                return true;
+            }
+            stats.malformed_lines += sample.time >= 0;
+        }
+    };
+
+    //samples are read one ahead, the first sample of the next second waits in next_sample
+    acc_sample next_sample;
+    bool has_next_sample = next_acc_sample(next_sample);
+    int64_t acc_time = -1;
+    double acc_x = 0, acc_y = 0, acc_z = 0;
+    size_t acc_samples = 0;
+    auto next_acc_second = [&](){
+        if(!has_next_sample){
+            return false;
+        }
+        acc_time = next_sample.time;
+        acc_x = acc_y = acc_z = 0;
+        acc_samples = 0;
+        while(has_next_sample && next_sample.time == acc_time){
+            acc_x += next_sample.x;
+            acc_y += next_sample.y;
+            acc_z += next_sample.z;
+            ++acc_samples;
+            has_next_sample = next_acc_sample(next_sample);
+        }
+        return true;
+    };
+
+    bool has_hr = next_hr();
+    bool has_acc = next_acc_second();
+    while(has_hr && has_acc){
+        if(stats.count >= max_count){
+            stats.truncated = true;
+            break;
+        }
+        if(acc_time < hr_time){
+            ++stats.skipped_acc;
+            has_acc = next_acc_second();
+        }else if(hr_time < acc_time){
+            ++stats.skipped_hr;
+            has_hr = next_hr();
+        }else{
+            const auto samples = static_cast<double>(acc_samples);
+            emit(stats.count, hr_value, acc_x / samples, acc_y / samples, acc_z / samples);
+            ++stats.count;
+            has_hr = next_hr();
+            has_acc = next_acc_second();
+        }
+    }
+    MetricsRegistry::increment(COUNTER_PARSED_FILES, 2);
+    return stats;
+}
+
+static void print_join_stats(const join_stats &stats, size_t count){
+    std::cout << "Joined " << count << " seconds, skipped " << stats.skipped_hr << " hr and " << stats.skipped_acc
+              << " acc seconds without a pair" << std::endl;
+    if(stats.malformed_lines > 0){
+        std::cerr << "Warning: skipped " << stats.malformed_lines << " malformed lines" << std::endl;
+    }
+}
+
+/// Warns that the memory plan cut the loaded entries
+static void print_truncation_warning(size_t max_entries){
+    std::cerr << "Warning: the memory limit allows only " << max_entries
+              << " entries, the rest of the input files is not loaded!" << std::endl;
+}
+
+void Preprocessor::join_file_content(const std::string &hr_file, const std::string &acc_file,
+                                     const std::shared_ptr<input_data> &result) const {
+    auto& hr_input = result->hr->values;
+    auto& x_input = result->acc_x->values;
+    auto& y_input = result->acc_y->values;
+    auto& z_input = result->acc_z->values;
+    const size_t offset = result->hr_entries_count;
+    //the vectors are sized by the prediction from the file sizes, only the memory plan limits the count
+    const size_t max_entries = this->plan.max_entries > 0 ? this->plan.max_entries : std::numeric_limits<size_t>::max();
+    const size_t max_count = max_entries - std::min(max_entries, offset);
+
+    const auto stats = join_files(hr_file, acc_file, max_count,
+                                  [this](const std::vector<std::string>& lines, std::vector<acc_sample>& samples,
+                                         size_t count){
+        parse_acc_lines(lines, samples, count);
+    }, [&](size_t i, double hr, double x, double y, double z){
+        if(offset + i >= hr_input.size()){
+            const size_t grown_size = std::max<size_t>(VECTOR_SIZE, hr_input.size() + hr_input.size() / 2);
+            for(auto* column: {&hr_input, &x_input, &y_input, &z_input}){
+                column->resize(grown_size);
+            }
+        }
+        hr_input[offset + i] = hr;
+        x_input[offset + i] = x;
+        y_input[offset + i] = y;
+        z_input[offset + i] = z;
+    });
+
+    //the acc samples are already averaged, the vectors stay the same length
+    const size_t count = stats.count - stats.count % VECTOR_SIZE;
+    result->hr_entries_count += count;
+    result->acc_entries_count += count;
+    print_join_stats(stats, count);
+    if(stats.truncated){
+        print_truncation_warning(this->plan.max_entries);
+    }
+}
+
 void Preprocessor::load_hr_file_content(const std::shared_ptr<input_data> &result, std::ifstream &file) const {
     auto& hr_input = result->hr->values;
     std::string line;
@@ -280,10 +530,7 @@ inline void Preprocessor::norm_input_vector(const std::unique_ptr<input_vector>&
     auto& arr = vector->values;
     const auto scope = (max - min);
 
-//    #pragma loop(no_vector)
-    for(double& value : arr){
-        value = (value - min) / scope;
-    }
+    SimdDispatch::get_kernels().normalize(arr.data(), arr.size(), min, scope);
 }
 
 void Preprocessor::post_process(const std::shared_ptr<input_data> &data) const {
@@ -291,6 +538,10 @@ void Preprocessor::post_process(const std::shared_ptr<input_data> &data) const {
     find_min_max(data->acc_y);
     find_min_max(data->acc_z);
     find_min_max(data->hr);
+    if(this->compress_columns){
+        //the normalization is folded into the decode of the compressed columns
+        return;
+    }
     norm_input_vector(data->acc_x);
     norm_input_vector(data->acc_y);
     norm_input_vector(data->acc_z);
@@ -298,17 +549,204 @@ void Preprocessor::post_process(const std::shared_ptr<input_data> &data) const {
 }
 
 inline void Preprocessor::find_min_max(const std::unique_ptr<input_vector> &input) const {
-    double min_value = std::numeric_limits<double>::max();
-    double max_value = -std::numeric_limits<double>::max();
+    const auto& arr = input->values;
+    const auto [min_value, max_value] = SimdDispatch::get_kernels().min_max(arr.data(), arr.size());
+    input->min = min_value;
+    input->max = max_value;
+}
 
-    auto arr = input->values;
+/// Fixed point encoding of the column spanning its min-max range
+template <class T>
+struct column_encoder{
+    double min;
+    double step;
+    /// value subtracted from the codes to fit into the code type
+    double code_shift;
+    bool has_scope;
+
+    column_encoder(double min, double max, double code_shift)
+            : min(min), step(max > min ? (max - min) / COMPRESSED_CODE_RANGE : 1), code_shift(code_shift),
+            has_scope(max > min){
+    }
 
-    for(double& value : arr){
-        min_value = std::min(min_value, value);
-        max_value = std::max(max_value, value);
+    [[nodiscard]] T encode(double value) const{
+        const double code = std::round((value - min) / step) - code_shift;
+        return static_cast<T>(std::clamp(code, -code_shift, COMPRESSED_CODE_RANGE - code_shift));
+    }
+
+    /// decoded values are (value - min) / scope, the same as the normalized ones
+    void set_decode(compressed_column<T> &column) const{
+        column.scale = has_scope ? 1 / COMPRESSED_CODE_RANGE : 0;
+        column.offset = has_scope ? code_shift / COMPRESSED_CODE_RANGE : 0;
+    }
+};
+
+/// Encodes the column into fixed point codes spanning its min-max range
+/// \param input not normalized column with found min and max
+/// \param code_shift value subtracted from the codes to fit into the code type
+/// \param column output column
+template <class T>
+static void encode_column(const std::unique_ptr<input_vector> &input, double code_shift, compressed_column<T> &column){
+    const auto& values = input->values;
+    const column_encoder<T> encoder(input->min, input->max, code_shift);
+    column.codes.resize(values.size());
+    for(size_t i = 0; i < values.size(); ++i){
+        column.codes[i] = encoder.encode(values[i]);
+    }
+    encoder.set_decode(column);
+}
+
+/// heart rates are stored exactly, only the normalization is left to the decode
+static void set_integral_hr_decode(compressed_column<uint16_t> &hr, double hr_min, double hr_max){
+    const double hr_scope = hr_max - hr_min;
+    hr.scale = hr_scope > 0 ? 1 / hr_scope : 0;
+    hr.offset = hr_scope > 0 ? -hr_min / hr_scope : 0;
+}
+
+static bool can_store_integral_hr(double hr_min, double hr_max){
+    return hr_min >= 0 && hr_max <= COMPRESSED_CODE_RANGE;
+}
+
+void Preprocessor::compress_input_columns(const std::shared_ptr<input_data> &data) {
+    const size_t double_bytes = (3 * data->acc_entries_count + data->hr_entries_count) * sizeof(double);
+    const size_t code_bytes = 3 * data->acc_entries_count * sizeof(int16_t) + data->hr_entries_count * sizeof(uint16_t);
+
+    //every double column is released right after its encoding, so only one code column is held above them
+    //the min and max stay for the statistics and the plot
+    auto compressed = std::make_unique<compressed_input>();
+    encode_column(data->acc_x, COMPRESSED_ACC_CODE_SHIFT, compressed->acc_x);
+    data->acc_x->values = data_vector();
+    encode_column(data->acc_y, COMPRESSED_ACC_CODE_SHIFT, compressed->acc_y);
+    data->acc_y->values = data_vector();
+    encode_column(data->acc_z, COMPRESSED_ACC_CODE_SHIFT, compressed->acc_z);
+    data->acc_z->values = data_vector();
+
+    const auto& hr_values = data->hr->values;
+    const bool hr_integral = can_store_integral_hr(data->hr->min, data->hr->max)
+            && std::all_of(hr_values.begin(), hr_values.end(), [](double hr){ return hr == std::floor(hr); });
+    if(hr_integral){
+        compressed->hr.codes.assign(hr_values.begin(), hr_values.end());
+        set_integral_hr_decode(compressed->hr, data->hr->min, data->hr->max);
+    }else{
+        encode_column(data->hr, 0, compressed->hr);
+    }
+    data->hr->values = data_vector();
+
+    std::cout << "Columns compressed from " << double_bytes << " to " << code_bytes << " bytes"
+              << (hr_integral ? "" : " (hr quantized)") << std::endl;
+    data->compressed = std::move(compressed);
+}
+
+bool Preprocessor::stream_compressed_folder(const directory_map &directories,
+                                            const std::shared_ptr<input_data> &result) const {
+    const size_t max_entries = this->plan.max_entries > 0 ? this->plan.max_entries
+                                                          : std::numeric_limits<size_t>::max();
+    //ranges of x, y, z and hr, they include the few seconds cut from the end of every file pair
+    //which can only make them slightly wider
+    std::array<simd_min_max, 4> ranges {};
+    ranges.fill({std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest()});
+    auto update_range = [](simd_min_max& range, double value){
+        range.min = std::min(range.min, value);
+        range.max = std::max(range.max, value);
+    };
+    bool hr_integral = true;
+    auto parse_block = [this](const std::vector<std::string>& lines, std::vector<acc_sample>& samples, size_t count){
+        parse_acc_lines(lines, samples, count);
+    };
+
+    std::vector<size_t> counts;
+    size_t total_count = 0;
+    for(const auto& data_entry: directories){
+        const auto stats = join_files(data_entry.second.first, data_entry.second.second, max_entries - total_count,
+                                      parse_block, [&](size_t, double hr, double x, double y, double z){
+            update_range(ranges[0], x);
+            update_range(ranges[1], y);
+            update_range(ranges[2], z);
+            update_range(ranges[3], hr);
+            hr_integral = hr_integral && hr == std::floor(hr);
+        });
+        counts.push_back(stats.count - stats.count % VECTOR_SIZE);
+        total_count += counts.back();
+        if(stats.truncated){
+            print_truncation_warning(max_entries);
+            break;
+        }
+    }
+    if(total_count == 0){
+        return false;
+    }
+
+    std::unique_ptr<input_vector>* columns[] = {&result->acc_x, &result->acc_y, &result->acc_z, &result->hr};
+    for(size_t c = 0; c < 4; ++c){
+        *columns[c] = std::make_unique<input_vector>();
+        (*columns[c])->min = ranges[c].min;
+        (*columns[c])->max = ranges[c].max;
+    }
+    hr_integral = hr_integral && can_store_integral_hr(ranges[3].min, ranges[3].max);
+
+    auto compressed = std::make_unique<compressed_input>();
+    const column_encoder<int16_t> x_encoder(ranges[0].min, ranges[0].max, COMPRESSED_ACC_CODE_SHIFT);
+    const column_encoder<int16_t> y_encoder(ranges[1].min, ranges[1].max, COMPRESSED_ACC_CODE_SHIFT);
+    const column_encoder<int16_t> z_encoder(ranges[2].min, ranges[2].max, COMPRESSED_ACC_CODE_SHIFT);
+    const column_encoder<uint16_t> hr_encoder(ranges[3].min, ranges[3].max, 0);
+    x_encoder.set_decode(compressed->acc_x);
+    y_encoder.set_decode(compressed->acc_y);
+    z_encoder.set_decode(compressed->acc_z);
+    if(hr_integral){
+        set_integral_hr_decode(compressed->hr, ranges[3].min, ranges[3].max);
+    }else{
+        hr_encoder.set_decode(compressed->hr);
+    }
+    compressed->acc_x.codes.resize(total_count);
+    compressed->acc_y.codes.resize(total_count);
+    compressed->acc_z.codes.resize(total_count);
+    compressed->hr.codes.resize(total_count);
+
+    //the second pass joins exactly the counted seconds and encodes them
+    double hr_sum = 0;
+    double hr_sum_power_2 = 0;
+    size_t offset = 0;
+    size_t pair_index = 0;
+    for(const auto& data_entry: directories){
+        if(pair_index == counts.size()){
+            //the first pass stopped at the memory limit
+            break;
+        }
+        const size_t count = counts[pair_index++];
+        if(count == 0){
+            continue;
+        }
+        std::cout << "Streaming files under folder " << data_entry.first << " into compressed columns" << std::endl;
+        const auto stats = join_files(data_entry.second.first, data_entry.second.second, count,
+                                      parse_block, [&](size_t i, double hr, double x, double y, double z){
+            compressed->acc_x.codes[offset + i] = x_encoder.encode(x);
+            compressed->acc_y.codes[offset + i] = y_encoder.encode(y);
+            compressed->acc_z.codes[offset + i] = z_encoder.encode(z);
+            compressed->hr.codes[offset + i] = hr_integral ? static_cast<uint16_t>(hr) : hr_encoder.encode(hr);
+            hr_sum += hr;
+            hr_sum_power_2 += hr * hr;
+        });
+        print_join_stats(stats, count);
+        offset += count;
+    }
+
+    result->hr_entries_count = total_count;
+    result->acc_entries_count = total_count;
+    result->hr_sum = hr_sum;
+    result->squared_hr_corr_sum = (total_count * hr_sum_power_2 - (hr_sum * hr_sum));
+    std::cout << "Columns streamed into " << 4 * total_count * sizeof(int16_t) << " bytes"
+              << (hr_integral ? "" : " (hr quantized)") << std::endl;
+    result->compressed = std::move(compressed);
+    return true;
+}
+
+void Preprocessor::decompress_hr(const std::shared_ptr<input_data> &data) {
+    const auto& hr = data->compressed->hr;
+    auto& values = data->hr->values;
+    values.resize(hr.codes.size());
+    for(size_t i = 0; i < hr.codes.size(); ++i){
+        values[i] = hr.codes[i] * hr.scale + hr.offset;
     }
-    input->min = min_value;
-    input->max = max_value;
 }
 
 bool Preprocessor::analyze_files(const std::string &hr_file, const std::string &acc_file,
@@ -375,5 +813,33 @@ void Preprocessor::calculate_hr_init_data(const std::shared_ptr<input_data>& inp
     input->squared_hr_corr_sum = (input->hr_entries_count * sum_power_2 - (sum * sum));
 }
 
-Preprocessor::Preprocessor(std::string  input_folder) : input_folder(std::move(input_folder)) {
+void Preprocessor::set_memory_plan(const memory_plan &memory_plan) {
+    this->plan = memory_plan;
+}
+
+size_t Preprocessor::predict_entries_count(const std::string &input_folder) {
+    Preprocessor preprocessor(input_folder);
+    directory_map directories {};
+    preprocessor.collect_directory_data_files_entries(directories);
+    return preprocessor.total_predicted_input_size;
+}
+
+uintmax_t Preprocessor::get_largest_acc_file_size(const std::string &input_folder) {
+    Preprocessor preprocessor(input_folder);
+    directory_map directories {};
+    preprocessor.collect_directory_data_files_entries(directories);
+    uintmax_t largest_size = 0;
+    for(const auto& data_entry: directories){
+        std::error_code fs_error;
+        const auto file_size = std::filesystem::file_size(data_entry.second.second, fs_error);
+        if(!fs_error){
+            largest_size = std::max(largest_size, file_size);
+        }
+    }
+    return largest_size;
+}
+
+Preprocessor::Preprocessor(std::string  input_folder, bool compress_columns, bool positional_pairing)
+                            : input_folder(std::move(input_folder)), compress_columns(compress_columns),
+                            positional_pairing(positional_pairing) {
 }
@@ -6,18 +6,23 @@
 #define OCL_TEST_PREPROCESSOR_H
 
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <memory>
 #include <map>
 #include <filesystem>
 #include <random>
+#include <cfloat>
+#include "PageAllocator.h"
+#include "MemoryPlanner.h"
+#include "../simd/SimdKernels.h"
 
 /// definition of type holding all input files
 typedef std::map<std::string, std::pair<std::string, std::string>> directory_map;
 
 struct input_vector{
-    std::vector<double> values;
+    data_vector values;
     double min = DBL_MIN;
     double max = DBL_MAX;
 
@@ -26,6 +31,42 @@ struct input_vector{
     explicit input_vector() = default;
 };
 
+/// Column of fixed point codes, the normalized value is code * scale + offset
+template <class T>
+struct compressed_column{
+    std::vector<T, page_allocator<T>> codes;
+    double scale = 1;
+    double offset = 0;
+
+    /// \return copy of the codes in the range with the same scale and offset
+    [[nodiscard]] compressed_column slice(size_t begin, size_t end) const{
+        return {{codes.begin() + begin, codes.begin() + end}, scale, offset};
+    }
+};
+
+/// Input columns compressed to 16 bit codes, ACC as signed fixed point values spanning the normalized range
+/// and HR as the heart rates themselves if they are integers
+struct compressed_input{
+    compressed_column<int16_t> acc_x;
+    compressed_column<int16_t> acc_y;
+    compressed_column<int16_t> acc_z;
+    compressed_column<uint16_t> hr;
+
+    /// \param begin index of the first entry
+    /// \return columns for the SIMD kernels starting at the entry
+    [[nodiscard]] simd_compressed_columns get_simd_columns(size_t begin) const{
+        return {acc_x.codes.data() + begin, acc_y.codes.data() + begin, acc_z.codes.data() + begin,
+                hr.codes.data() + std::min(begin, hr.codes.size()),
+                {acc_x.scale, acc_y.scale, acc_z.scale, hr.scale},
+                {acc_x.offset, acc_y.offset, acc_z.offset, hr.offset}};
+    }
+
+    /// \return copy of the entries in the range
+    [[nodiscard]] compressed_input slice(size_t begin, size_t end) const{
+        return {acc_x.slice(begin, end), acc_y.slice(begin, end), acc_z.slice(begin, end), hr.slice(begin, end)};
+    }
+};
+
 /// Object to hold input data and all needed variables
 struct input_data{
     std::unique_ptr<input_vector> acc_x = nullptr;
@@ -49,6 +90,23 @@ struct input_data{
 
     double hr_sum = 0;
     double squared_hr_corr_sum = 0;
+
+    /// compressed columns replacing the normalized ones, nullptr if the columns are not compressed
+    std::unique_ptr<compressed_input> compressed = nullptr;
+};
+
+/// count of acc lines read and parsed at once by the time stamp join
+const size_t ACC_JOIN_BLOCK_LINES = 16384;
+
+/// Acc sample parsed from one line of the acc file
+struct acc_sample{
+    /// seconds of the time stamp, -1 if the line doesn't start with a date time (header)
+    int64_t time = -1;
+    /// false if the line has the time stamp but its values are malformed
+    bool valid = false;
+    double x = 0;
+    double y = 0;
+    double z = 0;
 };
 
 enum file_type{
@@ -58,7 +116,13 @@ enum file_type{
 class Preprocessor {
 
 public:
-    explicit Preprocessor(std::string  input_folder);
+    /// \param input_folder folder with the input files
+    /// \param compress_columns flag indicating that the columns are compressed to fixed point codes instead
+    /// of being normalized
+    /// \param positional_pairing flag indicating that the hr and acc entries are paired by their position
+    /// instead of their time stamps
+    explicit Preprocessor(std::string  input_folder, bool compress_columns = false,
+                          bool positional_pairing = false);
 
 public:
     /// Loads and preprocess the pair of ACC and HR file and saves the data into result vectors
@@ -79,9 +143,41 @@ public:
     /// \param input input vector
     virtual void find_min_max(const std::unique_ptr<input_vector> &input) const;
 
+    /// Sets the memory plan limiting the count of loaded entries and choosing the streamed load
+    /// \param memory_plan plan created for the run
+    void set_memory_plan(const memory_plan& memory_plan);
+
+    /// Predicts the count of entries of all files in the folder from their sizes
+    /// \param input_folder folder with the input files
+    /// \return predicted count of entries
+    static size_t predict_entries_count(const std::string& input_folder);
+
+    /// \param input_folder folder with the input files
+    /// \return size in bytes of the largest acc file of the folder
+    static uintmax_t get_largest_acc_file_size(const std::string& input_folder);
+
+    /// Decodes the compressed hr column back into the normalized values
+    /// \param data data with the compressed columns
+    static void decompress_hr(const std::shared_ptr<input_data> &data);
+
+    /// Parses the acc line "date time,x,y,z", the values are checked so no read passes the end of the line
+    /// \param line line of the acc file
+    /// \return parsed sample
+    static acc_sample parse_acc_line(const std::string& line);
+
+    /// Parses the hr line "date time,hr"
+    /// \param line line of the hr file
+    /// \param time output seconds of the time stamp, -1 if the line doesn't start with a date time (header)
+    /// \param hr output heart rate
+    /// \return true if the line has both the time stamp and the value
+    static bool parse_hr_line(const std::string& line, int64_t& time, double& hr);
+
 protected:
     const std::string input_folder;
+    const bool compress_columns = false;
+    const bool positional_pairing = false;
     uintmax_t total_predicted_input_size = 0;
+    memory_plan plan {};
 
 protected:
     /// General method for file parsing measuring the time needed for processing, opening file
@@ -91,6 +187,30 @@ protected:
     void process_file_content(const std::string &input_file, bool is_acc_file,
                                             const std::shared_ptr<input_data> &result) const;
 
+    /// Joins the hr and acc file on their time stamps in one forward pass over both files. Acc samples of one
+    /// second are averaged and paired with the hr entry of the same second, seconds missing in any of the files
+    /// are skipped instead of shifting the following entries. The columns grow when the predicted size is not
+    /// enough, only the memory plan limits the count of the entries
+    /// \param hr_file path to the hr_file
+    /// \param acc_file path to the acc_file
+    /// \param result object holding the result vectors
+    void join_file_content(const std::string &hr_file, const std::string &acc_file,
+                           const std::shared_ptr<input_data> &result) const;
+
+    /// Parses the block of acc lines read by the time stamp join
+    /// \param lines read lines
+    /// \param samples output samples, one for every line
+    /// \param count count of the read lines at the start of the block
+    virtual void parse_acc_lines(const std::vector<std::string>& lines, std::vector<acc_sample>& samples,
+                                 size_t count) const;
+
+    /// Joins all file pairs twice without allocating the double columns. The first pass counts the entries
+    /// and finds the ranges of the columns, the second one encodes the joined entries directly into codes
+    /// \param directories all hr and acc file pairs
+    /// \param result object holding the compressed columns
+    /// \return true if any entry was loaded
+    bool stream_compressed_folder(const directory_map &directories, const std::shared_ptr<input_data> &result) const;
+
     /// Method for parsing of the accelerator data file
     /// \param result object holding the result vectors
     /// \param file opened file input stream
@@ -115,6 +235,11 @@ protected:
     /// \param input input vector
     virtual void norm_input_vector(const std::unique_ptr<input_vector> &input) const;
 
+    /// Encodes the not normalized columns with their min and max into fixed point codes and releases them,
+    /// the normalization is done by the decode in the evaluation kernels
+    /// \param data data with found min and max of all columns
+    static void compress_input_columns(const std::shared_ptr<input_data> &data);
+
     /// Method to collect all hr and acc file pairs from the passed directory
     /// \param folder_map result folder map with pairs
     void collect_directory_data_files_entries(directory_map& folder_map);
@@ -0,0 +1,123 @@
+#include "SimdDispatch.h"
+#include "../utils.h"
+
+#if defined(SIMD_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+/// Executes the cpuid instruction
+/// \param leaf requested leaf
+/// \param sub_leaf requested sub leaf
+/// \param registers output eax, ebx, ecx and edx
+static void read_cpuid(uint32_t leaf, uint32_t sub_leaf, uint32_t registers[4]){
+#if defined(_MSC_VER)
+    int values[4];
+    __cpuidex(values, static_cast<int>(leaf), static_cast<int>(sub_leaf));
+    for(size_t i = 0; i < 4; ++i){
+        registers[i] = static_cast<uint32_t>(values[i]);
+    }
+#else
+    __cpuid_count(leaf, sub_leaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+/// \return register enabling the extended states, only callable if the OS uses xsave
+static uint64_t read_xcr0(){
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+simd_level SimdDispatch::detect_level() {
+#if defined(SIMD_X86)
+    uint32_t registers[4];
+    read_cpuid(0, 0, registers);
+    const uint32_t max_leaf = registers[0];
+    read_cpuid(1, 0, registers);
+    const bool sse2 = (registers[3] >> 26) & 1;
+    const bool fma = (registers[2] >> 12) & 1;
+    const bool os_xsave = (registers[2] >> 27) & 1;
+    const bool avx = (registers[2] >> 28) & 1;
+    if(!sse2){
+        return SIMD_SCALAR;
+    }
+    //the instructions alone are not enough, the OS has to save the wider registers on context switch
+    const uint64_t xcr0 = os_xsave ? read_xcr0() : 0;
+    const bool ymm_enabled = (xcr0 & 0x6) == 0x6;
+    const bool zmm_enabled = (xcr0 & 0xE6) == 0xE6;
+    if(!avx || !fma || !ymm_enabled || max_leaf < 7){
+        return SIMD_SSE2;
+    }
+    read_cpuid(7, 0, registers);
+    const bool avx2 = (registers[1] >> 5) & 1;
+    const bool avx512f = (registers[1] >> 16) & 1;
+    if(avx512f && avx2 && zmm_enabled){
+        return SIMD_AVX512;
+    }
+    return avx2 ? SIMD_AVX2 : SIMD_SSE2;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+const char* SimdDispatch::get_level_name(simd_level level) {
+    switch(level){
+        case SIMD_SCALAR:
+            return SIMD_LEVEL_SCALAR;
+        case SIMD_SSE2:
+            return SIMD_LEVEL_SSE2;
+        case SIMD_AVX2:
+            return SIMD_LEVEL_AVX2;
+        case SIMD_AVX512:
+            return SIMD_LEVEL_AVX512;
+        default:
+            return "unknown";
+    }
+}
+
+const simd_kernels& SimdDispatch::get_level_kernels(simd_level level) {
+    switch(level){
+#if defined(SIMD_X86)
+        case SIMD_SSE2:
+            return get_sse2_kernels();
+        case SIMD_AVX2:
+            return get_avx2_kernels();
+        case SIMD_AVX512:
+            return get_avx512_kernels();
+#endif
+        default:
+            return get_scalar_kernels();
+    }
+}
+
+const simd_kernels*& SimdDispatch::get_selected_kernels() {
+    static const simd_kernels* kernels = &get_level_kernels(detect_level());
+    return kernels;
+}
+
+bool SimdDispatch::select_level(const std::string &level_name) {
+    const simd_level detected_level = detect_level();
+    simd_level level = detected_level;
+    if(level_name != SIMD_LEVEL_AUTO){
+        level = SIMD_LEVEL_COUNT;
+        for(uint8_t i = 0; i < SIMD_LEVEL_COUNT; ++i){
+            if(level_name == get_level_name(static_cast<simd_level>(i))){
+                level = static_cast<simd_level>(i);
+            }
+        }
+        //levels are ordered, so every level below the detected one is supported as well
+        if(level == SIMD_LEVEL_COUNT || level > detected_level){
+            return false;
+        }
+    }
+    get_selected_kernels() = &get_level_kernels(level);
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef OCL_TEST_SIMDDISPATCH_H
+#define OCL_TEST_SIMDDISPATCH_H
+
+
+#include <string>
+#include "SimdKernels.h"
+
+/// Selects the CPU kernels of the best instruction set level supported by the CPU and the OS. The level is
+/// detected by CPUID once at startup and can be overridden to compare the levels.
+class SimdDispatch {
+
+public:
+    /// \return kernels of the selected level, the detected level is used if none was selected
+    static const simd_kernels& get_kernels(){
+        return *get_selected_kernels();
+    }
+
+    /// Selects the kernels of the level
+    /// \param level_name name of the level or SIMD_LEVEL_AUTO for the detected one
+    /// \return false if the name is unknown or the level isn't supported by this CPU
+    static bool select_level(const std::string& level_name);
+
+    /// \return best level supported by the CPU and the OS
+    static simd_level detect_level();
+
+    /// \return printable name of the level
+    static const char* get_level_name(simd_level level);
+
+private:
+    /// \return pointer to the kernels in use, initialized with the detected level
+    static const simd_kernels*& get_selected_kernels();
+
+    /// \return kernels of the level, the level has to be supported
+    static const simd_kernels& get_level_kernels(simd_level level);
+};
+
+
+#endif //OCL_TEST_SIMDDISPATCH_H
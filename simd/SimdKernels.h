@@ -0,0 +1,90 @@
+#ifndef OCL_TEST_SIMDKERNELS_H
+#define OCL_TEST_SIMDKERNELS_H
+
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+/// the SSE2, AVX2 and AVX-512 kernels are compiled only for x86 targets
+#define SIMD_X86
+#endif
+
+/// Instruction set levels of the CPU kernels, ordered from the slowest
+enum simd_level : uint8_t{
+    SIMD_SCALAR,
+    SIMD_SSE2,
+    SIMD_AVX2,
+    SIMD_AVX512,
+    SIMD_LEVEL_COUNT
+};
+
+/// Sums over the transformed data needed to calculate the correlation
+struct simd_sums{
+    double acc_sum;
+    double acc_sum_pow_2;
+    double hr_acc_sum;
+};
+
+struct simd_min_max{
+    double min;
+    double max;
+};
+
+/// Columns stored as fixed point codes decoded as value[i] = code[i] * scale + offset, so the decoded values
+/// are already normalized. Pointers point to the beginning of the range.
+struct simd_compressed_columns{
+    const int16_t* x;
+    const int16_t* y;
+    const int16_t* z;
+    const uint16_t* hr;
+    /// scales and offsets of the x, y, z and hr columns
+    double scales[4];
+    double offsets[4];
+};
+
+/// Hot CPU kernels of one instruction set level. All of them work on contiguous ranges, the caller offsets
+/// the pointers to the beginning of the range. Genome constants and powers are passed as arrays of 4 values,
+/// the last power is not used.
+struct simd_kernels{
+    simd_level level;
+
+    /// result[i] = c0 * x[i]^p0 + c1 * y[i]^p1 + c2 * z[i]^p2 + c3
+    void (*transform)(const double* x, const double* y, const double* z, const double* constants,
+                      const unsigned char* powers, double* result, size_t count);
+
+    /// transforms the data and sums the values, their squares and their products with hr without storing them
+    simd_sums (*correlation_sums)(const double* x, const double* y, const double* z, const double* hr,
+                                  const double* constants, const unsigned char* powers, size_t count);
+
+    simd_min_max (*min_max)(const double* values, size_t count);
+
+    /// values[i] = (values[i] - min) / scope
+    void (*normalize)(double* values, size_t count, double min, double scope);
+
+    /// divides all three columns by the divisor
+    void (*divide_columns)(double* x, double* y, double* z, size_t count, double divisor);
+
+    /// transform of the decoded fixed point columns, the hr column is not used
+    void (*compressed_transform)(const simd_compressed_columns& columns, const double* constants,
+                                 const unsigned char* powers, double* result, size_t count);
+
+    /// correlation sums of the decoded fixed point columns, the values are decoded in registers only
+    simd_sums (*compressed_correlation_sums)(const simd_compressed_columns& columns, const double* constants,
+                                             const unsigned char* powers, size_t count);
+};
+
+/// Kernels of every level are defined in their own translation unit compiled with the flags of the level,
+/// so only the selected one executes instructions the CPU may not support
+const simd_kernels& get_scalar_kernels();
+
+#if defined(SIMD_X86)
+const simd_kernels& get_sse2_kernels();
+
+const simd_kernels& get_avx2_kernels();
+
+const simd_kernels& get_avx512_kernels();
+#endif
+
+
+#endif //OCL_TEST_SIMDKERNELS_H
@@ -0,0 +1,52 @@
+#include "SimdKernels.h"
+
+#if defined(SIMD_X86)
+#include <immintrin.h>
+
+namespace {
+    struct vec_ops{
+        typedef __m256d vec;
+        static constexpr size_t width = 4;
+
+        static vec load(const double* pointer){ return _mm256_loadu_pd(pointer); }
+        static vec load_i16(const int16_t* pointer){
+            return _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pointer))));
+        }
+        static vec load_u16(const uint16_t* pointer){
+            return _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pointer))));
+        }
+        static void store(double* pointer, vec value){ _mm256_storeu_pd(pointer, value); }
+        static vec set1(double value){ return _mm256_set1_pd(value); }
+        static vec zero(){ return _mm256_setzero_pd(); }
+        static vec add(vec a, vec b){ return _mm256_add_pd(a, b); }
+        static vec sub(vec a, vec b){ return _mm256_sub_pd(a, b); }
+        static vec mul(vec a, vec b){ return _mm256_mul_pd(a, b); }
+        static vec div(vec a, vec b){ return _mm256_div_pd(a, b); }
+        static vec fmadd(vec a, vec b, vec c){ return _mm256_fmadd_pd(a, b, c); }
+        static vec min(vec a, vec b){ return _mm256_min_pd(a, b); }
+        static vec max(vec a, vec b){ return _mm256_max_pd(a, b); }
+
+        static double reduce_add(vec value){
+            const __m128d half = _mm_add_pd(_mm256_castpd256_pd128(value), _mm256_extractf128_pd(value, 1));
+            return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+        }
+        static double reduce_min(vec value){
+            const __m128d half = _mm_min_pd(_mm256_castpd256_pd128(value), _mm256_extractf128_pd(value, 1));
+            return _mm_cvtsd_f64(_mm_min_sd(half, _mm_unpackhi_pd(half, half)));
+        }
+        static double reduce_max(vec value){
+            const __m128d half = _mm_max_pd(_mm256_castpd256_pd128(value), _mm256_extractf128_pd(value, 1));
+            return _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+        }
+    };
+}
+
+#define SIMD_LOOP
+#include "SimdKernelsImpl.h"
+
+static constexpr simd_kernels avx2_kernels = make_kernels(SIMD_AVX2);
+
+const simd_kernels& get_avx2_kernels() {
+    return avx2_kernels;
+}
+#endif
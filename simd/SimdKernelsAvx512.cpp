@@ -0,0 +1,42 @@
+#include "SimdKernels.h"
+
+#if defined(SIMD_X86)
+#include <immintrin.h>
+
+namespace {
+    struct vec_ops{
+        typedef __m512d vec;
+        static constexpr size_t width = 8;
+
+        static vec load(const double* pointer){ return _mm512_loadu_pd(pointer); }
+        static vec load_i16(const int16_t* pointer){
+            return _mm512_cvtepi32_pd(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pointer))));
+        }
+        static vec load_u16(const uint16_t* pointer){
+            return _mm512_cvtepi32_pd(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pointer))));
+        }
+        static void store(double* pointer, vec value){ _mm512_storeu_pd(pointer, value); }
+        static vec set1(double value){ return _mm512_set1_pd(value); }
+        static vec zero(){ return _mm512_setzero_pd(); }
+        static vec add(vec a, vec b){ return _mm512_add_pd(a, b); }
+        static vec sub(vec a, vec b){ return _mm512_sub_pd(a, b); }
+        static vec mul(vec a, vec b){ return _mm512_mul_pd(a, b); }
+        static vec div(vec a, vec b){ return _mm512_div_pd(a, b); }
+        static vec fmadd(vec a, vec b, vec c){ return _mm512_fmadd_pd(a, b, c); }
+        static vec min(vec a, vec b){ return _mm512_min_pd(a, b); }
+        static vec max(vec a, vec b){ return _mm512_max_pd(a, b); }
+        static double reduce_add(vec value){ return _mm512_reduce_add_pd(value); }
+        static double reduce_min(vec value){ return _mm512_reduce_min_pd(value); }
+        static double reduce_max(vec value){ return _mm512_reduce_max_pd(value); }
+    };
+}
+
+#define SIMD_LOOP
+#include "SimdKernelsImpl.h"
+
+static constexpr simd_kernels avx512_kernels = make_kernels(SIMD_AVX512);
+
+const simd_kernels& get_avx512_kernels() {
+    return avx512_kernels;
+}
+#endif
@@ -0,0 +1,222 @@
+// Generic kernel bodies shared by all instruction set levels. The header is included only by the level
+// translation units after they define the vec_ops struct with the intrinsics of their level and the SIMD_LOOP
+// hint. Everything is in an anonymous namespace, so the instantiations compiled with different instruction
+// sets can't be merged by the linker. No headers with inline functions are included for the same reason.
+
+#ifndef OCL_TEST_SIMDKERNELSIMPL_H
+#define OCL_TEST_SIMDKERNELSIMPL_H
+
+
+#include "SimdKernels.h"
+
+namespace {
+
+    /// \return x^power by repeated multiplication, powers of the genomes are small integers
+    inline double scalar_power(double x, unsigned power){
+        double result = 1.0;
+        for(unsigned i = 0; i < power; ++i){
+            result *= x;
+        }
+        return result;
+    }
+
+    inline vec_ops::vec vector_power(vec_ops::vec x, unsigned power){
+        auto result = vec_ops::set1(1.0);
+        for(unsigned i = 0; i < power; ++i){
+            result = vec_ops::mul(result, x);
+        }
+        return result;
+    }
+
+    inline double scalar_transform(double x, double y, double z, const double* c, const unsigned char* p){
+        return c[0] * scalar_power(x, p[0]) + c[1] * scalar_power(y, p[1]) + c[2] * scalar_power(z, p[2]) + c[3];
+    }
+
+    inline vec_ops::vec vector_transform(const double* x, const double* y, const double* z,
+                                         const vec_ops::vec* c, const unsigned char* p){
+        auto result = vec_ops::fmadd(c[2], vector_power(vec_ops::load(z), p[2]), c[3]);
+        result = vec_ops::fmadd(c[1], vector_power(vec_ops::load(y), p[1]), result);
+        return vec_ops::fmadd(c[0], vector_power(vec_ops::load(x), p[0]), result);
+    }
+
+    void transform_kernel(const double* x, const double* y, const double* z, const double* constants,
+                          const unsigned char* powers, double* result, size_t count){
+        const vec_ops::vec c[4] = {vec_ops::set1(constants[0]), vec_ops::set1(constants[1]),
+                                   vec_ops::set1(constants[2]), vec_ops::set1(constants[3])};
+        const size_t vector_end = count - count % vec_ops::width;
+        size_t i = 0;
+        SIMD_LOOP
+        for(; i < vector_end; i += vec_ops::width){
+            vec_ops::store(result + i, vector_transform(x + i, y + i, z + i, c, powers));
+        }
+        for(; i < count; ++i){
+            result[i] = scalar_transform(x[i], y[i], z[i], constants, powers);
+        }
+    }
+
+    simd_sums correlation_sums_kernel(const double* x, const double* y, const double* z, const double* hr,
+                                      const double* constants, const unsigned char* powers, size_t count){
+        const vec_ops::vec c[4] = {vec_ops::set1(constants[0]), vec_ops::set1(constants[1]),
+                                   vec_ops::set1(constants[2]), vec_ops::set1(constants[3])};
+        auto acc_sum = vec_ops::zero();
+        auto acc_sum_pow_2 = vec_ops::zero();
+        auto hr_acc_sum = vec_ops::zero();
+        const size_t vector_end = count - count % vec_ops::width;
+        size_t i = 0;
+        SIMD_LOOP
+        for(; i < vector_end; i += vec_ops::width){
+            const auto trs_acc = vector_transform(x + i, y + i, z + i, c, powers);
+            acc_sum = vec_ops::add(acc_sum, trs_acc);
+            acc_sum_pow_2 = vec_ops::fmadd(trs_acc, trs_acc, acc_sum_pow_2);
+            hr_acc_sum = vec_ops::fmadd(trs_acc, vec_ops::load(hr + i), hr_acc_sum);
+        }
+        simd_sums sums {vec_ops::reduce_add(acc_sum), vec_ops::reduce_add(acc_sum_pow_2),
+                        vec_ops::reduce_add(hr_acc_sum)};
+        for(; i < count; ++i){
+            const double trs_acc = scalar_transform(x[i], y[i], z[i], constants, powers);
+            sums.acc_sum += trs_acc;
+            sums.acc_sum_pow_2 += trs_acc * trs_acc;
+            sums.hr_acc_sum += trs_acc * hr[i];
+        }
+        return sums;
+    }
+
+    simd_min_max min_max_kernel(const double* values, size_t count){
+        simd_min_max result {1.7976931348623157e308, -1.7976931348623157e308};
+        auto min = vec_ops::set1(result.min);
+        auto max = vec_ops::set1(result.max);
+        const size_t vector_end = count - count % vec_ops::width;
+        size_t i = 0;
+        SIMD_LOOP
+        for(; i < vector_end; i += vec_ops::width){
+            const auto value = vec_ops::load(values + i);
+            min = vec_ops::min(min, value);
+            max = vec_ops::max(max, value);
+        }
+        result.min = vec_ops::reduce_min(min);
+        result.max = vec_ops::reduce_max(max);
+        for(; i < count; ++i){
+            result.min = values[i] < result.min ? values[i] : result.min;
+            result.max = values[i] > result.max ? values[i] : result.max;
+        }
+        return result;
+    }
+
+    void normalize_kernel(double* values, size_t count, double min, double scope){
+        const auto min_vector = vec_ops::set1(min);
+        const auto scope_vector = vec_ops::set1(scope);
+        const size_t vector_end = count - count % vec_ops::width;
+        size_t i = 0;
+        SIMD_LOOP
+        for(; i < vector_end; i += vec_ops::width){
+            vec_ops::store(values + i, vec_ops::div(vec_ops::sub(vec_ops::load(values + i), min_vector),
+                                                    scope_vector));
+        }
+        for(; i < count; ++i){
+            values[i] = (values[i] - min) / scope;
+        }
+    }
+
+    void divide_columns_kernel(double* x, double* y, double* z, size_t count, double divisor){
+        const auto divisor_vector = vec_ops::set1(divisor);
+        const size_t vector_end = count - count % vec_ops::width;
+        size_t i = 0;
+        SIMD_LOOP
+        for(; i < vector_end; i += vec_ops::width){
+            vec_ops::store(x + i, vec_ops::div(vec_ops::load(x + i), divisor_vector));
+            vec_ops::store(y + i, vec_ops::div(vec_ops::load(y + i), divisor_vector));
+            vec_ops::store(z + i, vec_ops::div(vec_ops::load(z + i), divisor_vector));
+        }
+        for(; i < count; ++i){
+            x[i] /= divisor;
+            y[i] /= divisor;
+            z[i] /= divisor;
+        }
+    }
+
+    /// Broadcast scales and offsets of the compressed columns
+    struct vector_decoder{
+        vec_ops::vec scales[4];
+        vec_ops::vec offsets[4];
+
+        explicit vector_decoder(const simd_compressed_columns& columns){
+            for(size_t c = 0; c < 4; ++c){
+                scales[c] = vec_ops::set1(columns.scales[c]);
+                offsets[c] = vec_ops::set1(columns.offsets[c]);
+            }
+        }
+    };
+
+    /// transform of the compressed columns, the decode replaces the normalization pass
+    inline vec_ops::vec vector_compressed_transform(const simd_compressed_columns& columns, size_t i,
+                                                    const vector_decoder& decoder, const vec_ops::vec* c,
+                                                    const unsigned char* p){
+        const auto x = vec_ops::fmadd(vec_ops::load_i16(columns.x + i), decoder.scales[0], decoder.offsets[0]);
+        const auto y = vec_ops::fmadd(vec_ops::load_i16(columns.y + i), decoder.scales[1], decoder.offsets[1]);
+        const auto z = vec_ops::fmadd(vec_ops::load_i16(columns.z + i), decoder.scales[2], decoder.offsets[2]);
+        auto result = vec_ops::fmadd(c[2], vector_power(z, p[2]), c[3]);
+        result = vec_ops::fmadd(c[1], vector_power(y, p[1]), result);
+        return vec_ops::fmadd(c[0], vector_power(x, p[0]), result);
+    }
+
+    inline double scalar_compressed_transform(const simd_compressed_columns& columns, size_t i,
+                                              const double* constants, const unsigned char* powers){
+        return scalar_transform(columns.x[i] * columns.scales[0] + columns.offsets[0],
+                                columns.y[i] * columns.scales[1] + columns.offsets[1],
+                                columns.z[i] * columns.scales[2] + columns.offsets[2], constants, powers);
+    }
+
+    void compressed_transform_kernel(const simd_compressed_columns& columns, const double* constants,
+                                     const unsigned char* powers, double* result, size_t count){
+        const vec_ops::vec c[4] = {vec_ops::set1(constants[0]), vec_ops::set1(constants[1]),
+                                   vec_ops::set1(constants[2]), vec_ops::set1(constants[3])};
+        const vector_decoder decoder(columns);
+        const size_t vector_end = count - count % vec_ops::width;
+        size_t i = 0;
+        SIMD_LOOP
+        for(; i < vector_end; i += vec_ops::width){
+            vec_ops::store(result + i, vector_compressed_transform(columns, i, decoder, c, powers));
+        }
+        for(; i < count; ++i){
+            result[i] = scalar_compressed_transform(columns, i, constants, powers);
+        }
+    }
+
+    simd_sums compressed_correlation_sums_kernel(const simd_compressed_columns& columns, const double* constants,
+                                                 const unsigned char* powers, size_t count){
+        const vec_ops::vec c[4] = {vec_ops::set1(constants[0]), vec_ops::set1(constants[1]),
+                                   vec_ops::set1(constants[2]), vec_ops::set1(constants[3])};
+        const vector_decoder decoder(columns);
+        auto acc_sum = vec_ops::zero();
+        auto acc_sum_pow_2 = vec_ops::zero();
+        auto hr_acc_sum = vec_ops::zero();
+        const size_t vector_end = count - count % vec_ops::width;
+        size_t i = 0;
+        SIMD_LOOP
+        for(; i < vector_end; i += vec_ops::width){
+            const auto trs_acc = vector_compressed_transform(columns, i, decoder, c, powers);
+            const auto hr = vec_ops::fmadd(vec_ops::load_u16(columns.hr + i), decoder.scales[3], decoder.offsets[3]);
+            acc_sum = vec_ops::add(acc_sum, trs_acc);
+            acc_sum_pow_2 = vec_ops::fmadd(trs_acc, trs_acc, acc_sum_pow_2);
+            hr_acc_sum = vec_ops::fmadd(trs_acc, hr, hr_acc_sum);
+        }
+        simd_sums sums {vec_ops::reduce_add(acc_sum), vec_ops::reduce_add(acc_sum_pow_2),
+                        vec_ops::reduce_add(hr_acc_sum)};
+        for(; i < count; ++i){
+            const double trs_acc = scalar_compressed_transform(columns, i, constants, powers);
+            sums.acc_sum += trs_acc;
+            sums.acc_sum_pow_2 += trs_acc * trs_acc;
+            sums.hr_acc_sum += trs_acc * (columns.hr[i] * columns.scales[3] + columns.offsets[3]);
+        }
+        return sums;
+    }
+
+    /// \return kernels of the level implemented by vec_ops
+    constexpr simd_kernels make_kernels(simd_level level){
+        return {level, transform_kernel, correlation_sums_kernel, min_max_kernel, normalize_kernel,
+                divide_columns_kernel, compressed_transform_kernel, compressed_correlation_sums_kernel};
+    }
+}
+
+
+#endif //OCL_TEST_SIMDKERNELSIMPL_H
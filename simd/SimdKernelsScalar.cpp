@@ -0,0 +1,36 @@
+#include "../utils.h"
+
+namespace {
+    /// one value at once, used as the baseline and on the platforms without the SIMD kernels
+    struct vec_ops{
+        typedef double vec;
+        static constexpr size_t width = 1;
+
+        static vec load(const double* pointer){ return *pointer; }
+        static vec load_i16(const int16_t* pointer){ return *pointer; }
+        static vec load_u16(const uint16_t* pointer){ return *pointer; }
+        static void store(double* pointer, vec value){ *pointer = value; }
+        static vec set1(double value){ return value; }
+        static vec zero(){ return 0.0; }
+        static vec add(vec a, vec b){ return a + b; }
+        static vec sub(vec a, vec b){ return a - b; }
+        static vec mul(vec a, vec b){ return a * b; }
+        static vec div(vec a, vec b){ return a / b; }
+        static vec fmadd(vec a, vec b, vec c){ return a * b + c; }
+        static vec min(vec a, vec b){ return a < b ? a : b; }
+        static vec max(vec a, vec b){ return a > b ? a : b; }
+        static double reduce_add(vec value){ return value; }
+        static double reduce_min(vec value){ return value; }
+        static double reduce_max(vec value){ return value; }
+    };
+}
+
+//the scalar kernels must not be vectorized by the compiler either
+#define SIMD_LOOP LOOP_NO_VECTOR
+#include "SimdKernelsImpl.h"
+
+static constexpr simd_kernels scalar_kernels = make_kernels(SIMD_SCALAR);
+
+const simd_kernels& get_scalar_kernels() {
+    return scalar_kernels;
+}
@@ -0,0 +1,39 @@
+#include "SimdKernels.h"
+
+#if defined(SIMD_X86)
+#include <emmintrin.h>
+
+namespace {
+    struct vec_ops{
+        typedef __m128d vec;
+        static constexpr size_t width = 2;
+
+        static vec load(const double* pointer){ return _mm_loadu_pd(pointer); }
+        //SSE2 can't widen the 16 bit integers, two values are converted separately
+        static vec load_i16(const int16_t* pointer){ return _mm_setr_pd(pointer[0], pointer[1]); }
+        static vec load_u16(const uint16_t* pointer){ return _mm_setr_pd(pointer[0], pointer[1]); }
+        static void store(double* pointer, vec value){ _mm_storeu_pd(pointer, value); }
+        static vec set1(double value){ return _mm_set1_pd(value); }
+        static vec zero(){ return _mm_setzero_pd(); }
+        static vec add(vec a, vec b){ return _mm_add_pd(a, b); }
+        static vec sub(vec a, vec b){ return _mm_sub_pd(a, b); }
+        static vec mul(vec a, vec b){ return _mm_mul_pd(a, b); }
+        static vec div(vec a, vec b){ return _mm_div_pd(a, b); }
+        static vec fmadd(vec a, vec b, vec c){ return _mm_add_pd(_mm_mul_pd(a, b), c); }
+        static vec min(vec a, vec b){ return _mm_min_pd(a, b); }
+        static vec max(vec a, vec b){ return _mm_max_pd(a, b); }
+        static double reduce_add(vec value){ return _mm_cvtsd_f64(_mm_add_sd(value, _mm_unpackhi_pd(value, value))); }
+        static double reduce_min(vec value){ return _mm_cvtsd_f64(_mm_min_sd(value, _mm_unpackhi_pd(value, value))); }
+        static double reduce_max(vec value){ return _mm_cvtsd_f64(_mm_max_sd(value, _mm_unpackhi_pd(value, value))); }
+    };
+}
+
+#define SIMD_LOOP
+#include "SimdKernelsImpl.h"
+
+static constexpr simd_kernels sse2_kernels = make_kernels(SIMD_SSE2);
+
+const simd_kernels& get_sse2_kernels() {
+    return sse2_kernels;
+}
+#endif
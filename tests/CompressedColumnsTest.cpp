@@ -0,0 +1,123 @@
+#include <cmath>
+#include <memory>
+#include "TestHarness.h"
+#include "TestData.h"
+#include "../preprocessing/Preprocessor.h"
+#include "../simd/SimdDispatch.h"
+
+/// seconds of the written subject, multiple of the vector size so no entry is cut from the end
+const int CODEC_TEST_SECONDS = 64;
+/// one step of the 16 bit codes in the normalized range
+const double CODE_STEP = 1.0 / 65535.0;
+
+/// Writes one subject with integral heart rates and four acc samples per second
+static void write_codec_subject(const std::filesystem::path& folder){
+    std::vector<std::string> hr_lines {"datetime,hr"};
+    std::vector<std::string> acc_lines {"datetime,acc_x,acc_y,acc_z"};
+    for(int second = 0; second < CODEC_TEST_SECONDS; ++second){
+        const auto time = format_test_time(second);
+        hr_lines.push_back(time + "," + std::to_string(60 + (second * 7) % 45));
+        for(int sample = 0; sample < 4; ++sample){
+            const double phase = second + sample * 0.25;
+            acc_lines.push_back(time + "," + std::to_string(std::sin(phase)) + ","
+                                + std::to_string(10 * std::cos(phase * 0.3)) + ","
+                                + std::to_string(phase * phase - 100));
+        }
+    }
+    write_test_file(folder / "subject" / "HR_subject.csv", hr_lines);
+    write_test_file(folder / "subject" / "ACC_subject.csv", acc_lines);
+}
+
+/// \return loaded input of the folder, nullptr if the load failed
+static std::shared_ptr<input_data> load_codec_input(const test_folder& folder, bool compress_columns,
+                                                     column_storage storage){
+    Preprocessor preprocessor(folder.path.string(), compress_columns);
+    memory_plan plan {};
+    plan.storage = storage;
+    preprocessor.set_memory_plan(plan);
+    auto input = std::make_shared<input_data>();
+    return preprocessor.load_and_preprocess_folder(input) ? input : nullptr;
+}
+
+template <class T>
+static double decode(const compressed_column<T>& column, size_t index){
+    return column.codes[index] * column.scale + column.offset;
+}
+
+TEST_CASE(compressed_columns_decode_to_normalized_values){
+    test_folder folder;
+    write_codec_subject(folder.path);
+    const auto normalized = load_codec_input(folder, false, STORAGE_DOUBLE);
+    const auto compressed = load_codec_input(folder, true, STORAGE_COMPRESSED);
+    CHECK(normalized && compressed && compressed->compressed);
+    if(!normalized || !compressed || !compressed->compressed){
+        return;
+    }
+    CHECK(compressed->hr_entries_count == CODEC_TEST_SECONDS);
+
+    const auto& columns = *compressed->compressed;
+    CHECK(columns.hr.codes.size() == normalized->hr->values.size());
+    for(size_t i = 0; i < normalized->hr->values.size(); ++i){
+        //acc codes are rounded to the nearest step, integral heart rates are stored exactly
+        CHECK(std::abs(decode(columns.acc_x, i) - normalized->acc_x->values[i]) <= CODE_STEP / 2 + 1e-12);
+        CHECK(std::abs(decode(columns.acc_y, i) - normalized->acc_y->values[i]) <= CODE_STEP / 2 + 1e-12);
+        CHECK(std::abs(decode(columns.acc_z, i) - normalized->acc_z->values[i]) <= CODE_STEP / 2 + 1e-12);
+        CHECK(std::abs(decode(columns.hr, i) - normalized->hr->values[i]) < 1e-12);
+    }
+
+    Preprocessor::decompress_hr(compressed);
+    for(size_t i = 0; i < normalized->hr->values.size(); ++i){
+        CHECK(std::abs(compressed->hr->values[i] - normalized->hr->values[i]) < 1e-12);
+    }
+}
+
+TEST_CASE(streamed_columns_match_compressed_columns){
+    test_folder folder;
+    write_codec_subject(folder.path);
+    const auto compressed = load_codec_input(folder, true, STORAGE_COMPRESSED);
+    const auto streamed = load_codec_input(folder, true, STORAGE_STREAMED);
+    CHECK(compressed && streamed && streamed->compressed);
+    if(!compressed || !streamed || !streamed->compressed){
+        return;
+    }
+    CHECK(streamed->hr_entries_count == compressed->hr_entries_count);
+
+    const auto& expected = *compressed->compressed;
+    const auto& actual = *streamed->compressed;
+    CHECK(actual.acc_x.codes.size() == expected.acc_x.codes.size());
+    for(size_t i = 0; i < std::min(actual.acc_x.codes.size(), expected.acc_x.codes.size()); ++i){
+        //the ranges of both loads are the same, the averages may differ in the last bits only
+        CHECK(std::abs(actual.acc_x.codes[i] - expected.acc_x.codes[i]) <= 1);
+        CHECK(std::abs(actual.acc_y.codes[i] - expected.acc_y.codes[i]) <= 1);
+        CHECK(std::abs(actual.acc_z.codes[i] - expected.acc_z.codes[i]) <= 1);
+        CHECK(actual.hr.codes[i] == expected.hr.codes[i]);
+    }
+    CHECK(std::abs(actual.hr.scale - expected.hr.scale) < 1e-15);
+    CHECK(std::abs(actual.hr.offset - expected.hr.offset) < 1e-15);
+}
+
+TEST_CASE(compressed_correlation_sums_match_double_sums){
+    test_folder folder;
+    write_codec_subject(folder.path);
+    const auto normalized = load_codec_input(folder, false, STORAGE_DOUBLE);
+    const auto compressed = load_codec_input(folder, true, STORAGE_COMPRESSED);
+    CHECK(normalized && compressed && compressed->compressed);
+    if(!normalized || !compressed || !compressed->compressed){
+        return;
+    }
+
+    const double constants[4] {0.5, -1.5, 2.0, 0.25};
+    const unsigned char powers[4] {1, 2, 3, 0};
+    const auto& kernels = SimdDispatch::get_kernels();
+    const size_t count = normalized->hr_entries_count;
+    const auto expected = kernels.correlation_sums(normalized->acc_x->values.data(), normalized->acc_y->values.data(),
+                                                   normalized->acc_z->values.data(), normalized->hr->values.data(),
+                                                   constants, powers, count);
+    const auto actual = kernels.compressed_correlation_sums(compressed->compressed->get_simd_columns(0), constants,
+                                                            powers, count);
+    //every transformed value differs at most by few code steps multiplied by the constants
+    const double tolerance = 1e-3 * count;
+    CHECK(std::abs(actual.acc_sum - expected.acc_sum) < tolerance);
+    CHECK(std::abs(actual.acc_sum_pow_2 - expected.acc_sum_pow_2) < tolerance);
+    CHECK(std::abs(actual.hr_acc_sum - expected.hr_acc_sum) < tolerance);
+}
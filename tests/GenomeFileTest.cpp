@@ -0,0 +1,73 @@
+#include <memory>
+#include "TestHarness.h"
+#include "TestData.h"
+#include "../computation/GenomeFile.h"
+
+/// \return genome with constants that can't be written exactly with the default precision
+static genome create_file_genome(){
+    genome written {};
+    written.constants = {1.0 / 3.0, -2.718281828459045, 1e-17, 12345.678901234567};
+    written.powers = {1, 2, 3, 1};
+    return written;
+}
+
+TEST_CASE(genome_file_round_trip_keeps_full_precision){
+    test_folder folder;
+    const auto file_name = (folder.path / "best.txt").string();
+    const auto written = create_file_genome();
+    CHECK(GenomeFile::write(file_name, written, 0.75));
+
+    const auto genomes = GenomeFile::read(file_name, 3);
+    CHECK(genomes.size() == 1);
+    if(genomes.size() == 1){
+        CHECK(genomes[0].constants == written.constants);
+        CHECK(genomes[0].powers == written.powers);
+    }
+}
+
+TEST_CASE(genome_file_clamps_powers_and_skips_malformed_lines){
+    test_folder folder;
+    const auto file_path = folder.path / "genomes.txt";
+    write_test_file(file_path, {"# comment", "", "   ", "1 2 3 4 0 9 2 -1", "1 2 3", "0.5 0.5 0.5 0.5 2 2 2 2"});
+
+    const auto genomes = GenomeFile::read(file_path.string(), 3);
+    CHECK(genomes.size() == 2);
+    if(genomes.size() == 2){
+        //powers are kept in the range of the genetic algorithm
+        const std::array<unsigned char, GENOME_POW_SIZE> clamped {1, 3, 2, 1};
+        CHECK(genomes[0].powers == clamped);
+        CHECK(genomes[0].constants[3] == 4);
+        CHECK(genomes[1].constants[0] == 0.5);
+    }
+}
+
+TEST_CASE(genome_file_missing_file_gives_no_genomes){
+    test_folder folder;
+    CHECK(GenomeFile::read((folder.path / "missing.txt").string(), 3).empty());
+}
+
+TEST_CASE(warm_start_seeds_the_initial_population){
+    test_folder folder;
+    const auto file_name = (folder.path / "best.txt").string();
+    const auto written = create_file_genome();
+    CHECK(GenomeFile::write(file_name, written, 0.75));
+
+    auto input = std::make_shared<input_data>();
+    input_parameters params;
+    params.population_size = 16;
+    params.pow_scope = 3;
+    params.warm_start = file_name;
+    CalculationScheduler scheduler(input, params);
+    //the file is read by the constructor, so it can be removed before the population is initialized
+    std::filesystem::remove(file_name);
+
+    std::vector<genome> population(params.population_size);
+    scheduler.init_population(population);
+    CHECK(population[0].constants == written.constants);
+    CHECK(population[0].powers == written.powers);
+    for(const auto& member: population){
+        for(const auto power: member.powers){
+            CHECK(power >= 1 && power <= 3);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#include <stdexcept>
+#include "TestHarness.h"
+#include "TestData.h"
+#include "../preprocessing/MemoryPlanner.h"
+#include "../utils.h"
+
+/// the prediction of the entries expects 24 characters per hr line
+const size_t PREDICTED_HR_LINE_SIZE = 24;
+
+/// Writes one subject whose files have the given sizes, only the sizes matter to the planner
+static void write_sized_subject(const std::filesystem::path& folder, size_t acc_file_size,
+                                size_t hr_entries = 16000){
+    std::filesystem::create_directories(folder / "subject");
+    std::ofstream(folder / "subject" / "HR_subject.csv") << std::string(PREDICTED_HR_LINE_SIZE * hr_entries, 'x');
+    std::ofstream(folder / "subject" / "ACC_subject.csv") << std::string(acc_file_size, 'x');
+}
+
+static input_parameters create_planner_parameters(const test_folder& folder, size_t memory_limit){
+    input_parameters params;
+    params.input_folder = folder.path.string();
+    params.memory_limit = memory_limit;
+    return params;
+}
+
+TEST_CASE(memory_size_parser_handles_suffixes_and_overflow){
+    CHECK(MemoryPlanner::parse_memory_size("512") == 512);
+    CHECK(MemoryPlanner::parse_memory_size("512B") == 512);
+    CHECK(MemoryPlanner::parse_memory_size("4K") == 4096);
+    CHECK(MemoryPlanner::parse_memory_size("3m") == 3ull << 20);
+    CHECK(MemoryPlanner::parse_memory_size("2G") == 2ull << 30);
+    CHECK_THROWS(MemoryPlanner::parse_memory_size("5X"), std::invalid_argument);
+    CHECK_THROWS(MemoryPlanner::parse_memory_size("M"), std::invalid_argument);
+    //2^34 G is 2^64 bytes, one byte more than size_t holds
+    CHECK_THROWS(MemoryPlanner::parse_memory_size("17179869184G"), std::out_of_range);
+    CHECK(MemoryPlanner::parse_memory_size("17179869183G") == 17179869183ull << 30);
+}
+
+TEST_CASE(planner_keeps_unlimited_runs_untouched){
+    test_folder folder;
+    write_sized_subject(folder.path, 1000);
+    const auto plan = MemoryPlanner::create_plan(create_planner_parameters(folder, 0));
+    CHECK(plan.storage == STORAGE_DOUBLE);
+    CHECK(plan.max_entries == 0);
+    CHECK(plan.predicted_entries == 0);
+}
+
+TEST_CASE(planner_picks_the_most_precise_storage_that_fits){
+    test_folder folder;
+    write_sized_subject(folder.path, 1000);
+    const auto roomy = MemoryPlanner::create_plan(create_planner_parameters(folder, 1ull << 30));
+    CHECK(roomy.predicted_entries == 16000);
+    CHECK(roomy.storage == STORAGE_DOUBLE);
+    CHECK(roomy.max_entries == 0);
+    //the estimate holds the double columns besides the fixed reserve and buffers
+    CHECK(roomy.estimated_peak_bytes >= MEMORY_RESERVE_BYTES + 16000 * 4 * sizeof(double));
+    CHECK(roomy.estimated_peak_bytes <= roomy.memory_limit);
+
+    //a byte less than the double columns need moves the run to the codes of all entries
+    const auto tight = MemoryPlanner::create_plan(create_planner_parameters(folder, roomy.estimated_peak_bytes - 1));
+    CHECK(tight.storage == STORAGE_COMPRESSED || tight.storage == STORAGE_STREAMED);
+    CHECK(tight.max_entries == 0);
+    CHECK(tight.estimated_peak_bytes <= tight.memory_limit);
+    CHECK(tight.estimated_peak_bytes < roomy.estimated_peak_bytes);
+}
+
+TEST_CASE(planner_limits_entries_and_reports_unmet_limit){
+    //the fixed bytes and the bytes of one entry are derived from two inputs fitting into the memory
+    test_folder folder;
+    write_sized_subject(folder.path, 1000);
+    test_folder double_folder;
+    write_sized_subject(double_folder.path, 1000, 32000);
+    const auto plan = MemoryPlanner::create_plan(create_planner_parameters(folder, 1ull << 30));
+    const auto double_plan = MemoryPlanner::create_plan(create_planner_parameters(double_folder, 1ull << 30));
+    const size_t entry_bytes = (double_plan.estimated_peak_bytes - plan.estimated_peak_bytes) / 16000;
+    const size_t fixed_bytes = plan.estimated_peak_bytes - 16000 * entry_bytes;
+    CHECK(entry_bytes >= 4 * sizeof(double));
+
+    //room for the double columns of a quarter of the entries only, not even the codes of all entries fit
+    const auto limited = MemoryPlanner::create_plan(create_planner_parameters(folder,
+                                                                              fixed_bytes + 4000 * entry_bytes));
+    CHECK(limited.storage == STORAGE_STREAMED);
+    CHECK(limited.max_entries > 4000 && limited.max_entries < 16000);
+    CHECK(limited.max_entries % VECTOR_SIZE == 0);
+    CHECK(limited.estimated_peak_bytes <= limited.memory_limit);
+
+    //at least one vector is loaded even when the limit is smaller than the reserve
+    const auto unmet = MemoryPlanner::create_plan(create_planner_parameters(folder, 1024));
+    CHECK(unmet.max_entries == VECTOR_SIZE);
+    CHECK(unmet.estimated_peak_bytes > unmet.memory_limit);
+}
+
+TEST_CASE(planner_counts_acc_lines_buffered_by_the_parallel_positional_load){
+    test_folder small_folder;
+    write_sized_subject(small_folder.path, 1000);
+    test_folder large_folder;
+    write_sized_subject(large_folder.path, 1000 + 1024 * 1024);
+
+    auto small_params = create_planner_parameters(small_folder, 1ull << 30);
+    small_params.parallel = true;
+    small_params.positional_pairing = true;
+    auto large_params = small_params;
+    large_params.input_folder = large_folder.path.string();
+    const auto small_plan = MemoryPlanner::create_plan(small_params);
+    const auto large_plan = MemoryPlanner::create_plan(large_params);
+    CHECK(large_plan.estimated_peak_bytes - small_plan.estimated_peak_bytes == 2 * 1024 * 1024);
+}
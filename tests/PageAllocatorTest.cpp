@@ -0,0 +1,26 @@
+#include <memory>
+#include "TestHarness.h"
+#include "../preprocessing/PageAllocator.h"
+
+/// count of doubles filling more than one huge page
+const size_t HUGE_COLUMN_SIZE = HUGE_PAGE_SIZE_BYTES / sizeof(double) * 3 / 2;
+
+
+TEST_CASE(page_allocator_aligns_columns_to_pages){
+    for(const size_t count: {size_t{1}, size_t{1000}, HUGE_COLUMN_SIZE}){
+        data_vector column(count, 1.0);
+        CHECK(reinterpret_cast<std::uintptr_t>(column.data()) % PAGE_SIZE_BYTES == 0);
+        CHECK(column.back() == 1.0);
+    }
+}
+
+TEST_CASE(page_allocator_frees_columns_allocated_before_enabling_huge_pages){
+    auto column = std::make_unique<data_vector>(HUGE_COLUMN_SIZE, 2.0);
+    HugePages::set_enabled(true);
+    data_vector huge_column(HUGE_COLUMN_SIZE, 3.0);
+    CHECK(reinterpret_cast<std::uintptr_t>(huge_column.data()) % PAGE_SIZE_BYTES == 0);
+    CHECK(huge_column[HUGE_COLUMN_SIZE - 1] == 3.0);
+    //the column from the normal allocation has to be returned to the normal allocator
+    column.reset();
+    HugePages::set_enabled(false);
+}
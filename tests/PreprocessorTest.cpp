@@ -0,0 +1,136 @@
+#include <cmath>
+#include <memory>
+#include "TestHarness.h"
+#include "TestData.h"
+#include "../preprocessing/Preprocessor.h"
+#include "../preprocessing/ParallelPreprocessor.h"
+#include "../utils.h"
+
+/// Exposes the join of one file pair
+template<class Base>
+struct joining_preprocessor : public Base{
+    explicit joining_preprocessor(const std::string& input_folder): Base(input_folder){
+    }
+    using Base::join_file_content;
+};
+
+/// \return input with columns too short for the joined files, so the join has to grow them
+static std::shared_ptr<input_data> create_short_input(){
+    auto input = create_test_input(8, [](test_column, size_t){ return 0.0; });
+    //the join appends after the loaded entries, so the columns are only the capacity
+    input->hr_entries_count = 0;
+    input->acc_entries_count = 0;
+    return input;
+}
+
+/// Writes 40 seconds where the acc misses second 5, the hr misses second 7 and second 20 has malformed hr,
+/// every acc second has two samples averaging to the second itself and second 10 has extra malformed sample
+static void write_gapped_pair(const std::filesystem::path& folder){
+    std::vector<std::string> hr_lines {"datetime,hr"};
+    std::vector<std::string> acc_lines {"datetime,acc_x,acc_y,acc_z"};
+    for(int second = 0; second < 40; ++second){
+        const auto time = format_test_time(second);
+        if(second == 20){
+            hr_lines.push_back(time + ",abc");
+        }else if(second != 7){
+            hr_lines.push_back(time + "," + std::to_string(second));
+        }
+        if(second == 5){
+            continue;
+        }
+        for(const double shift: {-0.5, 0.5}){
+            const auto value = std::to_string(second + shift);
+            acc_lines.push_back(time + "," + value + "," + value + "," + value);
+        }
+        if(second == 10){
+            acc_lines.push_back(time + ",1.0");
+        }
+    }
+    write_test_file(folder / "HR_pair.csv", hr_lines);
+    write_test_file(folder / "ACC_pair.csv", acc_lines);
+}
+
+
+TEST_CASE(timestamp_parser_matches_utc_seconds){
+    CHECK(parse_timestamp_seconds("1970-01-01 00:00:00") == 0);
+    CHECK(parse_timestamp_seconds("2000-03-01 00:00:00,80") == 951868800);
+    CHECK(parse_timestamp_seconds("2024-02-29 12:34:56,1,2,3") == 1709210096);
+    CHECK(parse_timestamp_seconds("2023-10-01 08:00:01") - parse_timestamp_seconds("2023-09-30 08:00:01") == 86400);
+}
+
+TEST_CASE(timestamp_parser_rejects_headers_and_invalid_dates){
+    CHECK(parse_timestamp_seconds("datetime,hr") == -1);
+    CHECK(parse_timestamp_seconds("2023-10-01 08:00") == -1);
+    CHECK(parse_timestamp_seconds("2023-13-01 08:00:00") == -1);
+    CHECK(parse_timestamp_seconds("2023-1x-01 08:00:00") == -1);
+}
+
+TEST_CASE(acc_line_parser_checks_every_value){
+    const auto sample = Preprocessor::parse_acc_line("2023-10-01 08:00:00,1.5,-2,3e-1");
+    CHECK(sample.valid);
+    CHECK(sample.x == 1.5 && sample.y == -2 && sample.z == 0.3);
+
+    CHECK(Preprocessor::parse_acc_line("datetime,acc_x,acc_y,acc_z").time == -1);
+    for(const char* line: {"2023-10-01 08:00:00", "2023-10-01 08:00:00,", "2023-10-01 08:00:00,1.0",
+                           "2023-10-01 08:00:00,1,2", "2023-10-01 08:00:00,1,2,", "2023-10-01 08:00:00,1,,3",
+                           "2023-10-01 08:00:00,x,2,3"}){
+        const auto malformed = Preprocessor::parse_acc_line(line);
+        CHECK(malformed.time >= 0 && !malformed.valid);
+    }
+}
+
+TEST_CASE(hr_line_parser_checks_the_value){
+    int64_t time = 0;
+    double hr = 0;
+    CHECK(Preprocessor::parse_hr_line("2023-10-01 08:00:00,72.5", time, hr) && hr == 72.5);
+    CHECK(!Preprocessor::parse_hr_line("datetime,hr", time, hr) && time == -1);
+    CHECK(!Preprocessor::parse_hr_line("2023-10-01 08:00:00", time, hr) && time >= 0);
+    CHECK(!Preprocessor::parse_hr_line("2023-10-01 08:00:00,", time, hr));
+}
+
+template<class Base>
+static void check_gapped_join(){
+    test_folder folder;
+    write_gapped_pair(folder.path);
+    joining_preprocessor<Base> preprocessor(folder.path.string());
+    auto input = create_short_input();
+    preprocessor.join_file_content((folder.path / "HR_pair.csv").string(), (folder.path / "ACC_pair.csv").string(),
+                                   input);
+
+    //37 paired seconds are cut to the multiple of the vector size
+    CHECK(input->hr_entries_count == 32);
+    CHECK(input->acc_entries_count == 32);
+    std::vector<double> expected_seconds;
+    for(int second = 0; expected_seconds.size() < 32; ++second){
+        if(second != 5 && second != 7 && second != 20){
+            expected_seconds.push_back(second);
+        }
+    }
+    for(size_t i = 0; i < 32; ++i){
+        CHECK(input->hr->values[i] == expected_seconds[i]);
+        CHECK(std::abs(input->acc_x->values[i] - expected_seconds[i]) < 1e-9);
+        CHECK(std::abs(input->acc_y->values[i] - expected_seconds[i]) < 1e-9);
+        CHECK(std::abs(input->acc_z->values[i] - expected_seconds[i]) < 1e-9);
+    }
+}
+
+TEST_CASE(join_pairs_seconds_and_skips_gaps_and_malformed_lines){
+    check_gapped_join<Preprocessor>();
+}
+
+TEST_CASE(parallel_join_matches_serial_join){
+    check_gapped_join<ParallelPreprocessor>();
+}
+
+TEST_CASE(join_stops_at_memory_plan_limit){
+    test_folder folder;
+    write_gapped_pair(folder.path);
+    joining_preprocessor<Preprocessor> preprocessor(folder.path.string());
+    memory_plan plan {};
+    plan.max_entries = 16;
+    preprocessor.set_memory_plan(plan);
+    auto input = create_short_input();
+    preprocessor.join_file_content((folder.path / "HR_pair.csv").string(), (folder.path / "ACC_pair.csv").string(),
+                                   input);
+    CHECK(input->hr_entries_count == 16);
+}
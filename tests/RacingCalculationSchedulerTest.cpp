@@ -0,0 +1,106 @@
+#include <cmath>
+#include <memory>
+#include "TestHarness.h"
+#include "TestData.h"
+#include "../computation/RacingCalculationScheduler.h"
+
+/// Exposes the subsample building and the visit counting of the racing scheduler
+struct racing_probe : public RacingCalculationScheduler{
+    using RacingCalculationScheduler::RacingCalculationScheduler;
+    using RacingCalculationScheduler::init_calculation;
+    using RacingCalculationScheduler::get_sample_visits;
+    using RacingCalculationScheduler::transform_and_correlation;
+};
+
+/// \return normalized input of the count of entries with the hr sums the schedulers start from
+static std::shared_ptr<input_data> create_racing_input(size_t entries_count){
+    return create_test_input(entries_count, [](test_column column, size_t i){
+        const auto t = static_cast<double>(i);
+        switch(column){
+            case TEST_ACC_X:
+                return 0.5 + 0.5 * std::sin(t * 0.1);
+            case TEST_ACC_Y:
+                return 0.5 + 0.5 * std::cos(t * 0.37);
+            case TEST_ACC_Z:
+                return std::fmod(t * 0.013, 1.0);
+            default:
+                return 0.5 + 0.4 * std::sin(t * 0.1 + 0.2);
+        }
+    });
+}
+
+static input_parameters create_racing_parameters(size_t racing_sample_size, double racing_fraction){
+    input_parameters params;
+    params.population_size = 16;
+    params.seed = 7;
+    params.racing_sample_size = racing_sample_size;
+    params.racing_fraction = racing_fraction;
+    return params;
+}
+
+TEST_CASE(racing_falls_back_to_exact_evaluation_of_tiny_inputs){
+    const auto input = create_racing_input(4);
+    const auto params = create_racing_parameters(1000, 0.25);
+    racing_probe racing(input, params);
+    CalculationScheduler exact(input, params);
+    racing.init_calculation();
+
+    std::vector<genome> population(params.population_size);
+    exact.init_population(population);
+    size_t racing_best = 0, exact_best = 0;
+    CHECK(racing.transform_and_correlation(population, racing_best)
+          == exact.transform_and_correlation(population, exact_best));
+    CHECK(racing_best == exact_best);
+    CHECK(racing.get_sample_visits(population.size()) == population.size() * 4);
+}
+
+TEST_CASE(racing_subsample_is_capped_by_the_entries){
+    //more samples requested than entries, every stratum still holds at least one entry
+    const auto input = create_racing_input(12);
+    const auto params = create_racing_parameters(1000, 0.25);
+    racing_probe racing(input, params);
+    racing.init_calculation();
+
+    std::vector<genome> population(params.population_size);
+    racing.init_population(population);
+    size_t best_index = 0;
+    const double best_corr = racing.transform_and_correlation(population, best_index);
+    CHECK(best_corr >= 0 && best_corr <= 1 + 1e-9);
+    CHECK(best_index < population.size());
+    //the subsample of the 8 groups is smaller than the 12 entries
+    CHECK(racing.get_sample_visits(population.size()) >= population.size() * 8);
+}
+
+TEST_CASE(racing_with_full_fraction_matches_exact_evaluation){
+    const auto input = create_racing_input(256);
+    const auto params = create_racing_parameters(64, 1.0);
+    racing_probe racing(input, params);
+    CalculationScheduler exact(input, params);
+    racing.init_calculation();
+
+    std::vector<genome> population(params.population_size);
+    exact.init_population(population);
+    size_t racing_best = 0, exact_best = 0;
+    const double racing_corr = racing.transform_and_correlation(population, racing_best);
+    const double exact_corr = exact.transform_and_correlation(population, exact_best);
+    CHECK(std::abs(racing_corr - exact_corr) < 1e-12);
+    //every genome is scored on the subsample and then on all entries
+    CHECK(racing.get_sample_visits(population.size()) == population.size() * (64 + 256));
+}
+
+TEST_CASE(racing_counts_only_contenders_on_all_entries){
+    const auto input = create_racing_input(1024);
+    const auto params = create_racing_parameters(128, 0.25);
+    racing_probe racing(input, params);
+    racing.init_calculation();
+
+    std::vector<genome> population(params.population_size);
+    racing.init_population(population);
+    size_t best_index = 0;
+    racing.transform_and_correlation(population, best_index);
+    const auto visits = racing.get_sample_visits(population.size());
+    //the top quarter is always evaluated exactly, the rest only when its interval overlaps the leader
+    CHECK(visits >= population.size() * 128 + 4 * 1024);
+    CHECK(visits <= population.size() * (128 + 1024));
+    CHECK((visits - population.size() * 128) % 1024 == 0);
+}
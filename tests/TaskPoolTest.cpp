@@ -0,0 +1,55 @@
+#include <numeric>
+#include <stdexcept>
+#include "TestHarness.h"
+#include "../parallel/TaskPool.h"
+
+
+TEST_CASE(task_pool_runs_every_task_once){
+    const size_t tasks_count = 1000;
+    std::vector<std::atomic<int>> calls(tasks_count);
+    TaskPool::get_instance().run(tasks_count, [&](size_t task){
+        ++calls[task];
+    });
+    for(const auto& count: calls){
+        CHECK(count == 1);
+    }
+}
+
+TEST_CASE(task_pool_runs_nested_calls_serially){
+    //tasks executed by the calling thread must not lock the running job again
+    const size_t outer_count = 64, inner_count = 32;
+    std::atomic<size_t> inner_calls {0};
+    TaskPool::get_instance().run(outer_count, [&](size_t){
+        TaskPool::get_instance().run(inner_count, [&](size_t){
+            ++inner_calls;
+        });
+    });
+    CHECK(inner_calls == outer_count * inner_count);
+}
+
+TEST_CASE(task_pool_rethrows_task_exception){
+    CHECK_THROWS(TaskPool::get_instance().run(256, [](size_t task){
+        if(task == 200){
+            throw std::runtime_error("task failed");
+        }
+    }), std::runtime_error);
+
+    //the pool stays usable after the failed job
+    std::atomic<size_t> calls {0};
+    TaskPool::get_instance().run(256, [&](size_t){
+        ++calls;
+    });
+    CHECK(calls == 256);
+}
+
+TEST_CASE(parallel_reduce_matches_serial_sum){
+    const size_t count = 1 << 20;
+    std::vector<uint64_t> values(count);
+    std::iota(values.begin(), values.end(), 0);
+    const auto sum = parallel_reduce(0, count, uint64_t{0}, [&](size_t i, uint64_t& partial){
+        partial += values[i];
+    }, [](uint64_t a, uint64_t b){
+        return a + b;
+    }, 1024);
+    CHECK(sum == uint64_t{count} * (count - 1) / 2);
+}
@@ -0,0 +1,89 @@
+#ifndef OCL_TEST_TESTDATA_H
+#define OCL_TEST_TESTDATA_H
+
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../preprocessing/Preprocessor.h"
+
+/// Unique temporary folder removed with all its files at the end of the test
+struct test_folder{
+    std::filesystem::path path;
+
+    test_folder(){
+        std::random_device random_device;
+        do{
+            std::stringstream folder_name;
+            folder_name << "ppr_test_" << std::hex << random_device();
+            path = std::filesystem::temp_directory_path() / folder_name.str();
+        }while(!std::filesystem::create_directory(path));
+    }
+
+    ~test_folder(){
+        std::error_code fs_error;
+        std::filesystem::remove_all(path, fs_error);
+    }
+
+    test_folder(const test_folder&) = delete;
+    test_folder& operator=(const test_folder&) = delete;
+};
+
+/// \param second second of the test day
+/// \return date time of the second in the format of the input files
+inline std::string format_test_time(int second){
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "2023-10-01 %02d:%02d:%02d", 8 + second / 3600, second / 60 % 60,
+                  second % 60);
+    return buffer;
+}
+
+/// Writes the lines into the file, the parent folders are created
+inline void write_test_file(const std::filesystem::path& file_path, const std::vector<std::string>& lines){
+    std::filesystem::create_directories(file_path.parent_path());
+    std::ofstream file(file_path);
+    for(const auto& line: lines){
+        file << line << '\n';
+    }
+}
+
+/// Columns of the input passed to the value generator of create_test_input
+enum test_column{
+    TEST_ACC_X, TEST_ACC_Y, TEST_ACC_Z, TEST_HR
+};
+
+/// Creates input with all entries loaded, hr sums are calculated as during preprocessing
+/// \param entries_count count of entries of every column
+/// \param value function value(column, index) called for the x, y, z and hr columns of every entry in turn
+/// \return created input
+template<class Value>
+std::shared_ptr<input_data> create_test_input(size_t entries_count, Value&& value){
+    auto input = std::make_shared<input_data>();
+    input->acc_x = std::make_unique<input_vector>(entries_count);
+    input->acc_y = std::make_unique<input_vector>(entries_count);
+    input->acc_z = std::make_unique<input_vector>(entries_count);
+    input->hr = std::make_unique<input_vector>(entries_count);
+    double sum = 0, sum_power_2 = 0;
+    for(size_t i = 0; i < entries_count; ++i){
+        input->acc_x->values[i] = value(TEST_ACC_X, i);
+        input->acc_y->values[i] = value(TEST_ACC_Y, i);
+        input->acc_z->values[i] = value(TEST_ACC_Z, i);
+        const double hr = value(TEST_HR, i);
+        input->hr->values[i] = hr;
+        sum += hr;
+        sum_power_2 += hr * hr;
+    }
+    input->acc_entries_count = entries_count;
+    input->hr_entries_count = entries_count;
+    input->hr_sum = sum;
+    input->squared_hr_corr_sum = static_cast<double>(entries_count) * sum_power_2 - sum * sum;
+    return input;
+}
+
+
+#endif //OCL_TEST_TESTDATA_H
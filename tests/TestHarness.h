@@ -0,0 +1,62 @@
+#ifndef OCL_TEST_TESTHARNESS_H
+#define OCL_TEST_TESTHARNESS_H
+
+
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// One registered test, failed checks are counted into the shared counter
+struct test_case{
+    const char* name;
+    std::function<void()> body;
+};
+
+/// \return all tests registered by the TEST_CASE macro
+inline std::vector<test_case>& get_test_cases(){
+    static std::vector<test_case> test_cases;
+    return test_cases;
+}
+
+/// \return count of failed checks of the whole run
+inline size_t& get_failed_checks(){
+    static size_t failed_checks = 0;
+    return failed_checks;
+}
+
+/// Registers the test into the list executed by the test main
+struct test_registration{
+    test_registration(const char* name, std::function<void()> body){
+        get_test_cases().push_back({name, std::move(body)});
+    }
+};
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static test_registration name##_registration {#name, name}; \
+    static void name()
+
+/// Reports the failed condition and continues with the test
+#define CHECK(condition) \
+    do{ \
+        if(!(condition)){ \
+            ++get_failed_checks(); \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " << #condition << std::endl; \
+        } \
+    }while(false)
+
+/// Reports that the expression didn't throw the exception type
+#define CHECK_THROWS(expression, exception_type) \
+    do{ \
+        bool thrown = false; \
+        try{ \
+            expression; \
+        } catch (const exception_type&) { \
+            thrown = true; \
+        } \
+        CHECK(thrown && #expression " throws " #exception_type); \
+    }while(false)
+
+
+#endif //OCL_TEST_TESTHARNESS_H
@@ -0,0 +1,19 @@
+#include "TestHarness.h"
+
+
+int main(int argc, char** argv){
+    //optional argument runs only the tests containing it in their name
+    const std::string filter = argc > 1 ? argv[1] : "";
+    size_t tests_count = 0;
+    for(const auto& test: get_test_cases()){
+        if(std::string(test.name).find(filter) == std::string::npos){
+            continue;
+        }
+        const size_t failed_before = get_failed_checks();
+        test.body();
+        ++tests_count;
+        std::cout << (get_failed_checks() == failed_before ? "[  OK  ] " : "[FAILED] ") << test.name << std::endl;
+    }
+    std::cout << tests_count << " tests, " << get_failed_checks() << " failed checks" << std::endl;
+    return get_failed_checks() == 0 ? 0 : 1;
+}
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <cmath>
+#include "DatasetGenerator.h"
+
+/// unix time of 2023-10-01 08:00:00, start of the first recording
+const time_t GENERATOR_START_TIME = 1696147200;
+
+DatasetGenerator::DatasetGenerator(generator_config config): config(std::move(config)) {
+    //every term is monotone on the normalized interval <0, 1>, so its bounds are at the interval ends
+    this->polynomial_min = this->polynomial_max = this->config.ground_truth.constants[3];
+    for(size_t i = 0; i < 3; ++i){
+        const double c = this->config.ground_truth.constants[i];
+        const double term_at_zero = this->config.ground_truth.powers[i] == 0 ? c : 0.0;
+        this->polynomial_min += std::min(term_at_zero, c);
+        this->polynomial_max += std::max(term_at_zero, c);
+    }
+}
+
+void DatasetGenerator::append_date(std::string &buffer, time_t time) {
+    //civil date from days since epoch (Howard Hinnant's algorithm)
+    const int64_t seconds_of_day = ((time % 86400) + 86400) % 86400;
+    const int64_t days = (time - seconds_of_day) / 86400 + 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const auto day_of_era = static_cast<unsigned>(days - era * 146097);
+    const unsigned year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const unsigned month_index = (5 * day_of_year + 2) / 153;
+    const unsigned day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    const unsigned month = month_index < 10 ? month_index + 3 : month_index - 9;
+    const int64_t year = static_cast<int64_t>(year_of_era) + era * 400 + (month <= 2);
+
+    char date[20];
+    auto put_two_digits = [&date](size_t position, int64_t value){
+        date[position] = static_cast<char>('0' + value / 10);
+        date[position + 1] = static_cast<char>('0' + value % 10);
+    };
+    put_two_digits(0, year / 100);
+    put_two_digits(2, year % 100);
+    date[4] = '-';
+    put_two_digits(5, month);
+    date[7] = '-';
+    put_two_digits(8, day);
+    date[10] = ' ';
+    put_two_digits(11, seconds_of_day / 3600);
+    date[13] = ':';
+    put_two_digits(14, seconds_of_day / 60 % 60);
+    date[16] = ':';
+    put_two_digits(17, seconds_of_day % 60);
+    buffer.append(date, sizeof(date) - 1);
+}
+
+void DatasetGenerator::append_fixed(std::string &buffer, double value, int precision) {
+    char digits[32];
+    const auto result = std::to_chars(std::begin(digits), std::end(digits), value, std::chars_format::fixed, precision);
+    buffer.append(digits, result.ptr);
+}
+
+DatasetGenerator::subject_timeline DatasetGenerator::create_timeline(size_t subject) const {
+    std::mt19937 generator(this->config.seed + static_cast<uint32_t>(subject));
+    std::uniform_int_distribution<int64_t> offset_distribution(-static_cast<int64_t>(this->config.max_offset),
+                                                               static_cast<int64_t>(this->config.max_offset));
+    std::uniform_real_distribution<> acc_distribution(-GENERATOR_ACC_SCOPE, GENERATOR_ACC_SCOPE);
+    std::normal_distribution<> noise_distribution(0.0, this->config.noise * (GENERATOR_HR_MAX - GENERATOR_HR_MIN));
+
+    subject_timeline timeline;
+    timeline.subject = subject;
+    //every subject is recorded on a different day
+    timeline.hr_start = GENERATOR_START_TIME + static_cast<time_t>(subject) * 86400 * 2;
+    timeline.acc_start = timeline.hr_start + static_cast<time_t>(offset_distribution(generator));
+    timeline.start = std::min(timeline.hr_start, timeline.acc_start);
+    const size_t length = this->config.duration + static_cast<size_t>(std::abs(timeline.acc_start - timeline.hr_start));
+
+    timeline.acc_x.resize(length);
+    timeline.acc_y.resize(length);
+    timeline.acc_z.resize(length);
+    timeline.hr.resize(length);
+    for(size_t i = 0; i < length; ++i){
+        timeline.acc_x[i] = acc_distribution(generator);
+        timeline.acc_y[i] = acc_distribution(generator);
+        timeline.acc_z[i] = acc_distribution(generator);
+    }
+    //first loaded seconds of the first subject hold the extremes so the normalization matches the ground truth
+    const auto overlap_begin = static_cast<size_t>(std::max(timeline.hr_start, timeline.acc_start) - timeline.start);
+    if(subject == 0 && overlap_begin + 1 < length){
+        for(auto* axis: {&timeline.acc_x, &timeline.acc_y, &timeline.acc_z}){
+            (*axis)[overlap_begin] = -GENERATOR_ACC_SCOPE;
+            (*axis)[overlap_begin + 1] = GENERATOR_ACC_SCOPE;
+        }
+    }
+
+    const auto& c = this->config.ground_truth.constants;
+    const auto& p = this->config.ground_truth.powers;
+    const double polynomial_scope = this->polynomial_max - this->polynomial_min;
+    for(size_t i = 0; i < length; ++i){
+        auto normalize = [](double value){ return (value + GENERATOR_ACC_SCOPE) / (2 * GENERATOR_ACC_SCOPE); };
+        const double value = c[0] * std::pow(normalize(timeline.acc_x[i]), p[0])
+                             + c[1] * std::pow(normalize(timeline.acc_y[i]), p[1])
+                             + c[2] * std::pow(normalize(timeline.acc_z[i]), p[2]) + c[3];
+        const double relative = polynomial_scope > 0 ? (value - this->polynomial_min) / polynomial_scope : 0.5;
+        const double hr = GENERATOR_HR_MIN + relative * (GENERATOR_HR_MAX - GENERATOR_HR_MIN)
+                          + noise_distribution(generator);
+        //the preprocessor reads at most 6 characters of hr
+        timeline.hr[i] = std::clamp(hr, 1.0, 999.0);
+    }
+    return timeline;
+}
+
+void DatasetGenerator::format_hr_block(std::string &buffer, const subject_timeline &timeline,
+                                       size_t begin, size_t end) {
+    const size_t hr_begin = static_cast<size_t>(timeline.hr_start - timeline.start);
+    for(size_t second = begin; second < end; ++second){
+        append_date(buffer, timeline.hr_start + static_cast<time_t>(second));
+        buffer += ',';
+        append_fixed(buffer, timeline.hr[hr_begin + second], 2);
+        buffer += '\n';
+    }
+}
+
+void DatasetGenerator::format_acc_block(std::string &buffer, const subject_timeline &timeline,
+                                        size_t begin, size_t end) const {
+    const size_t acc_begin = static_cast<size_t>(timeline.acc_start - timeline.start);
+    const uint8_t sampling_rate = this->config.sampling_rate;
+    //jitter of every block of every subject is seeded separately, so the result doesn't depend on the count of threads
+    std::seed_seq block_seed {this->config.seed, static_cast<uint32_t>(timeline.subject),
+                              static_cast<uint32_t>(begin), static_cast<uint32_t>(static_cast<uint64_t>(begin) >> 32)};
+    std::mt19937 generator(block_seed);
+    std::uniform_real_distribution<> jitter_distribution(-0.5, 0.5);
+    std::vector<double> jitter(sampling_rate);
+
+    for(size_t second = begin; second < end; ++second){
+        const std::array<double, 3> means = {timeline.acc_x[acc_begin + second], timeline.acc_y[acc_begin + second],
+                                             timeline.acc_z[acc_begin + second]};
+        std::array<std::vector<double>, 3> samples;
+        for(size_t axis = 0; axis < means.size(); ++axis){
+            //samples of the second average exactly to its mean
+            double jitter_sum = 0;
+            for(size_t sample = 0; sample + 1 < sampling_rate; ++sample){
+                jitter[sample] = jitter_distribution(generator);
+                jitter_sum += jitter[sample];
+            }
+            jitter[sampling_rate - 1] = -jitter_sum;
+            samples[axis].resize(sampling_rate);
+            for(size_t sample = 0; sample < sampling_rate; ++sample){
+                samples[axis][sample] = means[axis] + jitter[sample];
+            }
+        }
+        for(size_t sample = 0; sample < sampling_rate; ++sample){
+            append_date(buffer, timeline.acc_start + static_cast<time_t>(second));
+            for(const auto& axis_samples: samples){
+                buffer += ',';
+                append_fixed(buffer, axis_samples[sample], 4);
+            }
+            buffer += '\n';
+        }
+    }
+}
+
+bool DatasetGenerator::write_file(const std::filesystem::path &file_path, const subject_timeline &timeline,
+                                  bool is_acc_file) const {
+    std::ofstream file(file_path, std::ios::binary);
+    if(!file.is_open()){
+        std::cerr << "File cannot be opened " << file_path.string() << std::endl;
+        return false;
+    }
+    file << (is_acc_file ? "datetime,acc_x,acc_y,acc_z\n" : "datetime,hr\n");
+
+    const size_t threads_count = this->config.threads_count > 0 ? this->config.threads_count
+                                    : std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t blocks_count = (this->config.duration + GENERATOR_BLOCK_SECONDS - 1) / GENERATOR_BLOCK_SECONDS;
+    std::vector<std::string> buffers(threads_count);
+    //blocks are formatted in waves so that the memory stays bounded and written in order
+    for(size_t wave_begin = 0; wave_begin < blocks_count; wave_begin += threads_count){
+        const size_t wave_end = std::min(blocks_count, wave_begin + threads_count);
+        std::vector<std::future<void>> jobs;
+        for(size_t block = wave_begin; block < wave_end; ++block){
+            jobs.push_back(std::async(std::launch::async, [&, block](){
+                auto& buffer = buffers[block - wave_begin];
+                buffer.clear();
+                const size_t begin = block * GENERATOR_BLOCK_SECONDS;
+                const size_t end = std::min(this->config.duration, begin + GENERATOR_BLOCK_SECONDS);
+                if(is_acc_file){
+                    format_acc_block(buffer, timeline, begin, end);
+                }else{
+                    format_hr_block(buffer, timeline, begin, end);
+                }
+            }));
+        }
+        for(size_t block = wave_begin; block < wave_end; ++block){
+            jobs[block - wave_begin].get();
+            const auto& buffer = buffers[block - wave_begin];
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        }
+    }
+    return file.good();
+}
+
+bool DatasetGenerator::write_ground_truth() const {
+    std::ofstream file(this->config.output_folder / GROUND_TRUTH_FILE_NAME);
+    if(!file.is_open()){
+        return false;
+    }
+    const auto& c = this->config.ground_truth.constants;
+    const auto& p = this->config.ground_truth.powers;
+    file << "# ground truth genome: constants c0 c1 c2 c3 and powers p0 p1 p2 p3\n";
+    file << c[0] << " " << c[1] << " " << c[2] << " " << c[3] << " "
+         << (int)p[0] << " " << (int)p[1] << " " << (int)p[2] << " " << (int)p[3] << "\n";
+    return file.good();
+}
+
+bool DatasetGenerator::generate() {
+    std::error_code fs_error;
+    std::filesystem::create_directories(this->config.output_folder, fs_error);
+    if(fs_error){
+        std::cerr << "Output folder cannot be created " << this->config.output_folder.string() << std::endl;
+        return false;
+    }
+
+    for(size_t subject = 0; subject < this->config.subjects_count; ++subject){
+        const auto subject_name = "subject_" + std::to_string(subject);
+        const auto subject_folder = this->config.output_folder / subject_name;
+        std::filesystem::create_directories(subject_folder, fs_error);
+
+        const auto timeline = create_timeline(subject);
+        int64_t elapsed = time_call([&] {
+            if(!write_file(subject_folder / ("HR_" + subject_name + ".csv"), timeline, false)
+                    || !write_file(subject_folder / ("ACC_" + subject_name + ".csv"), timeline, true)){
+                std::cerr << "Writing of " << subject_name << " failed" << std::endl;
+                exit(1);
+            }
+        });
+        std::cout << "Generated " << subject_name << " in " << elapsed << " ms" << std::endl;
+    }
+
+    if(!write_ground_truth()){
+        std::cerr << "Ground truth genome could not be written" << std::endl;
+        return false;
+    }
+    std::cout << "Ground truth: ";
+    print_genome(this->config.ground_truth);
+    return true;
+}
@@ -0,0 +1,98 @@
+#ifndef OCL_TEST_DATASETGENERATOR_H
+#define OCL_TEST_DATASETGENERATOR_H
+
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "../computation/CalculationScheduler.h"
+
+/// count of seconds formatted by one thread at once
+const size_t GENERATOR_BLOCK_SECONDS = 4096;
+
+/// absolute value of the highest per second mean of the acc data
+const double GENERATOR_ACC_SCOPE = 2.0;
+
+/// hr range the ground truth polynomial is mapped to
+const double GENERATOR_HR_MIN = 60.0;
+const double GENERATOR_HR_MAX = 160.0;
+
+#define GROUND_TRUTH_FILE_NAME "ground_truth.txt"
+
+/// Configuration of the generated dataset
+struct generator_config{
+    std::filesystem::path output_folder = "synthetic_data";
+    size_t subjects_count = 1;
+    /// duration of every recording in seconds
+    size_t duration = 3600;
+    uint8_t sampling_rate = 32;
+    /// maximal difference between the start of the hr and acc recording in seconds
+    size_t max_offset = 10;
+    /// standard deviation of the hr noise relative to the hr range
+    double noise = 0.05;
+    uint32_t seed = 42;
+    /// count of formatting threads, 0 means hardware concurrency
+    size_t threads_count = 0;
+    /// polynomial the hr is derived from
+    genome ground_truth {{2.5, -1.5, 0.8, 0.3}, {2, 1, 3, 1}};
+};
+
+/// Generates subject folders with HR_*.csv and ACC_*.csv files in the layout expected by the preprocessor.
+/// Hr of every second is the ground truth polynomial of the normalized acc means of the same second plus noise,
+/// so the solver should find the ground truth genome (or one with the same correlation) on this data
+class DatasetGenerator {
+
+public:
+    explicit DatasetGenerator(generator_config config);
+
+    /// Writes all subject folders and the ground truth file
+    /// \return true if all files were written
+    bool generate();
+
+private:
+    const generator_config config;
+
+    /// bounds of the ground truth polynomial over the normalized acc values
+    double polynomial_min = 0;
+    double polynomial_max = 1;
+
+private:
+    /// Per second values of one subject on the common timeline of both recordings
+    struct subject_timeline{
+        /// index of the subject, mixed into the seeds of the formatted blocks
+        size_t subject = 0;
+        /// unix time of the first hr and acc entry
+        time_t hr_start = 0;
+        time_t acc_start = 0;
+        /// first second of the timeline
+        time_t start = 0;
+        /// acc means of every second on the timeline
+        std::vector<double> acc_x, acc_y, acc_z;
+        /// hr of every second on the timeline
+        std::vector<double> hr;
+    };
+
+    /// Creates the per second values of the subject
+    [[nodiscard]] subject_timeline create_timeline(size_t subject) const;
+
+    /// Formats the hr or acc file of the subject by blocks in parallel and writes them in order
+    bool write_file(const std::filesystem::path& file_path, const subject_timeline& timeline, bool is_acc_file) const;
+
+    /// Formats the block of seconds of the hr file
+    static void format_hr_block(std::string& buffer, const subject_timeline& timeline, size_t begin, size_t end);
+
+    /// Formats the block of seconds of the acc file, every second has sampling rate lines averaging to its mean
+    void format_acc_block(std::string& buffer, const subject_timeline& timeline, size_t begin, size_t end) const;
+
+    /// Appends date time in the input file format without using the thread unsafe localtime
+    static void append_date(std::string& buffer, time_t time);
+
+    /// Appends the number with fixed count of decimals
+    static void append_fixed(std::string& buffer, double value, int precision);
+
+    /// Writes the ground truth genome into the output folder
+    bool write_ground_truth() const;
+};
+
+
+#endif //OCL_TEST_DATASETGENERATOR_H
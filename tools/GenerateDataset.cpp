@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <iostream>
+#include "DatasetGenerator.h"
+
+void print_generator_usage(){
+    std::cout << "Usage: ppr_datagen [-output <folder>] [-subjects <count>] [-duration <seconds>] "
+                 "[-sampling_rate <samples per second>] [-max_offset <seconds>] [-noise <relative sigma>] "
+                 "[-seed <seed>] [-threads <count>] [-genome \"c0,c1,c2,c3,p0,p1,p2\"]" << std::endl;
+}
+
+/// Parses the ground truth genome from comma separated constants and powers
+genome parse_genome(const std::string& text){
+    genome parsed {};
+    std::stringstream stream(text);
+    std::string value;
+    for(size_t i = 0; i < GENOME_CONSTANTS_SIZE + 3 && std::getline(stream, value, ','); ++i){
+        if(i < GENOME_CONSTANTS_SIZE){
+            parsed.constants[i] = std::stod(value);
+        }else{
+            parsed.powers[i - GENOME_CONSTANTS_SIZE] = static_cast<unsigned char>(
+                    std::clamp(std::stoi(value), 0, DEFAULT_POW_SCOPE));
+        }
+    }
+    return parsed;
+}
+
+int main(int argc, char* argv[]) {
+    generator_config config;
+    for(int i = 1; i < argc; ++i){
+        const std::string argument = argv[i];
+        if(i + 1 >= argc){
+            print_generator_usage();
+            return EXIT_FAILURE;
+        }
+        const std::string value = argv[++i];
+        if(argument == "-output"){
+            config.output_folder = value;
+        }else if(argument == "-subjects"){
+            config.subjects_count = std::stoull(value);
+        }else if(argument == "-duration"){
+            config.duration = std::max<size_t>(VECTOR_SIZE * 2, std::stoull(value));
+        }else if(argument == "-sampling_rate"){
+            config.sampling_rate = static_cast<uint8_t>(std::clamp(std::stoi(value), 1, 255));
+        }else if(argument == "-max_offset"){
+            config.max_offset = std::stoull(value);
+        }else if(argument == "-noise"){
+            config.noise = std::abs(std::stod(value));
+        }else if(argument == "-seed"){
+            config.seed = static_cast<uint32_t>(std::stoul(value));
+        }else if(argument == "-threads"){
+            config.threads_count = std::stoull(value);
+        }else if(argument == "-genome"){
+            config.ground_truth = parse_genome(value);
+        }else{
+            print_generator_usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    DatasetGenerator generator(config);
+    return generator.generate() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
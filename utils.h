@@ -8,6 +8,12 @@
 #include <sstream>
 #include <utility>
 #include <iostream>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
 
 #define TEXT_SEPARATOR "--------------------------------------"
 
@@ -27,13 +33,88 @@
 
 #define DEFAULT_GPU_NAME "DEFAULT"
 
+#define ALL_GPU_NAME "ALL"
+
+#define DEFAULT_SUB_DEVICES 1
+
+#define DEFAULT_HYBRID_BATCH_SIZE 4
+
+/// 0 means that the count of threads is derived from hardware concurrency
+#define DEFAULT_CPU_THREADS 0
+
+#define DEFAULT_SELECTION "tournament"
+
+/// maximal count of work groups evaluating one genome in the device genetic algorithm
+#define DEVICE_GA_GROUPS_PER_GENOME 64
+
+#define CL_TRACE_FILE_NAME "trace.json"
+
+/// best genome of the run is written here in the format accepted by the warm start
+#define BEST_GENOME_FILE_NAME "best_genome.txt"
+
+/// empty means that the whole initial population is random
+#define DEFAULT_WARM_START ""
+
+/// 1 means that the population is evaluated in one piece without pipelining
+#define DEFAULT_PIPELINE_CHUNKS 1
+
+/// 0 means that the data are streamed only when they don't fit into the device memory
+#define DEFAULT_STREAM_CHUNK_SIZE 0
+
+/// 0 means that the maximal work group size of the device is used
+#define DEFAULT_WORK_GROUP_SIZE 0
+
+#define TUNE_CACHE_FILE_NAME "autotune.cache"
+
+/// 0 means that every genome is evaluated on all data entries without racing
+#define DEFAULT_RACING_SAMPLE_SIZE 0
+
+/// fraction of the population with the best coarse correlation that is always evaluated on all entries
+#define DEFAULT_RACING_FRACTION 0.25
+
+/// 0 means that the memory is not limited, the limit is in bytes
+#define DEFAULT_MEMORY_LIMIT 0
+
+#define PLOT_MODE_CIRCLES "circles"
+#define PLOT_MODE_RECTS "rects"
+#define PLOT_MODE_RASTER "raster"
+#define DEFAULT_PLOT_MODE PLOT_MODE_CIRCLES
+
 #define DEFAULT_STEP_INFO_INTERVAL 5
+
+#define DEFAULT_CL_CACHE_DIR "ocl_cache"
+
+#define DISABLED_CL_CACHE_DIR "none"
+
+/// metrics are written into <name>.json and <name>.csv at the end of the run
+#define DEFAULT_METRICS_OUTPUT "metrics"
+
+#define DISABLED_METRICS_OUTPUT "none"
+
+#define SIMD_LEVEL_AUTO "auto"
+#define SIMD_LEVEL_SCALAR "scalar"
+#define SIMD_LEVEL_SSE2 "sse2"
+#define SIMD_LEVEL_AVX2 "avx2"
+#define SIMD_LEVEL_AVX512 "avx512"
+/// the best level supported by the CPU is detected at startup
+#define DEFAULT_SIMD_LEVEL SIMD_LEVEL_AUTO
 const size_t VECTOR_SIZE = VECTOR_SIZE_MACRO;
 
+/// disables vectorization of the following loop, the serial version is kept as the scalar baseline
+#if defined(_MSC_VER)
+#define LOOP_NO_VECTOR __pragma(loop(no_vector))
+#elif defined(__clang__)
+#define LOOP_NO_VECTOR _Pragma("clang loop vectorize(disable)")
+#elif defined(__GNUC__) && __GNUC__ >= 14
+#define LOOP_NO_VECTOR _Pragma("GCC novector")
+#else
+#define LOOP_NO_VECTOR
+#endif
+
 //const char* time_format = "%Y-%m-%d %H:%M:%S";
 
 template <class Function>
-__int64 time_call(Function&& f)
+int64_t time_call(Function&& f)
 {
     auto start_time = std::chrono::high_resolution_clock::now();
     f();
@@ -54,34 +135,160 @@ inline time_t parse_date(const std::string& date_string){
     return time;
 }
 
+/// Parses the "%Y-%m-%d %H:%M:%S" date time at the start of the line without any stream or time zone
+/// conversion, so it can be called for every line. The result is usable only for comparing the entries.
+/// \param line line starting with the date time
+/// \return seconds since 1970-01-01 in UTC or -1 if the line doesn't start with the date time
+inline int64_t parse_timestamp_seconds(const std::string& line){
+    if(line.size() < 19){
+        return -1;
+    }
+    bool valid = true;
+    auto read_number = [&](size_t begin, size_t length){
+        int64_t value = 0;
+        for(size_t i = begin; i < begin + length; ++i){
+            const char c = line[i];
+            valid &= c >= '0' && c <= '9';
+            value = value * 10 + (c - '0');
+        }
+        return value;
+    };
+    int64_t year = read_number(0, 4);
+    const int64_t month = read_number(5, 2);
+    const int64_t day = read_number(8, 2);
+    const int64_t seconds = read_number(11, 2) * 3600 + read_number(14, 2) * 60 + read_number(17, 2);
+    if(!valid || month < 1 || month > 12){
+        return -1;
+    }
+    //days since the epoch of the civil date, years start in March so the leap day is the last one
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const int64_t year_of_era = year - era * 400;
+    const int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return (era * 146097 + day_of_era - 719468) * 86400 + seconds;
+}
+
+
+/// Hashes the key parts with FNV-1a which is stable across runs and platforms unlike std::hash
+/// \param key_parts parts of the key
+/// \return hash of the key
+inline uint64_t hash_key_parts(const std::vector<std::string>& key_parts){
+    uint64_t hash = 14695981039346656037ULL;
+    for(const auto& part: key_parts){
+        for(const char c: part){
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+        //separator so that the parts can't be shifted into each other
+        hash ^= 0xFF;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// Execution configuration that can be chosen by the auto tuner instead of the user
+struct execution_config{
+    bool parallel = false;
+    bool hybrid = false;
+    size_t work_group_size = DEFAULT_WORK_GROUP_SIZE;
+    size_t hybrid_batch_size = DEFAULT_HYBRID_BATCH_SIZE;
+    size_t cpu_threads = DEFAULT_CPU_THREADS;
+};
 
 struct input_parameters{
-    const size_t max_step_count = DEFAULT_MAX_STEP_COUNT;
-    const size_t population_size = DEFAULT_POPULATION_SIZE;
-    const size_t seed = DEFAULT_SEED;
+    size_t max_step_count = DEFAULT_MAX_STEP_COUNT;
+    size_t population_size = DEFAULT_POPULATION_SIZE;
+    size_t seed = DEFAULT_SEED;
 
-    const double desired_correlation = DEFAULT_DESIRED_CORRELATION;
-    const double const_scope = DEFAULT_CONST_SCOPE;
-    const int pow_scope = DEFAULT_POW_SCOPE;
+    double desired_correlation = DEFAULT_DESIRED_CORRELATION;
+    double const_scope = DEFAULT_CONST_SCOPE;
+    int pow_scope = DEFAULT_POW_SCOPE;
 
-    const std::string desired_gpu_name = DEFAULT_GPU_NAME;
+    std::string desired_gpu_name = DEFAULT_GPU_NAME;
 
-    const bool parallel = false;
+    bool parallel = false;
 
-    const std::string input_folder;
+    std::string input_folder;
     
-    const size_t step_info_interval = DEFAULT_STEP_INFO_INTERVAL;
-    
-    explicit input_parameters(size_t max_step_count, size_t population_size, size_t seed, double desired_correlation,
-                              double const_scope, int pow_scope, std::string desired_gpu_name, bool parallel,
-                              std::string input_folder, size_t step_info_interval)
-                              : max_step_count(max_step_count), population_size(population_size), seed(seed),
-                              desired_correlation(desired_correlation), const_scope(const_scope), pow_scope(pow_scope),
-                              desired_gpu_name(std::move(desired_gpu_name)), parallel(parallel),
-                              input_folder(std::move(input_folder)), step_info_interval(step_info_interval){}
+    size_t step_info_interval = DEFAULT_STEP_INFO_INTERVAL;
+
+    bool specialized_kernels = false;
+
+    std::string cl_cache_dir = DEFAULT_CL_CACHE_DIR;
+
+    size_t sub_devices = DEFAULT_SUB_DEVICES;
+
+    bool hybrid = false;
+
+    size_t hybrid_batch_size = DEFAULT_HYBRID_BATCH_SIZE;
+
+    size_t cpu_threads = DEFAULT_CPU_THREADS;
+
+    bool device_ga = false;
+
+    std::string selection = DEFAULT_SELECTION;
+
+    bool cl_profile = false;
+
+    size_t pipeline_chunks = DEFAULT_PIPELINE_CHUNKS;
+
+    bool zero_copy = false;
+
+    size_t stream_chunk_size = DEFAULT_STREAM_CHUNK_SIZE;
+
+    bool auto_tune = false;
+
+    size_t work_group_size = DEFAULT_WORK_GROUP_SIZE;
+
+    std::string plot_mode = DEFAULT_PLOT_MODE;
 
+    std::string metrics_output = DEFAULT_METRICS_OUTPUT;
+
+    bool perf_counters = false;
+
+    std::string simd_level = DEFAULT_SIMD_LEVEL;
+
+    bool numa = false;
+
+    bool huge_pages = false;
+
+    bool compressed_columns = false;
+
+    size_t racing_sample_size = DEFAULT_RACING_SAMPLE_SIZE;
+
+    double racing_fraction = DEFAULT_RACING_FRACTION;
+
+    bool positional_pairing = false;
+
+    size_t memory_limit = DEFAULT_MEMORY_LIMIT;
+
+    std::string warm_start = DEFAULT_WARM_START;
+    
     explicit input_parameters() = default;
 
+    /// Creates copy of the parameters with the execution configuration replaced
+    /// \param config execution configuration that should be used
+    /// \return parameters with the new configuration
+    [[nodiscard]] input_parameters with_execution_config(const execution_config& config) const{
+        input_parameters params = *this;
+        params.parallel = config.parallel || config.hybrid;
+        params.hybrid = config.hybrid;
+        params.hybrid_batch_size = config.hybrid_batch_size;
+        params.cpu_threads = config.cpu_threads;
+        params.work_group_size = config.work_group_size;
+        return params;
+    }
+
+    /// Creates copy of the parameters with the stream chunk size replaced
+    /// \param chunk_size count of entries in one streamed chunk
+    /// \return parameters with the new chunk size
+    [[nodiscard]] input_parameters with_stream_chunk_size(size_t chunk_size) const{
+        input_parameters params = *this;
+        params.stream_chunk_size = chunk_size;
+        return params;
+    }
+
     void print_input_parameters(){
         std::cout << TEXT_SEPARATOR << std::endl;
         std::cout << "Running with these parameters:" << std::endl;
@@ -95,6 +302,32 @@ struct input_parameters{
         std::cout << "Parallel: " << parallel << std::endl;
         std::cout << "Input_folder: " << input_folder << std::endl;
         std::cout << "Step_info_interval: " << step_info_interval << std::endl;
+        std::cout << "Specialized_kernels: " << specialized_kernels << std::endl;
+        std::cout << "Cl_cache_dir: " << cl_cache_dir << std::endl;
+        std::cout << "Sub_devices: " << sub_devices << std::endl;
+        std::cout << "Hybrid: " << hybrid << std::endl;
+        std::cout << "Hybrid_batch_size: " << hybrid_batch_size << std::endl;
+        std::cout << "Cpu_threads: " << cpu_threads << std::endl;
+        std::cout << "Device_ga: " << device_ga << std::endl;
+        std::cout << "Selection: " << selection << std::endl;
+        std::cout << "Cl_profile: " << cl_profile << std::endl;
+        std::cout << "Pipeline_chunks: " << pipeline_chunks << std::endl;
+        std::cout << "Zero_copy: " << zero_copy << std::endl;
+        std::cout << "Stream_chunk_size: " << stream_chunk_size << std::endl;
+        std::cout << "Auto_tune: " << auto_tune << std::endl;
+        std::cout << "Work_group_size: " << work_group_size << std::endl;
+        std::cout << "Plot_mode: " << plot_mode << std::endl;
+        std::cout << "Metrics_output: " << metrics_output << std::endl;
+        std::cout << "Perf_counters: " << perf_counters << std::endl;
+        std::cout << "Simd_level: " << simd_level << std::endl;
+        std::cout << "Numa: " << numa << std::endl;
+        std::cout << "Huge_pages: " << huge_pages << std::endl;
+        std::cout << "Compressed_columns: " << compressed_columns << std::endl;
+        std::cout << "Racing_sample_size: " << racing_sample_size << std::endl;
+        std::cout << "Racing_fraction: " << racing_fraction << std::endl;
+        std::cout << "Positional_pairing: " << positional_pairing << std::endl;
+        std::cout << "Memory_limit: " << memory_limit << std::endl;
+        std::cout << "Warm_start: " << warm_start << std::endl;
         std::cout << TEXT_SEPARATOR << std::endl;
     }
 };
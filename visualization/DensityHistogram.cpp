@@ -0,0 +1,71 @@
+#include <future>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include "DensityHistogram.h"
+
+
+DensityHistogram::DensityHistogram(): counts(PLOT_BINS * PLOT_BINS) {
+}
+
+size_t DensityHistogram::fill_range(std::vector<uint32_t> &grid, const data_vector &hr, const data_vector &trs_acc,
+                                    double min_acc, double scope, size_t begin, size_t end) {
+    const auto max_bin = static_cast<double>(PLOT_BINS - 1);
+    size_t binned_count = 0;
+    for(size_t i = begin; i < end; ++i){
+        //first we have to norm transformed acc data, hr is already normed
+        const double norm_acc = (trs_acc[i] - min_acc) / scope;
+        //NaN would survive the clamp and its conversion to the bin index is undefined
+        if(!std::isfinite(norm_acc) || !std::isfinite(hr[i])){
+            continue;
+        }
+        const auto x = static_cast<size_t>(std::clamp(norm_acc * PLOT_BINS, 0.0, max_bin));
+        const auto y = static_cast<size_t>(std::clamp(hr[i] * PLOT_BINS, 0.0, max_bin));
+        ++grid[y * PLOT_BINS + x];
+        ++binned_count;
+    }
+    return binned_count;
+}
+
+void DensityHistogram::fill(const std::unique_ptr<input_vector> &hr, const std::unique_ptr<input_vector> &trs_acc,
+                            size_t threads_count) {
+    const size_t count = std::min(hr->values.size(), trs_acc->values.size());
+    const double min_acc = trs_acc->min;
+    const double scope = trs_acc->max - trs_acc->min > 0 ? trs_acc->max - trs_acc->min : 1.0;
+    if(threads_count == 0){
+        threads_count = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    //small inputs are not worth the allocation of the thread grids
+    threads_count = std::min(threads_count, std::max<size_t>(1, count / (PLOT_BINS * PLOT_BINS)));
+
+    std::fill(this->counts.begin(), this->counts.end(), 0);
+    if(threads_count == 1){
+        this->points_count = fill_range(this->counts, hr->values, trs_acc->values, min_acc, scope, 0, count);
+        return;
+    }
+
+    std::vector<std::vector<uint32_t>> thread_grids(threads_count - 1, std::vector<uint32_t>(this->counts.size()));
+    std::vector<std::future<size_t>> jobs;
+    for(size_t t = 1; t < threads_count; ++t){
+        jobs.push_back(std::async(std::launch::async, [&, t](){
+            return fill_range(thread_grids[t - 1], hr->values, trs_acc->values, min_acc, scope,
+                              count * t / threads_count, count * (t + 1) / threads_count);
+        }));
+    }
+    //first part is binned right into the result grid
+    this->points_count = fill_range(this->counts, hr->values, trs_acc->values, min_acc, scope, 0, count / threads_count);
+    for(auto& job: jobs){
+        this->points_count += job.get();
+    }
+
+    for(const auto& grid: thread_grids){
+        for(size_t i = 0; i < this->counts.size(); ++i){
+            this->counts[i] += grid[i];
+        }
+    }
+}
+
+uint8_t DensityHistogram::get_alpha_level(size_t x, size_t y, double point_opacity) const {
+    const double opacity = std::min(1.0, get_count(x, y) * point_opacity);
+    return static_cast<uint8_t>(std::lround(opacity * 255.0));
+}
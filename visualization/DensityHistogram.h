@@ -0,0 +1,54 @@
+#ifndef OCL_TEST_DENSITYHISTOGRAM_H
+#define OCL_TEST_DENSITYHISTOGRAM_H
+
+
+#include <vector>
+#include <cstdint>
+#include "../preprocessing/Preprocessor.h"
+
+/// count of histogram bins on every axis, one bin for every pixel of the plot area
+const size_t PLOT_BINS = 975;
+
+/// Dense 2D histogram of the plotted points with fixed resolution
+class DensityHistogram {
+
+public:
+    DensityHistogram();
+
+    /// Bins all points of transformed acc (x axis) and hr (y axis) data. Every thread fills its own grid
+    /// over a part of the data and the grids are merged afterwards
+    /// \param hr normed hr data
+    /// \param trs_acc transformed acc data with min and max values found
+    /// \param threads_count count of threads filling the histogram, 0 means hardware concurrency
+    void fill(const std::unique_ptr<input_vector>& hr, const std::unique_ptr<input_vector>& trs_acc,
+              size_t threads_count = 0);
+
+    /// \param x index of the bin on the x axis
+    /// \param y index of the bin on the y axis, 0 is at the bottom of the plot
+    /// \return count of points in the bin
+    [[nodiscard]] uint32_t get_count(size_t x, size_t y) const { return this->counts[y * PLOT_BINS + x]; }
+
+    /// \param x index of the bin on the x axis
+    /// \param y index of the bin on the y axis, 0 is at the bottom of the plot
+    /// \param point_opacity opacity added by every point
+    /// \return opacity of the bin quantized to 0-255
+    [[nodiscard]] uint8_t get_alpha_level(size_t x, size_t y, double point_opacity) const;
+
+    /// \return count of all binned points
+    [[nodiscard]] size_t get_points_count() const { return this->points_count; }
+
+private:
+    /// bin counts stored row by row
+    std::vector<uint32_t> counts;
+
+    size_t points_count = 0;
+
+private:
+    /// Bins the range of points into the passed grid, points with non-finite coordinates are skipped
+    /// \return count of binned points
+    static size_t fill_range(std::vector<uint32_t>& grid, const data_vector& hr, const data_vector& trs_acc,
+                           double min_acc, double scope, size_t begin, size_t end);
+};
+
+
+#endif //OCL_TEST_DENSITYHISTOGRAM_H
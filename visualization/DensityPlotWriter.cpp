@@ -0,0 +1,99 @@
+#include <charconv>
+#include "DensityPlotWriter.h"
+#include "PngEncoder.h"
+
+/// offset of the plot area from the left border of the SVG
+const size_t PLOT_X_OFFSET = 25;
+
+void DensityPlotWriter::append_number(std::string &buffer, size_t value) {
+    char digits[24];
+    const auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+    buffer.append(digits, result.ptr);
+}
+
+void DensityPlotWriter::append_opacity(std::string &buffer, uint8_t alpha_level) {
+    char digits[24];
+    const auto result = std::to_chars(std::begin(digits), std::end(digits), alpha_level / 255.0,
+                                      std::chars_format::fixed, 3);
+    buffer.append(digits, result.ptr);
+}
+
+void DensityPlotWriter::flush_if_full(std::ofstream &svg_file, std::string &buffer) {
+    if(buffer.size() >= PLOT_WRITE_BUFFER_SIZE){
+        svg_file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+}
+
+void DensityPlotWriter::write_circles(std::ofstream &svg_file, const DensityHistogram &histogram,
+                                      double point_opacity) {
+    std::string buffer;
+    buffer.reserve(PLOT_WRITE_BUFFER_SIZE + 128);
+    char digits[32];
+    for(size_t y_bin = 0; y_bin < PLOT_BINS; ++y_bin){
+        for(size_t x_bin = 0; x_bin < PLOT_BINS; ++x_bin){
+            const uint32_t points = histogram.get_count(x_bin, y_bin);
+            if(points == 0){
+                continue;
+            }
+            buffer += "<circle cx=\"";
+            append_number(buffer, x_bin + PLOT_X_OFFSET);
+            buffer += "\" cy=\"";
+            append_number(buffer, PLOT_BINS - y_bin);
+            buffer += R"(" r="1" opacity=")";
+            const auto result = std::to_chars(std::begin(digits), std::end(digits), points * point_opacity);
+            buffer.append(digits, result.ptr);
+            buffer += "\"/>\n";
+            flush_if_full(svg_file, buffer);
+        }
+    }
+    svg_file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+void DensityPlotWriter::write_rect_rows(std::ofstream &svg_file, const DensityHistogram &histogram,
+                                        double point_opacity) {
+    std::string buffer;
+    buffer.reserve(PLOT_WRITE_BUFFER_SIZE + 128);
+    for(size_t y_bin = 0; y_bin < PLOT_BINS; ++y_bin){
+        size_t x_bin = 0;
+        while(x_bin < PLOT_BINS){
+            const uint8_t alpha_level = histogram.get_alpha_level(x_bin, y_bin, point_opacity);
+            //run of bins with the same quantized opacity is written as one rect
+            size_t run_end = x_bin + 1;
+            while(run_end < PLOT_BINS && histogram.get_alpha_level(run_end, y_bin, point_opacity) == alpha_level){
+                ++run_end;
+            }
+            if(alpha_level > 0){
+                buffer += "<rect x=\"";
+                append_number(buffer, x_bin + PLOT_X_OFFSET);
+                buffer += "\" y=\"";
+                append_number(buffer, PLOT_BINS - 1 - y_bin);
+                buffer += "\" width=\"";
+                append_number(buffer, run_end - x_bin);
+                buffer += R"(" height="1" opacity=")";
+                append_opacity(buffer, alpha_level);
+                buffer += "\"/>\n";
+                flush_if_full(svg_file, buffer);
+            }
+            x_bin = run_end;
+        }
+    }
+    svg_file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+void DensityPlotWriter::write_raster(std::ofstream &svg_file, const DensityHistogram &histogram,
+                                     double point_opacity) {
+    //black pixels with the bin opacity, PNG rows go from the top of the plot
+    std::vector<uint8_t> pixels(PLOT_BINS * PLOT_BINS * 2);
+    for(size_t y_bin = 0; y_bin < PLOT_BINS; ++y_bin){
+        const size_t row_offset = (PLOT_BINS - 1 - y_bin) * PLOT_BINS * 2;
+        for(size_t x_bin = 0; x_bin < PLOT_BINS; ++x_bin){
+            pixels[row_offset + x_bin * 2 + 1] = histogram.get_alpha_level(x_bin, y_bin, point_opacity);
+        }
+    }
+    const auto png = PngEncoder::encode_gray_alpha(PLOT_BINS, PLOT_BINS, pixels);
+
+    svg_file << "<image x=\"" << PLOT_X_OFFSET << "\" y=\"0\" width=\"" << PLOT_BINS << "\" height=\"" << PLOT_BINS
+             << R"(" style="image-rendering:pixelated" href="data:image/png;base64,)"
+             << PngEncoder::encode_base64(png) << "\"/>\n";
+}
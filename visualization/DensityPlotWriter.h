@@ -0,0 +1,44 @@
+#ifndef OCL_TEST_DENSITYPLOTWRITER_H
+#define OCL_TEST_DENSITYPLOTWRITER_H
+
+
+#include <fstream>
+#include <string>
+#include "DensityHistogram.h"
+
+/// size of the buffer the plot elements are formatted into before they are written to the file
+const size_t PLOT_WRITE_BUFFER_SIZE = 1 << 20;
+
+/// Writes the binned points into the SVG file. Circles write one element per occupied bin, rects merge
+/// neighbouring bins of the same opacity in every row and raster embeds the whole plot as single PNG image
+class DensityPlotWriter {
+
+public:
+    /// \param svg_file opened SVG file
+    /// \param histogram binned points
+    /// \param point_opacity opacity added by every point
+    static void write_circles(std::ofstream& svg_file, const DensityHistogram& histogram, double point_opacity);
+
+    /// \param svg_file opened SVG file
+    /// \param histogram binned points
+    /// \param point_opacity opacity added by every point
+    static void write_rect_rows(std::ofstream& svg_file, const DensityHistogram& histogram, double point_opacity);
+
+    /// \param svg_file opened SVG file
+    /// \param histogram binned points
+    /// \param point_opacity opacity added by every point
+    static void write_raster(std::ofstream& svg_file, const DensityHistogram& histogram, double point_opacity);
+
+private:
+    /// Appends the number to the buffer
+    static void append_number(std::string& buffer, size_t value);
+
+    /// Appends the quantized opacity as decimal number to the buffer
+    static void append_opacity(std::string& buffer, uint8_t alpha_level);
+
+    /// Writes the buffer to the file once it is full
+    static void flush_if_full(std::ofstream& svg_file, std::string& buffer);
+};
+
+
+#endif //OCL_TEST_DENSITYPLOTWRITER_H
@@ -0,0 +1,131 @@
+#include <array>
+#include <algorithm>
+#include "PngEncoder.h"
+
+/// maximal length of one stored deflate block
+const size_t DEFLATE_STORED_BLOCK_SIZE = 65535;
+
+void PngEncoder::append_u32(std::vector<uint8_t> &out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t PngEncoder::crc32(const uint8_t *data, size_t length, uint32_t crc) {
+    static const auto table = [](){
+        std::array<uint32_t, 256> crc_table {};
+        for(uint32_t n = 0; n < crc_table.size(); ++n){
+            uint32_t c = n;
+            for(int k = 0; k < 8; ++k){
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            crc_table[n] = c;
+        }
+        return crc_table;
+    }();
+
+    crc = ~crc;
+    for(size_t i = 0; i < length; ++i){
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t PngEncoder::adler32(const std::vector<uint8_t> &data) {
+    const uint32_t modulo = 65521;
+    uint32_t a = 1, b = 0;
+    //sums can be taken modulo once per 5552 bytes without overflow
+    for(size_t begin = 0; begin < data.size(); begin += 5552){
+        const size_t end = std::min(data.size(), begin + 5552);
+        for(size_t i = begin; i < end; ++i){
+            a += data[i];
+            b += a;
+        }
+        a %= modulo;
+        b %= modulo;
+    }
+    return b << 16 | a;
+}
+
+std::vector<uint8_t> PngEncoder::store_zlib(const std::vector<uint8_t> &data) {
+    std::vector<uint8_t> stream;
+    stream.reserve(data.size() + data.size() / DEFLATE_STORED_BLOCK_SIZE * 5 + 16);
+    //deflate with 32K window, no compression
+    stream.push_back(0x78);
+    stream.push_back(0x01);
+
+    size_t offset = 0;
+    do{
+        const size_t length = std::min(DEFLATE_STORED_BLOCK_SIZE, data.size() - offset);
+        const bool last_block = offset + length == data.size();
+        stream.push_back(last_block ? 1 : 0);
+        stream.push_back(static_cast<uint8_t>(length));
+        stream.push_back(static_cast<uint8_t>(length >> 8));
+        stream.push_back(static_cast<uint8_t>(~length));
+        stream.push_back(static_cast<uint8_t>(~length >> 8));
+        stream.insert(stream.end(), data.begin() + static_cast<long>(offset),
+                      data.begin() + static_cast<long>(offset + length));
+        offset += length;
+    }while(offset < data.size());
+
+    append_u32(stream, adler32(data));
+    return stream;
+}
+
+void PngEncoder::append_chunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data) {
+    append_u32(png, static_cast<uint32_t>(data.size()));
+    const size_t type_offset = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    //CRC covers the chunk type and data
+    append_u32(png, crc32(png.data() + type_offset, png.size() - type_offset));
+}
+
+std::vector<uint8_t> PngEncoder::encode_gray_alpha(uint32_t width, uint32_t height,
+                                                   const std::vector<uint8_t> &pixels) {
+    std::vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+    std::vector<uint8_t> header;
+    append_u32(header, width);
+    append_u32(header, height);
+    //bit depth 8, color type 4 (gray + alpha), default compression, filter and no interlace
+    header.insert(header.end(), {8, 4, 0, 0, 0});
+    append_chunk(png, "IHDR", header);
+
+    //every row starts with filter type 0 (none)
+    const size_t row_size = static_cast<size_t>(width) * 2;
+    std::vector<uint8_t> raw;
+    raw.reserve((row_size + 1) * height);
+    for(size_t row = 0; row < height; ++row){
+        raw.push_back(0);
+        raw.insert(raw.end(), pixels.begin() + static_cast<long>(row * row_size),
+                   pixels.begin() + static_cast<long>((row + 1) * row_size));
+    }
+    append_chunk(png, "IDAT", store_zlib(raw));
+    append_chunk(png, "IEND", {});
+    return png;
+}
+
+std::string PngEncoder::encode_base64(const std::vector<uint8_t> &data) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string encoded;
+    encoded.reserve((data.size() + 2) / 3 * 4);
+    size_t i = 0;
+    for(; i + 2 < data.size(); i += 3){
+        const uint32_t triple = data[i] << 16 | data[i + 1] << 8 | data[i + 2];
+        encoded.push_back(alphabet[triple >> 18 & 0x3F]);
+        encoded.push_back(alphabet[triple >> 12 & 0x3F]);
+        encoded.push_back(alphabet[triple >> 6 & 0x3F]);
+        encoded.push_back(alphabet[triple & 0x3F]);
+    }
+    if(i < data.size()){
+        const bool has_second = i + 1 < data.size();
+        const uint32_t triple = data[i] << 16 | (has_second ? data[i + 1] << 8 : 0);
+        encoded.push_back(alphabet[triple >> 18 & 0x3F]);
+        encoded.push_back(alphabet[triple >> 12 & 0x3F]);
+        encoded.push_back(has_second ? alphabet[triple >> 6 & 0x3F] : '=');
+        encoded.push_back('=');
+    }
+    return encoded;
+}
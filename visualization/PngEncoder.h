@@ -0,0 +1,44 @@
+#ifndef OCL_TEST_PNGENCODER_H
+#define OCL_TEST_PNGENCODER_H
+
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/// Minimal PNG encoder without external dependencies. The image data are stored in uncompressed deflate
+/// blocks, so the file size depends only on the image size and not on its content
+class PngEncoder {
+
+public:
+    /// Encodes 8-bit grayscale image with alpha channel
+    /// \param width width of the image in pixels
+    /// \param height height of the image in pixels
+    /// \param pixels gray and alpha value of every pixel stored row by row from the top
+    /// \return encoded PNG file
+    static std::vector<uint8_t> encode_gray_alpha(uint32_t width, uint32_t height, const std::vector<uint8_t>& pixels);
+
+    /// Encodes the data into base64 so they can be embedded as a data URI
+    /// \param data binary data
+    /// \return base64 string
+    static std::string encode_base64(const std::vector<uint8_t>& data);
+
+private:
+    /// \return CRC-32 of the data as used by the PNG chunks
+    static uint32_t crc32(const uint8_t* data, size_t length, uint32_t crc = 0);
+
+    /// \return Adler-32 checksum of the data as used by the zlib stream
+    static uint32_t adler32(const std::vector<uint8_t>& data);
+
+    /// Wraps the data into zlib stream made of stored deflate blocks
+    static std::vector<uint8_t> store_zlib(const std::vector<uint8_t>& data);
+
+    /// Appends PNG chunk with its length and CRC to the file
+    static void append_chunk(std::vector<uint8_t>& png, const char* type, const std::vector<uint8_t>& data);
+
+    /// Appends 32-bit big endian number
+    static void append_u32(std::vector<uint8_t>& out, uint32_t value);
+};
+
+
+#endif //OCL_TEST_PNGENCODER_H